@@ -8,3 +8,6 @@ DECLARE_LOG_CATEGORY_EXTERN(UpgradeSystemLog, Log, All)
 
 /* Custom logging category for the resource system */
 DECLARE_LOG_CATEGORY_EXTERN(ResourceSystemLog, Log, All)
+
+/* Custom logging category for rate limiting of client requests */
+DECLARE_LOG_CATEGORY_EXTERN(NetRequestLog, Log, All)
@@ -8,6 +8,6 @@ public class Plugin_Development : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-                PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput", "Json", "JsonUtilities", "Niagara", "DeveloperSettings", "UMG", "AssetRegistry" });
+                PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput", "Json", "JsonUtilities", "Niagara", "DeveloperSettings", "UMG", "AssetRegistry", "NetCore", "SlateCore", "ImageCore" });
 	}
 }
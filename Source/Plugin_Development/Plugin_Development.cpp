@@ -3,9 +3,31 @@
 #include "Plugin_Development.h"
 #include "CustomLogging.h"
 #include "Modules/ModuleManager.h"
+#if WITH_EDITOR
+#include "ResourceIconAtlas.h"
+#endif
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Plugin_Development, "Plugin_Development" );
+class FPlugin_DevelopmentModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+#if WITH_EDITOR
+		UResourceIconAtlas::StartWatchingDefinitions();
+#endif
+	}
+
+	virtual void ShutdownModule() override
+	{
+#if WITH_EDITOR
+		UResourceIconAtlas::StopWatchingDefinitions();
+#endif
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FPlugin_DevelopmentModule, Plugin_Development, "Plugin_Development" );
 
 DEFINE_LOG_CATEGORY(UpgradeSystemLog);
 DEFINE_LOG_CATEGORY(ResourceSystemLog);
+DEFINE_LOG_CATEGORY(NetRequestLog);
  
\ No newline at end of file
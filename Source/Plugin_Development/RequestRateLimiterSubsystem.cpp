@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RequestRateLimiterSubsystem.h"
+#include "CustomLogging.h"
+#include "Components/ActorComponent.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/Actor.h"
+
+void URequestRateLimiterSubsystem::Deinitialize()
+{
+	ConnectionBuckets.Empty();
+	RejectionLogStates.Empty();
+	Super::Deinitialize();
+}
+
+bool URequestRateLimiterSubsystem::TryConsume(const UActorComponent* Requester, ERateLimitedRequest Kind, float Cost)
+{
+	const AActor* Owner = Requester ? Requester->GetOwner() : nullptr;
+	UNetConnection* Connection = Owner ? Owner->GetNetConnection() : nullptr;
+	if (!Connection) return true;
+
+	if (ConnectionBuckets.Num() > PruneThreshold)
+	{
+		PruneClosedConnections();
+	}
+
+	const bool bUpgrade = Kind == ERateLimitedRequest::Upgrade;
+	const float Rate = bUpgrade ? UpgradeRequestsPerSecond : ResourceRequestsPerSecond;
+	const float Burst = bUpgrade ? UpgradeRequestBurst : ResourceRequestBurst;
+
+	FRequestTokenBucket& Bucket = ConnectionBuckets.FindOrAdd(Connection).Buckets[static_cast<uint8>(Kind)];
+	if (Bucket.TryConsume(Cost, Rate, Burst, FPlatformTime::Seconds()))
+	{
+		return true;
+	}
+
+	if (ShouldLogRejection(bUpgrade ? FName(TEXT("RATELIMIT_ERR_01")) : FName(TEXT("RATELIMIT_ERR_02"))))
+	{
+		UE_LOG(NetRequestLog, Warning, TEXT("[%s] Connection %s exceeded its %s request budget (%.1f/s, burst %.0f)"),
+			bUpgrade ? TEXT("RATELIMIT_ERR_01") : TEXT("RATELIMIT_ERR_02"), *Connection->LowLevelGetRemoteAddress(),
+			bUpgrade ? TEXT("upgrade") : TEXT("resource"), Rate, Burst);
+	}
+	return false;
+}
+
+int32 URequestRateLimiterSubsystem::ConsumeUpTo(const UActorComponent* Requester, ERateLimitedRequest Kind, int32 Count)
+{
+	const AActor* Owner = Requester ? Requester->GetOwner() : nullptr;
+	UNetConnection* Connection = Owner ? Owner->GetNetConnection() : nullptr;
+	if (!Connection) return Count;
+
+	if (ConnectionBuckets.Num() > PruneThreshold)
+	{
+		PruneClosedConnections();
+	}
+
+	const bool bUpgrade = Kind == ERateLimitedRequest::Upgrade;
+	const float Rate = bUpgrade ? UpgradeRequestsPerSecond : ResourceRequestsPerSecond;
+	const float Burst = bUpgrade ? UpgradeRequestBurst : ResourceRequestBurst;
+
+	FRequestTokenBucket& Bucket = ConnectionBuckets.FindOrAdd(Connection).Buckets[static_cast<uint8>(Kind)];
+	const int32 Granted = Bucket.ConsumeUpTo(Count, Rate, Burst, FPlatformTime::Seconds());
+	if (Granted < Count && ShouldLogRejection(bUpgrade ? FName(TEXT("RATELIMIT_ERR_01")) : FName(TEXT("RATELIMIT_ERR_02"))))
+	{
+		UE_LOG(NetRequestLog, Warning, TEXT("[%s] Connection %s exceeded its %s request budget (%.1f/s, burst %.0f), %d of %d requests dropped"),
+			bUpgrade ? TEXT("RATELIMIT_ERR_01") : TEXT("RATELIMIT_ERR_02"), *Connection->LowLevelGetRemoteAddress(),
+			bUpgrade ? TEXT("upgrade") : TEXT("resource"), Rate, Burst, Count - Granted, Count);
+	}
+	return Granted;
+}
+
+bool URequestRateLimiterSubsystem::ShouldLogRejection(FName RejectionCode)
+{
+	FRejectionLogState& State = RejectionLogStates.FindOrAdd(RejectionCode);
+	const double Now = FPlatformTime::Seconds();
+	if (Now - State.LastLogTime < RejectionLogInterval)
+	{
+		++State.SuppressedCount;
+		return false;
+	}
+
+	if (State.SuppressedCount > 0)
+	{
+		UE_LOG(NetRequestLog, Log, TEXT("[RATELIMIT_INFO_01] Suppressed %d repeated '%s' rejection(s) in the last %.0f seconds"),
+			State.SuppressedCount, *RejectionCode.ToString(), Now - State.LastLogTime);
+	}
+	State.LastLogTime = Now;
+	State.SuppressedCount = 0;
+	return true;
+}
+
+void URequestRateLimiterSubsystem::PruneClosedConnections()
+{
+	for (auto It = ConnectionBuckets.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid() || It.Key()->GetConnectionState() == USOCK_Closed)
+		{
+			It.RemoveCurrent();
+		}
+	}
+	PruneThreshold = FMath::Max(16, ConnectionBuckets.Num() * 2);
+}
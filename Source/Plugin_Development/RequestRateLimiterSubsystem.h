@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RequestRateLimiterSubsystem.generated.h"
+
+class UNetConnection;
+
+/** Kinds of client requests that are budgeted separately */
+enum class ERateLimitedRequest : uint8
+{
+	Upgrade,
+	Resource,
+	Num
+};
+
+/** Classic token bucket. Refills continuously up to Burst tokens at Rate tokens per second. */
+struct FRequestTokenBucket
+{
+	float Tokens = -1.f;
+	double LastRefillTime = 0.0;
+
+	bool TryConsume(float Cost, float Rate, float Burst, double Now)
+	{
+		Refill(Rate, Burst, Now);
+		if (Tokens < Cost) return false;
+		Tokens -= Cost;
+		return true;
+	}
+
+	/** Takes as many whole tokens as are available, at most MaxCost. Returns how many were taken. */
+	int32 ConsumeUpTo(int32 MaxCost, float Rate, float Burst, double Now)
+	{
+		Refill(Rate, Burst, Now);
+		const int32 Cost = FMath::Clamp(FMath::FloorToInt(Tokens), 0, MaxCost);
+		Tokens -= Cost;
+		return Cost;
+	}
+
+private:
+	void Refill(float Rate, float Burst, double Now)
+	{
+		// First use starts with a full bucket
+		Tokens = Tokens < 0.f ? Burst : FMath::Min(Burst, Tokens + static_cast<float>((Now - LastRefillTime) * Rate));
+		LastRefillTime = Now;
+	}
+};
+
+/**
+ * Server side guard for client RPCs. Keeps one token bucket per connection and request kind so a misbehaving
+ * client cannot flood the upgrade and resource systems, and throttles the warnings those rejections produce.
+ * Requests from local players (no net connection) are never limited.
+ */
+UCLASS(config=Game)
+class PLUGIN_DEVELOPMENT_API URequestRateLimiterSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	/**
+	 * Takes Cost tokens from the bucket of the connection owning Requester.
+	 * @return - false if the connection is over budget and the request should be dropped
+	 */
+	bool TryConsume(const UActorComponent* Requester, ERateLimitedRequest Kind, float Cost = 1.f);
+
+	/**
+	 * Takes up to Count tokens from the bucket of the connection owning Requester, for batches that are served in part.
+	 * @return - how many of the Count requests may be served
+	 */
+	int32 ConsumeUpTo(const UActorComponent* Requester, ERateLimitedRequest Kind, int32 Count);
+
+	/**
+	 * Returns true if a rejection with this code should be logged now. Further rejections with the same code
+	 * inside RejectionLogInterval are only counted and reported together with the next logged one.
+	 */
+	bool ShouldLogRejection(FName RejectionCode);
+
+protected:
+	/** Sustained upgrade requests per second and connection. Batched requests cost one token per entry, entries beyond the budget are rejected. */
+	UPROPERTY(Config, EditAnywhere, Category = "Rate Limits")
+	float UpgradeRequestsPerSecond = 10.f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Rate Limits")
+	float UpgradeRequestBurst = 50.f;
+
+	/** Sustained resource add/spend requests per second and connection */
+	UPROPERTY(Config, EditAnywhere, Category = "Rate Limits")
+	float ResourceRequestsPerSecond = 20.f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Rate Limits")
+	float ResourceRequestBurst = 40.f;
+
+	/** Minimum seconds between two logs of the same rejection code */
+	UPROPERTY(Config, EditAnywhere, Category = "Rate Limits")
+	float RejectionLogInterval = 5.f;
+
+private:
+	struct FConnectionBuckets
+	{
+		FRequestTokenBucket Buckets[static_cast<uint8>(ERateLimitedRequest::Num)];
+	};
+
+	struct FRejectionLogState
+	{
+		double LastLogTime = -DBL_MAX;
+		int32 SuppressedCount = 0;
+	};
+
+	TMap<TWeakObjectPtr<UNetConnection>, FConnectionBuckets> ConnectionBuckets;
+
+	TMap<FName, FRejectionLogState> RejectionLogStates;
+
+	/** Drops buckets of closed connections once the map grows past the last pruned size */
+	void PruneClosedConnections();
+	int32 PruneThreshold = 16;
+};
@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AsyncLoadResourceDefinition.h"
+#include "ResourceDefinition.h"
+#include "ResourceManagerSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/Texture2D.h"
+
+UAsyncLoadResourceDefinition* UAsyncLoadResourceDefinition::LoadResourceDefinition(UObject* WorldContextObject, FName ResourceName, bool bLoadIcon)
+{
+	UAsyncLoadResourceDefinition* Action = NewObject<UAsyncLoadResourceDefinition>();
+	Action->World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	Action->ResourceName = ResourceName;
+	Action->bLoadIcon = bLoadIcon;
+	Action->RegisterWithGameInstance(WorldContextObject);
+	return Action;
+}
+
+void UAsyncLoadResourceDefinition::Activate()
+{
+	UResourceManagerSubsystem* Subsystem = World.IsValid() ? World->GetSubsystem<UResourceManagerSubsystem>() : nullptr;
+	if (!Subsystem)
+	{
+		HandleLoaded(nullptr);
+		return;
+	}
+	Subsystem->RequestDefinition(ResourceName, bLoadIcon, FOnResourceDefinitionLoaded::CreateUObject(this, &UAsyncLoadResourceDefinition::HandleLoaded));
+}
+
+void UAsyncLoadResourceDefinition::HandleLoaded(UResourceDefinition* Definition)
+{
+	if (Definition)
+	{
+		OnLoaded.Broadcast(Definition, Definition->Icon.Get());
+	}
+	else
+	{
+		OnFailed.Broadcast(nullptr, nullptr);
+	}
+	SetReadyToDestroy();
+}
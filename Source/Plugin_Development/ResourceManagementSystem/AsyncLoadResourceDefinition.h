@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "AsyncLoadResourceDefinition.generated.h"
+
+class UResourceDefinition;
+class UTexture2D;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnResourceDefinitionLoadedPin, UResourceDefinition*, Definition, UTexture2D*, Icon);
+
+/** Latent Blueprint node that streams in a resource definition and its icon for UI */
+UCLASS()
+class PLUGIN_DEVELOPMENT_API UAsyncLoadResourceDefinition : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	/** Fires OnLoaded once the definition (and icon, if requested) are in memory, OnFailed if the resource is not defined */
+	UFUNCTION(BlueprintCallable, Category="Resource System", meta=(BlueprintInternalUseOnly="true", WorldContext="WorldContextObject"))
+	static UAsyncLoadResourceDefinition* LoadResourceDefinition(UObject* WorldContextObject, FName ResourceName, bool bLoadIcon = true);
+
+	UPROPERTY(BlueprintAssignable)
+	FOnResourceDefinitionLoadedPin OnLoaded;
+
+	UPROPERTY(BlueprintAssignable)
+	FOnResourceDefinitionLoadedPin OnFailed;
+
+	virtual void Activate() override;
+
+private:
+	TWeakObjectPtr<UWorld> World;
+
+	FName ResourceName;
+
+	bool bLoadIcon = true;
+
+	void HandleLoaded(UResourceDefinition* Definition);
+};
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ResourceDefinition.h"
+#if WITH_EDITOR
+#include "ResourceIconAtlas.h"
+#include "ResourceSettings.h"
+#endif
+
+#if WITH_EDITOR
+void UResourceDefinition::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	const FName PropertyName = PropertyChangedEvent.GetPropertyName();
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(UResourceDefinition, Icon) || PropertyName == GET_MEMBER_NAME_CHECKED(UResourceDefinition, ResourceName))
+	{
+		// Keeps the resource bar atlas in step with the definitions
+		if (UResourceIconAtlas* Atlas = GetDefault<UResourceSettings>()->IconAtlas.LoadSynchronous())
+		{
+			Atlas->UpdateAtlas();
+		}
+	}
+}
+#endif
@@ -15,17 +15,31 @@ class PLUGIN_DEVELOPMENT_API UResourceDefinition : public UPrimaryDataAsset
 	GENERATED_BODY()
 
 public:
-	/** Unique identifier */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Resource System")
+	/** Unique identifier. Read from the asset registry, so the subsystem knows every resource without loading its definition. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, AssetRegistrySearchable, Category="Resource System")
 	FName ResourceName;
 
-	/** Designer-assigned icon for UI */
+	/**
+	 * Designer-assigned icon for UI. Not loaded with the definition, request it through UResourceManagerSubsystem::RequestDefinition.
+	 * Also packed into the icon atlas the resource bar draws from.
+	 */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Resource System")
-	UTexture2D* Icon;
+	TSoftObjectPtr<UTexture2D> Icon;
 
 	/** Short description or tooltip */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Resource System", meta=(MultiLine=true))
 	FText Description;
+
+	/** If set, owners can hold at most BaseCapacity plus whatever their storage upgrades add */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, AssetRegistrySearchable, Category="Resource System")
+	bool bLimitedCapacity = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, AssetRegistrySearchable, Category="Resource System", meta=(EditCondition="bLimitedCapacity", ClampMin="0"))
+	int32 BaseCapacity = 0;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 };
 
 UENUM(BlueprintType)
@@ -1,14 +1,50 @@
 #include "ResourceDisplayWidget.h"
 #include "Components/VerticalBox.h"
 #include "Components/TextBlock.h"
+#include "Components/HorizontalBox.h"
+#include "Components/HorizontalBoxSlot.h"
+#include "Components/Image.h"
 #include "Blueprint/WidgetTree.h"
 #include "ResourceSystemComponent.h"
 #include "ResourceManagerSubsystem.h"
+#include "Misc/StringBuilder.h"
 
 void UResourceDisplayWidget::NativeConstruct()
 {
     Super::NativeConstruct();
 
+    if (UResourceManagerSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UResourceManagerSubsystem>() : nullptr)
+    {
+        IconAtlasLoadedHandle = Subsystem->OnIconAtlasLoaded.AddUObject(this, &UResourceDisplayWidget::HandleIconAtlasLoaded);
+    }
+}
+
+void UResourceDisplayWidget::NativeDestruct()
+{
+    if (UResourceManagerSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UResourceManagerSubsystem>() : nullptr)
+    {
+        Subsystem->OnIconAtlasLoaded.Remove(IconAtlasLoadedHandle);
+    }
+    IconAtlasLoadedHandle.Reset();
+
+    Super::NativeDestruct();
+}
+
+void UResourceDisplayWidget::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
+{
+    Super::NativeTick(MyGeometry, InDeltaTime);
+
+    const double Now = FPlatformTime::Seconds();
+    if (Now >= NextDeltaExpiry)
+    {
+        ExpireDeltas(Now);
+    }
+
+    if (DirtyEntries.Num() == 0) return;
+    if (Now < NextRefreshTime) return;
+
+    NextRefreshTime = Now + RefreshInterval;
+    RefreshDirtyEntries();
 }
 
 void UResourceDisplayWidget::BindResourceComponent(UResourceSystemComponent* InComponent)
@@ -31,21 +67,22 @@ void UResourceDisplayWidget::BuildResourceEntries()
 
     ResourceListBox->ClearChildren();
     ResourceEntries.Empty();
+    ResourceIcons.Empty();
+    EntryStates.Empty();
+    DirtyEntries.Reset();
+    ShownDeltaEntries.Reset();
+    NextDeltaExpiry = TNumericLimits<double>::Max();
 
     TMap<FName, int32> AllResources;
     ResourceComp->GetAllResources(AllResources);
 
     for (auto& Pair : AllResources)
     {
-        UTextBlock* Entry = WidgetTree->ConstructWidget<UTextBlock>(UTextBlock::StaticClass());
-        if (Entry)
-        {
-            FString EntryText = FString::Printf(TEXT("%s: %d"), *Pair.Key.ToString(), Pair.Value);
-            Entry->SetText(FText::FromString(EntryText));
-            ResourceListBox->AddChild(Entry);
-            ResourceEntries.Add(Pair.Key, Entry);
-        }
+        AddResourceRow(Pair.Key);
+        EntryStates.Add(Pair.Key).Amount = Pair.Value;
+        MarkEntryDirty(Pair.Key);
     }
+    RefreshDirtyEntries();
 }
 
 UTextBlock* UResourceDisplayWidget::EnsureEntryExists(FName ResourceName, UVerticalBox* ContainerToQuery, TMap<FName, TWeakObjectPtr<UTextBlock>>& EntriesMap)
@@ -56,6 +93,7 @@ UTextBlock* UResourceDisplayWidget::EnsureEntryExists(FName ResourceName, UVerti
     }
     
     if (!ContainerToQuery) return nullptr;
+    if (ContainerToQuery == ResourceListBox) return AddResourceRow(ResourceName);
     
     UTextBlock* Entry = WidgetTree->ConstructWidget<UTextBlock>(UTextBlock::StaticClass());
     
@@ -69,13 +107,158 @@ UTextBlock* UResourceDisplayWidget::EnsureEntryExists(FName ResourceName, UVerti
 
 void UResourceDisplayWidget::HandleResourceChanged(FName ResourceName, int32 NewAmount, int32 DeltaAmount)
 {
-    if (UTextBlock* Entry = EnsureEntryExists(ResourceName, ResourceListBox, ResourceEntries))
+    // Runs for every single change, so it only records values. Texts are written by the next refresh.
+    FEntryState& State = EntryStates.FindOrAdd(ResourceName);
+    State.Amount = NewAmount;
+
+    const double Now = FPlatformTime::Seconds();
+    if (Now >= State.WindowEnd)
+    {
+        State.WindowDelta = 0;
+        State.WindowEnd = Now + DeltaWindow;
+    }
+    State.WindowDelta += DeltaAmount;
+
+    MarkEntryDirty(ResourceName);
+}
+
+void UResourceDisplayWidget::MarkEntryDirty(FName ResourceName)
+{
+    FEntryState& State = EntryStates.FindOrAdd(ResourceName);
+    if (!State.bDirty)
     {
-        Entry->SetText(FText::FromString(FString::Printf(TEXT("%s: %d"), *ResourceName.ToString(), NewAmount)));
+        State.bDirty = true;
+        DirtyEntries.Add(ResourceName);
     }
-    
-    if (UTextBlock* Entry = EnsureEntryExists(ResourceName, ChangedListBox, ResourceChangeEntries))
+}
+
+void UResourceDisplayWidget::ExpireDeltas(double Now)
+{
+    NextDeltaExpiry = TNumericLimits<double>::Max();
+    for (int32 i = ShownDeltaEntries.Num() - 1; i >= 0; --i)
     {
-        Entry->SetText(FText::FromString(FString::Printf(TEXT("%s: %d"), *ResourceName.ToString(), DeltaAmount)));
+        FEntryState* State = EntryStates.Find(ShownDeltaEntries[i]);
+        if (!State || !State->bDeltaShown)
+        {
+            ShownDeltaEntries.RemoveAtSwap(i);
+        }
+        else if (Now >= State->WindowEnd)
+        {
+            State->WindowDelta = 0;
+            MarkEntryDirty(ShownDeltaEntries[i]);
+            ShownDeltaEntries.RemoveAtSwap(i);
+        }
+        else
+        {
+            NextDeltaExpiry = FMath::Min(NextDeltaExpiry, State->WindowEnd);
+        }
+    }
+}
+
+void UResourceDisplayWidget::RefreshDirtyEntries()
+{
+    // One builder on the stack for every text, only the FText itself allocates
+    TStringBuilder<128> Builder;
+    for (const FName& ResourceName : DirtyEntries)
+    {
+        FEntryState* State = EntryStates.Find(ResourceName);
+        if (!State) continue;
+
+        State->bDirty = false;
+        if (!State->bAmountShown || State->ShownAmount != State->Amount)
+        {
+            if (UTextBlock* Entry = EnsureEntryExists(ResourceName, ResourceListBox, ResourceEntries))
+            {
+                Builder.Reset();
+                Builder << ResourceName << TEXT(": ") << State->Amount;
+                Entry->SetText(FText::FromStringView(Builder.ToView()));
+                State->ShownAmount = State->Amount;
+                State->bAmountShown = true;
+            }
+        }
+
+        if (State->WindowDelta != 0 && (!State->bDeltaShown || State->ShownDelta != State->WindowDelta))
+        {
+            if (UTextBlock* Entry = EnsureEntryExists(ResourceName, ChangedListBox, ResourceChangeEntries))
+            {
+                Builder.Reset();
+                Builder << (State->WindowDelta > 0 ? TEXT("+") : TEXT("")) << State->WindowDelta << TEXT(" ") << ResourceName;
+                Entry->SetText(FText::FromStringView(Builder.ToView()));
+                if (!State->bDeltaShown)
+                {
+                    Entry->SetVisibility(ESlateVisibility::HitTestInvisible);
+                }
+                State->ShownDelta = State->WindowDelta;
+                State->bDeltaShown = true;
+            }
+        }
+        if (State->WindowDelta != 0 && State->bDeltaShown)
+        {
+            // Tracked on every refresh: a delta that expired may have been replaced by a new window before this refresh,
+            // with its text still shown and possibly unchanged
+            ShownDeltaEntries.AddUnique(ResourceName);
+            NextDeltaExpiry = FMath::Min(NextDeltaExpiry, State->WindowEnd);
+        }
+        else if (State->WindowDelta == 0 && State->bDeltaShown)
+        {
+            // Window ended, or its changes cancelled out
+            if (UTextBlock* Entry = EnsureEntryExists(ResourceName, ChangedListBox, ResourceChangeEntries))
+            {
+                Entry->SetVisibility(ESlateVisibility::Collapsed);
+            }
+            State->bDeltaShown = false;
+        }
+    }
+    DirtyEntries.Reset();
+}
+
+UTextBlock* UResourceDisplayWidget::AddResourceRow(FName ResourceName)
+{
+    UHorizontalBox* Row = WidgetTree->ConstructWidget<UHorizontalBox>(UHorizontalBox::StaticClass());
+    UImage* Icon = WidgetTree->ConstructWidget<UImage>(UImage::StaticClass());
+    UTextBlock* Entry = WidgetTree->ConstructWidget<UTextBlock>(UTextBlock::StaticClass());
+    if (!Row || !Icon || !Entry) return nullptr;
+
+    if (UHorizontalBoxSlot* IconSlot = Row->AddChildToHorizontalBox(Icon))
+    {
+        IconSlot->SetVerticalAlignment(VAlign_Center);
+        IconSlot->SetPadding(FMargin(0.f, 0.f, 4.f, 0.f));
+    }
+    if (UHorizontalBoxSlot* TextSlot = Row->AddChildToHorizontalBox(Entry))
+    {
+        TextSlot->SetVerticalAlignment(VAlign_Center);
+    }
+    ResourceListBox->AddChild(Row);
+
+    ApplyAtlasIcon(ResourceName, Icon);
+    ResourceIcons.Add(ResourceName, Icon);
+    ResourceEntries.Add(ResourceName, Entry);
+    return Entry;
+}
+
+void UResourceDisplayWidget::ApplyAtlasIcon(FName ResourceName, UImage* Icon) const
+{
+    // Every icon shares the atlas texture, so Slate batches the whole list into one draw
+    const UResourceManagerSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UResourceManagerSubsystem>() : nullptr;
+    FSlateBrush Brush;
+    if (Subsystem && Subsystem->MakeAtlasIconBrush(Subsystem->GetResourceId(ResourceName), Brush))
+    {
+        Icon->SetBrush(Brush);
+        Icon->SetVisibility(ESlateVisibility::HitTestInvisible);
+    }
+    else
+    {
+        Icon->SetVisibility(ESlateVisibility::Collapsed);
+    }
+}
+
+void UResourceDisplayWidget::HandleIconAtlasLoaded()
+{
+    for (const auto& Pair : ResourceIcons)
+    {
+        if (UImage* Icon = Pair.Value.Get())
+        {
+            ApplyAtlasIcon(Pair.Key, Icon);
+        }
     }
 }
@@ -9,6 +9,7 @@
 
 class UVerticalBox;
 class UTextBlock;
+class UImage;
 
 /**
  * 
@@ -20,11 +21,24 @@ class PLUGIN_DEVELOPMENT_API UResourceDisplayWidget : public UUserWidget
 
 public:
 	virtual void NativeConstruct() override;
+	virtual void NativeDestruct() override;
+	virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
 
 	/** Bind this widget to a ResourceComponent to display its data */
 	UFUNCTION(BlueprintCallable, Category="Resource System")
 	void BindResourceComponent(UResourceSystemComponent* InComponent);
 
+	/** Seconds between two refreshes of the texts. 0 refreshes once per frame. Changes in between only mark entries dirty. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Resource System", meta=(ClampMin="0"))
+	float RefreshInterval = 0.f;
+
+	/**
+	 * Changes of a resource within this many seconds of the first one are summed into one delta, e.g. "+15 Wood".
+	 * The delta is hidden once the window ends without a new change.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Resource System", meta=(ClampMin="0"))
+	float DeltaWindow = 1.f;
+
 protected:
 	/** Vertical box in UMG to hold per-resource text entries */
 	UPROPERTY(BlueprintReadOnly, meta=(BindWidget))
@@ -39,13 +53,53 @@ private:
 	/** Map of resource name → its TextBlock for quick updates */
 	TMap<FName, TWeakObjectPtr<UTextBlock>> ResourceEntries;
 	
+	/** Map of resource name → its icon, all drawn from the shared icon atlas */
+	TMap<FName, TWeakObjectPtr<UImage>> ResourceIcons;
+
 	/** Map of resource name → its TextBlock for spent values */
 	TMap<FName, TWeakObjectPtr<UTextBlock>> ResourceChangeEntries;
 	
+	/** Latest values of a resource and what its texts currently show */
+	struct FEntryState
+	{
+		int32 Amount = 0;
+		int32 ShownAmount = 0;
+		bool bAmountShown = false;
+
+		/** Sum of the changes since WindowEnd - DeltaWindow */
+		int32 WindowDelta = 0;
+		int32 ShownDelta = 0;
+		bool bDeltaShown = false;
+		double WindowEnd = 0.0;
+
+		/** Set while the entry is in DirtyEntries */
+		bool bDirty = false;
+	};
+
+	TMap<FName, FEntryState> EntryStates;
+
+	/** Resources changed since the last refresh */
+	TArray<FName> DirtyEntries;
+
+	/** Resources whose delta is shown, and the earliest end of their windows */
+	TArray<FName> ShownDeltaEntries;
+	double NextDeltaExpiry = TNumericLimits<double>::Max();
+
+	double NextRefreshTime = 0.0;
+
 	/** The component providing resource data */
 	UPROPERTY()
 	UResourceSystemComponent* ResourceComp;
 
+	/** Marks the entry dirty, the texts are updated by the next refresh */
+	void MarkEntryDirty(FName ResourceName);
+
+	/** Writes the texts of dirty entries whose shown values are out of date */
+	void RefreshDirtyEntries();
+
+	/** Zeroes the deltas whose window ended and marks them dirty, so the refresh hides their texts */
+	void ExpireDeltas(double Now);
+
 	/** Handler for resource change events */
 	UFUNCTION()
 	void HandleResourceChanged(FName ResourceName, int32 NewAmount, int32 DeltaAmount);
@@ -56,4 +110,15 @@ private:
 	/** Ensure there is a TextBlock for ResourceName (create if missing) */
 	UTextBlock* EnsureEntryExists(FName ResourceName, UVerticalBox* ContainerToQuery, TMap<FName, TWeakObjectPtr<UTextBlock>>& EntriesMap);
 
+	/** Adds an icon + amount row for ResourceName to ResourceListBox */
+	UTextBlock* AddResourceRow(FName ResourceName);
+
+	/** Points the icon at the resource's atlas cell, hides it while the atlas is not loaded */
+	void ApplyAtlasIcon(FName ResourceName, UImage* Icon) const;
+
+	/** Re-applies every icon once the atlas finished streaming in */
+	void HandleIconAtlasLoaded();
+
+	FDelegateHandle IconAtlasLoadedHandle;
+
 };
@@ -0,0 +1,264 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ResourceIconAtlas.h"
+#include "ResourceManagerSubsystem.h"
+#include "Engine/Texture2D.h"
+#if WITH_EDITOR
+#include "ResourceDefinition.h"
+#include "ResourceSettings.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "ImageCore.h"
+#include "Containers/Ticker.h"
+#endif
+
+bool UResourceIconAtlas::GetIconUVs(FName ResourceName, FBox2f& OutUVs) const
+{
+	const int32* SlotIndex = SlotLookup.Find(ResourceName);
+	if (!SlotIndex || !Texture || Columns == 0 || Rows == 0) return false;
+
+	const int32 Cell = Slots[*SlotIndex].Cell;
+	const float CellSize = IconSize + 2 * CellPadding;
+	const FVector2f AtlasSize(Columns * CellSize, Rows * CellSize);
+	const FVector2f Min((Cell % Columns) * CellSize + CellPadding, (Cell / Columns) * CellSize + CellPadding);
+	OutUVs = FBox2f(Min / AtlasSize, (Min + FVector2f(IconSize, IconSize)) / AtlasSize);
+	return true;
+}
+
+void UResourceIconAtlas::PostLoad()
+{
+	Super::PostLoad();
+	RebuildSlotLookup();
+}
+
+void UResourceIconAtlas::RebuildSlotLookup()
+{
+	SlotLookup.Reset();
+	for (int32 i = 0; i < Slots.Num(); ++i)
+	{
+		SlotLookup.Add(Slots[i].ResourceName, i);
+	}
+}
+
+#if WITH_EDITOR
+namespace
+{
+	FDelegateHandle AssetAddedHandle;
+	FDelegateHandle AssetRemovedHandle;
+	FDelegateHandle AssetRenamedHandle;
+	FTSTicker::FDelegateHandle PendingUpdateHandle;
+
+	void UpdateConfiguredAtlas(const FAssetData& AssetData)
+	{
+		if (AssetData.AssetClassPath != UResourceDefinition::StaticClass()->GetClassPathName()) return;
+		// Skip the initial scan, and run once for a whole import or bulk delete
+		if (IAssetRegistry::GetChecked().IsLoadingAssets() || PendingUpdateHandle.IsValid()) return;
+
+		PendingUpdateHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([](float)
+		{
+			PendingUpdateHandle.Reset();
+			if (UResourceIconAtlas* Atlas = GetDefault<UResourceSettings>()->IconAtlas.LoadSynchronous())
+			{
+				Atlas->UpdateAtlas();
+			}
+			return false;
+		}));
+	}
+}
+
+void UResourceIconAtlas::StartWatchingDefinitions()
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+	AssetAddedHandle = AssetRegistry.OnAssetAdded().AddStatic(&UpdateConfiguredAtlas);
+	AssetRemovedHandle = AssetRegistry.OnAssetRemoved().AddStatic(&UpdateConfiguredAtlas);
+	AssetRenamedHandle = AssetRegistry.OnAssetRenamed().AddLambda([](const FAssetData& AssetData, const FString&) { UpdateConfiguredAtlas(AssetData); });
+}
+
+void UResourceIconAtlas::StopWatchingDefinitions()
+{
+	if (IAssetRegistry* AssetRegistry = IAssetRegistry::Get())
+	{
+		AssetRegistry->OnAssetAdded().Remove(AssetAddedHandle);
+		AssetRegistry->OnAssetRemoved().Remove(AssetRemovedHandle);
+		AssetRegistry->OnAssetRenamed().Remove(AssetRenamedHandle);
+	}
+	FTSTicker::GetCoreTicker().RemoveTicker(PendingUpdateHandle);
+	PendingUpdateHandle.Reset();
+}
+
+void UResourceIconAtlas::UpdateAtlas()
+{
+	RefreshAtlas(false);
+}
+
+void UResourceIconAtlas::RebuildAtlas()
+{
+	RefreshAtlas(true);
+}
+
+void UResourceIconAtlas::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(UResourceIconAtlas, IconSize))
+	{
+		RefreshAtlas(true);
+	}
+}
+
+void UResourceIconAtlas::RefreshAtlas(bool bRepackAll)
+{
+	// Current icon of every definition. Loading is fine here, this only runs in the editor.
+	const FString ScanPath = GetDefault<UResourceSettings>()->ResourceScanPath;
+	FAssetRegistryModule& RegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
+	TArray<FAssetData> AssetsInFolder;
+	RegistryModule.Get().GetAssetsByPath(FName(*ScanPath), AssetsInFolder, /*bRecursive=*/true);
+
+	TMap<FName, UTexture2D*> Icons;
+	for (const FAssetData& AssetData : AssetsInFolder)
+	{
+		if (AssetData.AssetClassPath != UResourceDefinition::StaticClass()->GetClassPathName()) continue;
+
+		const UResourceDefinition* Definition = Cast<UResourceDefinition>(AssetData.GetAsset());
+		if (UTexture2D* Icon = Definition ? Definition->Icon.LoadSynchronous() : nullptr)
+		{
+			Icons.Add(Definition->ResourceName, Icon);
+		}
+	}
+
+	// Removed resources free their cell, unchanged ones keep it
+	TArray<int32> FreedCells;
+	if (bRepackAll)
+	{
+		Slots.Reset();
+	}
+	for (const FResourceIconAtlasSlot& Slot : Slots)
+	{
+		if (!Icons.Contains(Slot.ResourceName)) FreedCells.Add(Slot.Cell);
+	}
+	Slots.RemoveAll([&Icons](const FResourceIconAtlasSlot& Slot) { return !Icons.Contains(Slot.ResourceName); });
+	const int32 NumRemoved = FreedCells.Num();
+	RebuildSlotLookup();
+
+	TSet<int32> DirtySlots;
+	TArray<FName> AddedResources;
+	for (const auto& IconPair : Icons)
+	{
+		const int32* SlotIndex = SlotLookup.Find(IconPair.Key);
+		if (!SlotIndex)
+		{
+			AddedResources.Add(IconPair.Key);
+		}
+		else if (Slots[*SlotIndex].SourceIcon != FSoftObjectPath(IconPair.Value) || Slots[*SlotIndex].SourceId != IconPair.Value->Source.GetId())
+		{
+			DirtySlots.Add(*SlotIndex);
+		}
+	}
+	AddedResources.Sort(FNameLexicalLess());
+
+	// New icons take free cells, the grid is only laid out again once it is full
+	const bool bRelayout = bRepackAll || !Texture || Slots.Num() + AddedResources.Num() > Columns * Rows;
+	TBitArray<> UsedCells(false, Columns * Rows);
+	for (const FResourceIconAtlasSlot& Slot : Slots)
+	{
+		if (UsedCells.IsValidIndex(Slot.Cell)) UsedCells[Slot.Cell] = true;
+	}
+	for (const FName& ResourceName : AddedResources)
+	{
+		FResourceIconAtlasSlot& Slot = Slots.AddDefaulted_GetRef();
+		Slot.ResourceName = ResourceName;
+		Slot.Cell = bRelayout ? INDEX_NONE : UsedCells.FindAndSetFirstZeroBit();
+		DirtySlots.Add(Slots.Num() - 1);
+	}
+	if (bRelayout)
+	{
+		Columns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Slots.Num()))));
+		Rows = FMath::Max(1, FMath::DivideAndRoundUp(Slots.Num(), Columns));
+		Slots.Sort([](const FResourceIconAtlasSlot& A, const FResourceIconAtlasSlot& B) { return A.ResourceName.LexicalLess(B.ResourceName); });
+		DirtySlots.Reset();
+		for (int32 i = 0; i < Slots.Num(); ++i)
+		{
+			Slots[i].Cell = i;
+			DirtySlots.Add(i);
+		}
+	}
+	RebuildSlotLookup();
+
+	if (DirtySlots.Num() == 0 && NumRemoved == 0)
+	{
+		UE_LOG(LogResourceSystem, Log, TEXT("[RESOURCEATLAS_INFO_01] Icon atlas %s is up to date"), *GetName());
+		return;
+	}
+
+	const int32 CellSize = IconSize + 2 * CellPadding;
+	const int32 Width = Columns * CellSize;
+	const int32 Height = Rows * CellSize;
+	if (!Texture)
+	{
+		Texture = NewObject<UTexture2D>(this, TEXT("AtlasTexture"));
+		Texture->CompressionSettings = TC_EditorIcon;
+		Texture->MipGenSettings = TMGS_NoMipmaps;
+		Texture->LODGroup = TEXTUREGROUP_UI;
+		Texture->SRGB = true;
+	}
+
+	Texture->PreEditChange(nullptr);
+	if (bRelayout)
+	{
+		TArray<uint8> Cleared;
+		Cleared.SetNumZeroed(Width * Height * 4);
+		Texture->Source.Init(Width, Height, 1, 1, TSF_BGRA8, Cleared.GetData());
+	}
+
+	uint8* Pixels = Texture->Source.LockMip(0);
+	// A cell is cleared before it is drawn again, padding included, so nothing of the icon it held before shows through
+	// the transparent parts of the new one. Freed cells are cleared right away.
+	auto ClearCell = [Pixels, CellSize, Width, this](int32 Cell)
+	{
+		const int32 CellX = (Cell % Columns) * CellSize;
+		const int32 CellY = (Cell / Columns) * CellSize;
+		for (int32 Y = 0; Y < CellSize; ++Y)
+		{
+			FMemory::Memzero(Pixels + ((CellY + Y) * Width + CellX) * 4, CellSize * 4);
+		}
+	};
+	if (!bRelayout)
+	{
+		for (const int32 Cell : FreedCells)
+		{
+			if (Cell >= 0 && Cell < Columns * Rows) ClearCell(Cell);
+		}
+	}
+	for (const int32 SlotIndex : DirtySlots)
+	{
+		FResourceIconAtlasSlot& Slot = Slots[SlotIndex];
+		if (!bRelayout)
+		{
+			ClearCell(Slot.Cell);
+		}
+		UTexture2D* Icon = Icons[Slot.ResourceName];
+		FImage SourceImage;
+		if (!Icon->Source.GetMipImage(SourceImage, 0, 0, 0))
+		{
+			UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEATLAS_ERR_01] Could not read the source of icon %s for '%s'"), *Icon->GetPathName(), *Slot.ResourceName.ToString());
+			continue;
+		}
+		FImage Scaled;
+		SourceImage.ResizeTo(Scaled, IconSize, IconSize, ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+
+		const int32 CellX = (Slot.Cell % Columns) * CellSize + CellPadding;
+		const int32 CellY = (Slot.Cell / Columns) * CellSize + CellPadding;
+		for (int32 Y = 0; Y < IconSize; ++Y)
+		{
+			FMemory::Memcpy(Pixels + ((CellY + Y) * Width + CellX) * 4, Scaled.RawData.GetData() + Y * IconSize * 4, IconSize * 4);
+		}
+		Slot.SourceIcon = Icon;
+		Slot.SourceId = Icon->Source.GetId();
+	}
+	Texture->Source.UnlockMip(0);
+	Texture->PostEditChange();
+	MarkPackageDirty();
+
+	UE_LOG(LogResourceSystem, Log, TEXT("[RESOURCEATLAS_INFO_02] Icon atlas %s: %d icon(s) drawn, %d removed, %dx%d grid%s"),
+		*GetName(), DirtySlots.Num(), NumRemoved, Columns, Rows, bRelayout ? TEXT(" (re-laid out)") : TEXT(""));
+}
+#endif
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "ResourceIconAtlas.generated.h"
+
+class UTexture2D;
+
+/** One icon in the atlas */
+USTRUCT()
+struct PLUGIN_DEVELOPMENT_API FResourceIconAtlasSlot
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, Category="Atlas")
+	FName ResourceName;
+
+	/** Grid cell, row major */
+	UPROPERTY(VisibleAnywhere, Category="Atlas")
+	int32 Cell = INDEX_NONE;
+
+#if WITH_EDITORONLY_DATA
+	/** Icon the cell was drawn from and the id of its source data at the time, compared to find changed icons */
+	UPROPERTY()
+	FSoftObjectPath SourceIcon;
+
+	UPROPERTY()
+	FGuid SourceId;
+#endif
+};
+
+/**
+ * Every resource icon packed into one texture, so a resource bar binds a single texture and draws in one batch.
+ * Icons are scaled to IconSize and placed on a grid. The atlas is built in the editor from the definitions under the
+ * resource scan path and kept up to date incrementally: editing a definition only redraws the cells that changed, the
+ * grid is only re-laid out when it runs out of cells.
+ */
+UCLASS(BlueprintType)
+class PLUGIN_DEVELOPMENT_API UResourceIconAtlas : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Atlas")
+	TObjectPtr<UTexture2D> Texture;
+
+	/** Edge length icons are scaled to, in pixels */
+	UPROPERTY(EditAnywhere, Category="Atlas", meta=(ClampMin="8", ClampMax="512"))
+	int32 IconSize = 64;
+
+	/** UV rectangle of ResourceName's icon. Returns false if the atlas has no icon for it. */
+	bool GetIconUVs(FName ResourceName, FBox2f& OutUVs) const;
+
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	/** Brings the atlas up to date with the resource definitions, redrawing only added or changed icons */
+	UFUNCTION(CallInEditor, Category="Atlas")
+	void UpdateAtlas();
+
+	/** Clears the atlas and packs every icon again */
+	UFUNCTION(CallInEditor, Category="Atlas")
+	void RebuildAtlas();
+
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+
+	/**
+	 * Updates the atlas set in the resource settings whenever a resource definition is added, deleted or moved, batched
+	 * to once per frame. Edits to a definition update it from UResourceDefinition::PostEditChangeProperty.
+	 */
+	static void StartWatchingDefinitions();
+	static void StopWatchingDefinitions();
+#endif
+
+private:
+	/** Transparent border around each icon so bilinear filtering never samples the neighbour */
+	static constexpr int32 CellPadding = 1;
+
+	UPROPERTY(VisibleAnywhere, Category="Atlas")
+	TArray<FResourceIconAtlasSlot> Slots;
+
+	UPROPERTY(VisibleAnywhere, Category="Atlas")
+	int32 Columns = 0;
+
+	UPROPERTY(VisibleAnywhere, Category="Atlas")
+	int32 Rows = 0;
+
+	/** Slot index by resource name, built on load */
+	TMap<FName, int32> SlotLookup;
+
+	void RebuildSlotLookup();
+
+#if WITH_EDITOR
+	/** Redraws added and changed icons, or every icon on a new grid if bRepackAll or the grid is full */
+	void RefreshAtlas(bool bRepackAll);
+#endif
+};
@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ResourceLedger.h"
+#include "ResourceManagerSubsystem.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+
+FResourceLedger::FResourceLedger(const FString& InFilePath, int32 BufferSize, float InFlushInterval)
+	: FilePath(InFilePath)
+	, FlushInterval(FMath::Max(InFlushInterval, 0.1f))
+{
+	const uint32 Capacity = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(FMath::Max(BufferSize, 1024)));
+	Entries.SetNum(Capacity);
+	Mask = Capacity - 1;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
+	FileHandle.Reset(PlatformFile.OpenWrite(*FilePath, /*bAppend=*/true));
+	if (!FileHandle)
+	{
+		UE_LOG(LogResourceSystem, Error, TEXT("[RESOURCELEDGER_ERR_01] Could not open ledger file '%s', changes are not recorded"), *FilePath);
+		return;
+	}
+
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, TEXT("ResourceLedgerFlusher"), 0, TPri_BelowNormal);
+	UE_LOG(LogResourceSystem, Log, TEXT("[RESOURCELEDGER_INFO_01] Recording resource changes to '%s'"), *FilePath);
+}
+
+FResourceLedger::~FResourceLedger()
+{
+	if (Thread)
+	{
+		// Stops the flusher, which writes what is left before it exits
+		Thread->Kill(/*bShouldWait=*/true);
+		delete Thread;
+		Thread = nullptr;
+	}
+	if (WakeEvent)
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		WakeEvent = nullptr;
+	}
+}
+
+uint32 FResourceLedger::Run()
+{
+	while (!bStopping.load(std::memory_order_relaxed))
+	{
+		WakeEvent->Wait(FTimespan::FromSeconds(FlushInterval));
+		WriteChunk();
+	}
+	WriteChunk();
+	return 0;
+}
+
+void FResourceLedger::Stop()
+{
+	bStopping.store(true, std::memory_order_relaxed);
+	WakeEvent->Trigger();
+}
+
+void FResourceLedger::WriteChunk()
+{
+	const uint64 Read = ReadIndex.load(std::memory_order_relaxed);
+	const uint64 Write = WriteIndex.load(std::memory_order_acquire);
+	uint32 Dropped = DroppedEntries.exchange(0, std::memory_order_relaxed);
+	if (Read == Write && Dropped == 0) return;
+
+	TArray<uint8> Chunk;
+	FMemoryWriter Writer(Chunk);
+	uint32 Magic = ChunkMagic;
+	uint32 Version = ChunkVersion;
+	int64 FlushTicks = FDateTime::UtcNow().GetTicks();
+	Writer << Magic << Version << FlushTicks << Dropped;
+
+	// Names are few and repeat in almost every entry, the table keeps entries at fixed size
+	TMap<FName, int32> NameIndices;
+	TArray<FString> Names;
+	auto IndexOfName = [&NameIndices, &Names](FName Name)
+	{
+		if (const int32* Existing = NameIndices.Find(Name)) return *Existing;
+		const int32 NewIndex = Names.Add(Name.ToString());
+		NameIndices.Add(Name, NewIndex);
+		return NewIndex;
+	};
+
+	TArray<uint8> EntryData;
+	FMemoryWriter EntryWriter(EntryData);
+	int32 NumEntries = static_cast<int32>(Write - Read);
+	for (uint64 Index = Read; Index < Write; ++Index)
+	{
+		const FResourceLedgerEntry& Entry = Entries[Index & Mask];
+		double Time = Entry.Time;
+		int32 OwnerIndex = IndexOfName(Entry.Owner);
+		int32 ResourceIndex = IndexOfName(Entry.Resource);
+		int32 Delta = Entry.Delta;
+		int32 NewBalance = Entry.NewBalance;
+		uint8 Reason = static_cast<uint8>(Entry.Reason);
+		EntryWriter << Time << OwnerIndex << ResourceIndex << Delta << NewBalance << Reason;
+	}
+	// Everything is copied, the game thread may reuse the slots
+	ReadIndex.store(Write, std::memory_order_release);
+
+	Writer << Names << NumEntries;
+	Writer.Serialize(EntryData.GetData(), EntryData.Num());
+	if (!FileHandle->Write(Chunk.GetData(), Chunk.Num()) || !FileHandle->Flush())
+	{
+		UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCELEDGER_ERR_02] Failed to write %d ledger entries to '%s'"), NumEntries, *FilePath);
+	}
+}
+
+bool FResourceLedger::ReadFile(const FString& Path, TArray<FResourceLedgerEntry>& OutEntries, uint64& OutDroppedEntries)
+{
+	OutDroppedEntries = 0;
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path));
+	if (!Reader) return false;
+
+	// Smallest possible entry, used to reject counts the rest of the file cannot hold
+	constexpr int64 EntrySize = sizeof(double) + 4 * sizeof(int32) + sizeof(uint8);
+	while (!Reader->AtEnd())
+	{
+		uint32 Magic = 0;
+		uint32 Version = 0;
+		int64 FlushTicks = 0;
+		uint32 Dropped = 0;
+		*Reader << Magic << Version << FlushTicks << Dropped;
+		if (Reader->IsError() || Magic != ChunkMagic || Version != ChunkVersion) return false;
+
+		TArray<FString> Names;
+		*Reader << Names;
+		int32 NumEntries = 0;
+		*Reader << NumEntries;
+		if (Reader->IsError() || NumEntries < 0 || NumEntries * EntrySize > Reader->TotalSize() - Reader->Tell()) return false;
+
+		TArray<FName> ChunkNames;
+		ChunkNames.Reserve(Names.Num());
+		for (const FString& Name : Names)
+		{
+			ChunkNames.Add(FName(*Name));
+		}
+
+		OutEntries.Reserve(OutEntries.Num() + NumEntries);
+		for (int32 i = 0; i < NumEntries; ++i)
+		{
+			int32 OwnerIndex = 0;
+			int32 ResourceIndex = 0;
+			uint8 Reason = 0;
+			FResourceLedgerEntry& Entry = OutEntries.AddDefaulted_GetRef();
+			*Reader << Entry.Time << OwnerIndex << ResourceIndex << Entry.Delta << Entry.NewBalance << Reason;
+			if (!ChunkNames.IsValidIndex(OwnerIndex) || !ChunkNames.IsValidIndex(ResourceIndex))
+			{
+				OutEntries.Pop();
+				return false;
+			}
+			Entry.Owner = ChunkNames[OwnerIndex];
+			Entry.Resource = ChunkNames[ResourceIndex];
+			Entry.Reason = static_cast<EResourceChangeReason>(Reason);
+		}
+		OutDroppedEntries += Dropped;
+	}
+	return !Reader->IsError();
+}
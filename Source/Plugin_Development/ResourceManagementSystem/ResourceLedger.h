@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+#include "ResourceLedger.generated.h"
+
+class FRunnableThread;
+class IFileHandle;
+
+/** Why a balance changed. Stored with every ledger entry. */
+UENUM(BlueprintType)
+enum class EResourceChangeReason : uint8
+{
+	Grant,
+	QueuedGrant,
+	Spend,
+	WorkerSpend,
+	Production,
+	UpgradeCost,
+	UpgradeRefund,
+	ClientRequest,
+	Reset
+};
+
+/** One balance change. Names stay FNames in memory and are only written out as strings by the flusher. */
+struct FResourceLedgerEntry
+{
+	/** World time of the change */
+	double Time = 0.0;
+
+	/** Actor owning the resource component */
+	FName Owner;
+
+	FName Resource;
+
+	int32 Delta = 0;
+
+	int32 NewBalance = 0;
+
+	EResourceChangeReason Reason = EResourceChangeReason::Grant;
+};
+
+/**
+ * Append only record of balance changes, written to a binary file by a background thread.
+ * The game thread is the only writer. Recording copies the entry into a power of two ring buffer and publishes it with
+ * one release store, no lock and no allocation. When the flusher falls behind and the ring is full, entries are dropped
+ * and the count is written with the next chunk instead of stalling the game thread.
+ *
+ * The file is a sequence of self-contained chunks: magic, version, flush time (UTC ticks), dropped count,
+ * a string table of owner and resource names, and the entries referencing it.
+ */
+class PLUGIN_DEVELOPMENT_API FResourceLedger : public FRunnable
+{
+public:
+	FResourceLedger(const FString& InFilePath, int32 BufferSize, float InFlushInterval);
+	virtual ~FResourceLedger() override;
+
+	/** False if the file could not be opened, nothing is recorded then */
+	bool IsRecording() const { return Thread != nullptr; }
+
+	const FString& GetFilePath() const { return FilePath; }
+
+	void Record(double Time, FName Owner, FName Resource, int32 Delta, int32 NewBalance, EResourceChangeReason Reason)
+	{
+		const uint64 Write = WriteIndex.load(std::memory_order_relaxed);
+		// The flusher's position is only re-read when the ring looks full
+		if (Write - CachedReadIndex > Mask)
+		{
+			CachedReadIndex = ReadIndex.load(std::memory_order_acquire);
+			if (Write - CachedReadIndex > Mask)
+			{
+				DroppedEntries.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+		}
+		FResourceLedgerEntry& Entry = Entries[Write & Mask];
+		Entry.Time = Time;
+		Entry.Owner = Owner;
+		Entry.Resource = Resource;
+		Entry.Delta = Delta;
+		Entry.NewBalance = NewBalance;
+		Entry.Reason = Reason;
+		WriteIndex.store(Write + 1, std::memory_order_release);
+	}
+
+	/**
+	 * Reads every chunk of a ledger file. Stops at the first damaged chunk, e.g. the tail of a crashed session,
+	 * and keeps what was read up to it.
+	 * @return - false if the file could not be opened or a damaged chunk was found
+	 */
+	static bool ReadFile(const FString& Path, TArray<FResourceLedgerEntry>& OutEntries, uint64& OutDroppedEntries);
+
+	//~ Begin FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	//~ End FRunnable
+
+private:
+	static constexpr uint32 ChunkMagic = 0x52474C52;
+	static constexpr uint32 ChunkVersion = 1;
+
+	/** Writes everything recorded since the last call as one chunk. Flusher thread only. */
+	void WriteChunk();
+
+	const FString FilePath;
+	const float FlushInterval;
+
+	TArray<FResourceLedgerEntry> Entries;
+	uint64 Mask = 0;
+
+	/** Next entry the game thread writes. On its own cache line, the flusher only reads it. */
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> WriteIndex{0};
+
+	/** Game thread copy of ReadIndex, refreshed only when the ring looks full */
+	uint64 CachedReadIndex = 0;
+
+	/** Next entry the flusher reads */
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> ReadIndex{0};
+
+	std::atomic<uint32> DroppedEntries{0};
+
+	std::atomic<bool> bStopping{false};
+
+	TUniquePtr<IFileHandle> FileHandle;
+	FEvent* WakeEvent = nullptr;
+	FRunnableThread* Thread = nullptr;
+};
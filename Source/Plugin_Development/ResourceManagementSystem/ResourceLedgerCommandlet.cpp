@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ResourceLedgerCommandlet.h"
+#include "ResourceLedger.h"
+#include "ResourceManagerSubsystem.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+UResourceLedgerCommandlet::UResourceLedgerCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	LogToConsole = true;
+	HelpDescription = TEXT("Prints or sums the entries of a resource ledger file");
+}
+
+int32 UResourceLedgerCommandlet::Main(const FString& Params)
+{
+	FString FilePath;
+	if (!FParse::Value(*Params, TEXT("File="), FilePath))
+	{
+		const FString LedgerDir = FPaths::ProjectSavedDir() / TEXT("ResourceLedger");
+		TArray<FString> Files;
+		IFileManager::Get().FindFiles(Files, *(LedgerDir / TEXT("*.bin")), /*Files=*/true, /*Directories=*/false);
+		if (Files.Num() == 0)
+		{
+			UE_LOG(LogResourceSystem, Error, TEXT("[RESOURCELEDGER_ERR_03] No ledger files in '%s', pass one with -File="), *LedgerDir);
+			return 1;
+		}
+		Files.Sort([&LedgerDir](const FString& A, const FString& B)
+		{
+			return IFileManager::Get().GetTimeStamp(*(LedgerDir / A)) > IFileManager::Get().GetTimeStamp(*(LedgerDir / B));
+		});
+		FilePath = LedgerDir / Files[0];
+	}
+
+	FString OwnerFilter;
+	FString ResourceFilter;
+	FString ReasonFilter;
+	FParse::Value(*Params, TEXT("Owner="), OwnerFilter);
+	FParse::Value(*Params, TEXT("Resource="), ResourceFilter);
+	FParse::Value(*Params, TEXT("Reason="), ReasonFilter);
+	const bool bSummary = FParse::Param(*Params, TEXT("Summary"));
+
+	const UEnum* ReasonEnum = StaticEnum<EResourceChangeReason>();
+	const int64 Reason = ReasonFilter.IsEmpty() ? INDEX_NONE : ReasonEnum->GetValueByNameString(ReasonFilter);
+	if (!ReasonFilter.IsEmpty() && Reason == INDEX_NONE)
+	{
+		UE_LOG(LogResourceSystem, Error, TEXT("[RESOURCELEDGER_ERR_04] Unknown reason '%s'"), *ReasonFilter);
+		return 1;
+	}
+
+	TArray<FResourceLedgerEntry> Entries;
+	uint64 DroppedEntries = 0;
+	if (!FResourceLedger::ReadFile(FilePath, Entries, DroppedEntries))
+	{
+		UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCELEDGER_ERR_05] '%s' is missing or damaged, showing the %d entries before the damage"), *FilePath, Entries.Num());
+	}
+
+	const FName OwnerName = OwnerFilter.IsEmpty() ? NAME_None : FName(*OwnerFilter);
+	const FName ResourceName = ResourceFilter.IsEmpty() ? NAME_None : FName(*ResourceFilter);
+
+	TMap<TPair<FName, FName>, int64> Totals;
+	int32 NumMatched = 0;
+	for (const FResourceLedgerEntry& Entry : Entries)
+	{
+		if ((!OwnerName.IsNone() && Entry.Owner != OwnerName) || (!ResourceName.IsNone() && Entry.Resource != ResourceName)
+			|| (Reason != INDEX_NONE && static_cast<int64>(Entry.Reason) != Reason))
+		{
+			continue;
+		}
+		++NumMatched;
+
+		if (bSummary)
+		{
+			Totals.FindOrAdd(TPair<FName, FName>(Entry.Owner, Entry.Resource)) += Entry.Delta;
+			continue;
+		}
+		UE_LOG(LogResourceSystem, Display, TEXT("%10.2f  %-32s %-16s %-14s %+10d -> %d"), Entry.Time, *Entry.Owner.ToString(), *Entry.Resource.ToString(),
+			*ReasonEnum->GetNameStringByValue(static_cast<int64>(Entry.Reason)), Entry.Delta, Entry.NewBalance);
+	}
+
+	for (const auto& Total : Totals)
+	{
+		UE_LOG(LogResourceSystem, Display, TEXT("%-32s %-16s %+lld"), *Total.Key.Key.ToString(), *Total.Key.Value.ToString(), Total.Value);
+	}
+
+	UE_LOG(LogResourceSystem, Display, TEXT("[RESOURCELEDGER_INFO_02] %d of %d entries in '%s' matched, %llu changes were dropped while recording"),
+		NumMatched, Entries.Num(), *FilePath, DroppedEntries);
+	return 0;
+}
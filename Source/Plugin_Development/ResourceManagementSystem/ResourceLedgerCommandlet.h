@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ResourceLedgerCommandlet.generated.h"
+
+/**
+ * Offline query of a resource ledger file.
+ * UnrealEditor-Cmd <Project> -run=ResourceLedger [-File=<path>] [-Owner=<actor>] [-Resource=<name>] [-Reason=<EResourceChangeReason>] [-Summary]
+ * Without -File the newest file in Saved/ResourceLedger is read. -Summary prints totals per owner and resource instead of every entry.
+ */
+UCLASS()
+class PLUGIN_DEVELOPMENT_API UResourceLedgerCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UResourceLedgerCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
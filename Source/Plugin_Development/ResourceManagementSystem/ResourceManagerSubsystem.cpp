@@ -4,10 +4,90 @@
 #include "ResourceManagerSubsystem.h"
 
 #include "ResourceDefinition.h"
+#include "ResourceSettings.h"
+#include "ResourceIconAtlas.h"
 
 DEFINE_LOG_CATEGORY(LogResourceSystem);
 #include "AssetRegistry/AssetRegistryModule.h"
+#include "Engine/AssetManager.h"
+#include "Engine/Texture2D.h"
+#include "Styling/SlateBrush.h"
 #include "GameFramework/GameModeBase.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/ScopeRWLock.h"
+
+namespace
+{
+	/**
+	 * Adds Delta without overflowing int32 or going below zero. Gains stop at Capacity, while a balance that is
+	 * already above a lowered capacity is kept and just cannot grow.
+	 */
+	int32 SaturatingAdd(int32 Balance, int64 Delta, int32 Capacity)
+	{
+		const int64 Upper = Delta > 0 ? FMath::Max(Capacity, Balance) : MAX_int32;
+		return static_cast<int32>(FMath::Clamp<int64>(Balance + Delta, 0, Upper));
+	}
+
+	/**
+	 * Replaces Balance with Update(Balance) in a compare and swap loop, so game thread updates never overwrite a
+	 * concurrent TrySpendConcurrent. Returns the new balance.
+	 */
+	template<typename UpdateType>
+	int32 UpdateBalance(int32& Balance, UpdateType&& Update, int32* OutOldBalance = nullptr)
+	{
+		int32 Current = FPlatformAtomics::AtomicRead(&Balance);
+		for (;;)
+		{
+			const int32 New = Update(Current);
+			const int32 Seen = FPlatformAtomics::InterlockedCompareExchange(&Balance, New, Current);
+			if (Seen == Current)
+			{
+				if (OutOldBalance) *OutOldBalance = Current;
+				return New;
+			}
+			Current = Seen;
+		}
+	}
+
+	/**
+	 * Optimistic spend. Retries only while the balance still covers Amount, unset balances (-1) fail any positive amount.
+	 * OutBalance is the balance left on success and the one that was too low on failure.
+	 */
+	bool TryDeductBalance(int32& Balance, int32 Amount, int32& OutBalance)
+	{
+		int32 Current = FPlatformAtomics::AtomicRead(&Balance);
+		while (Current >= Amount)
+		{
+			const int32 Seen = FPlatformAtomics::InterlockedCompareExchange(&Balance, Current - Amount, Current);
+			if (Seen == Current)
+			{
+				OutBalance = Current - Amount;
+				return true;
+			}
+			Current = Seen;
+		}
+		OutBalance = Current;
+		return false;
+	}
+
+	/** Copies every row into a wider stride and fills the new columns */
+	template<typename ElementType, typename AllocatorType>
+	void WidenRows(TArray<ElementType, AllocatorType>& Rows, int32 NumRows, int32 OldStride, int32 NewStride, ElementType Fill)
+	{
+		TArray<ElementType, AllocatorType> NewRows;
+		NewRows.Init(Fill, NumRows * NewStride);
+		for (int32 Row = 0; Row < NumRows; ++Row)
+		{
+			FMemory::Memcpy(NewRows.GetData() + Row * NewStride, Rows.GetData() + Row * OldStride, OldStride * sizeof(ElementType));
+		}
+		Rows = MoveTemp(NewRows);
+	}
+}
 
 UResourceManagerSubsystem::UResourceManagerSubsystem()
 {
@@ -16,10 +96,26 @@ UResourceManagerSubsystem::UResourceManagerSubsystem()
 void UResourceManagerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
-	ComponentResourceMap.Empty();
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UResourceManagerSubsystem::OnWorldPostActorTick);
+	SlotComponents.Empty();
+	FreeSlots.Empty();
+	SlotGenerations.Empty();
+	Balances.Empty();
+	ProductionRates.Empty();
+	ProductionRemainders.Empty();
+	LastSettleTimes.Empty();
+	ProducingResourceCounts.Empty();
+	CapacityBonuses.Empty();
+	BaseCapacities.Empty();
+	BalanceRowStride = 0;
+	DefinitionInfos.Empty();
 	Definitions.Empty();
+	IconHandles.Empty();
+	ResourceTable.Empty();
+	ResourceTableLookup.Empty();
+	NetTable = FResourceNetTable();
 	
-    const FString ScanPath = TEXT("/Game/Data/Resources");
+    const FString ScanPath = GetDefault<UResourceSettings>()->ResourceScanPath;
     UE_LOG(LogResourceSystem, Log, TEXT("[RESOURCEMGR_INFO_01] Scanning folder %s for any assets"), *ScanPath);
 
 	// Query AssetRegistry for all assets under that path
@@ -34,30 +130,32 @@ void UResourceManagerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 		return;
 	}
 	
-	// 3) Try casting each one to UResourceDefinition
+	// Definitions are registered from their registry tags, nothing is loaded here
 	for (const FAssetData& AssetData : AssetsInFolder)
 	{
 		if (AssetData.AssetClassPath != UResourceDefinition::StaticClass()->GetClassPathName()) continue;
-		
-		UResourceDefinition* Asset = Cast<UResourceDefinition>(AssetData.GetAsset());
-		if (!Asset)
+
+		FName ResourceName;
+		if (!AssetData.GetTagValue(GET_MEMBER_NAME_CHECKED(UResourceDefinition, ResourceName), ResourceName))
 		{
-            UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_01] Failed to load UResourceDefinition '%s'"),
-				*AssetData.ObjectPath.ToString());
+			RegisterUntaggedDefinition(AssetData);
 			continue;
 		}
-		
-		if (Definitions.Contains(Asset->ResourceName))
+
+		if (DefinitionInfos.Contains(ResourceName))
 		{
 	        UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_02] Duplicate ResourceName '%s' in %s"),
-	        	*Asset->ResourceName.ToString(), *AssetData.ObjectPath.ToString());
+	        	*ResourceName.ToString(), *AssetData.GetObjectPathString());
         }
-        Definitions.Add(Asset->ResourceName, Asset);
+		FResourceDefinitionInfo& Info = DefinitionInfos.Add(ResourceName);
+		Info.AssetPath = AssetData.GetSoftObjectPath();
+		AssetData.GetTagValue(GET_MEMBER_NAME_CHECKED(UResourceDefinition, bLimitedCapacity), Info.bLimitedCapacity);
+		AssetData.GetTagValue(GET_MEMBER_NAME_CHECKED(UResourceDefinition, BaseCapacity), Info.BaseCapacity);
         UE_LOG(LogResourceSystem, Log, TEXT("[RESOURCEMGR_INFO_03] Registered Definition '%s' (Name: %s)"),
-        	*AssetData.AssetName.ToString(), *Asset->ResourceName.ToString());
+        	*AssetData.AssetName.ToString(), *ResourceName.ToString());
 	}
 	
-    if (Definitions.Num() == 0)
+    if (DefinitionInfos.Num() == 0)
     {
         UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_03] No UResourceDefinition assets found after scanning %s!"),
 			*ScanPath);
@@ -65,20 +163,132 @@ void UResourceManagerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
     else
     {
         UE_LOG(LogResourceSystem, Log, TEXT("[RESOURCEMGR_INFO_04] Registered %d resource definitions from '%s'"),
-			Definitions.Num(), *ScanPath);
+			DefinitionInfos.Num(), *ScanPath);
     }
+
+	// Seed the resource table in a machine independent order so server and clients agree on the IDs
+	TArray<FName> DefinedResources;
+	DefinitionInfos.GetKeys(DefinedResources);
+	DefinedResources.Sort(FNameLexicalLess());
+	for (const FName& ResourceName : DefinedResources)
+	{
+		FindOrAddResourceId(ResourceName);
+	}
 }
 
 void UResourceManagerSubsystem::Deinitialize()
 {
-	ComponentResourceMap.Empty();
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	OnComponentRegistered.Clear();
+	// Joins the flusher, which writes the remaining entries first
+	Ledger.Reset();
+	for (FTimerHandle& TimerHandle : StorageFullTimers)
+	{
+		GetWorld()->GetTimerManager().ClearTimer(TimerHandle);
+	}
+	StorageFullTimers.Empty();
+	QueuedGrants.Empty();
+	for (FConcurrentShard& Shard : ConcurrentShards)
+	{
+		FScopeLock ShardLock(&Shard.Lock);
+		Shard.Grants.Empty();
+		Shard.Spends.Empty();
+	}
+	SlotComponents.Empty();
+	FreeSlots.Empty();
+	SlotGenerations.Empty();
+	Balances.Empty();
+	ProductionRates.Empty();
+	ProductionRemainders.Empty();
+	LastSettleTimes.Empty();
+	ProducingResourceCounts.Empty();
+	CapacityBonuses.Empty();
+	BaseCapacities.Empty();
+	BalanceRowStride = 0;
 	Definitions.Empty();
+	ResourceTable.Empty();
+	ResourceTableLookup.Empty();
+	DefinitionInfos.Empty();
+	IconHandles.Empty();
+	IconAtlas = nullptr;
+	IconUVsById.Empty();
+	OnIconAtlasLoaded.Clear();
 	Super::Deinitialize();
 }
 
 void UResourceManagerSubsystem::OnWorldBeginPlay(UWorld& InWorld)
 {
 	Super::OnWorldBeginPlay(InWorld);
+
+	const UResourceSettings* Settings = GetDefault<UResourceSettings>();
+	if (Settings->bRecordLedger && InWorld.GetNetMode() != NM_Client && FPlatformProcess::SupportsMultithreading())
+	{
+		const FString FileName = FString::Printf(TEXT("%s_%s.bin"), *InWorld.GetMapName(), *FDateTime::Now().ToString());
+		Ledger = MakeUnique<FResourceLedger>(FPaths::ProjectSavedDir() / TEXT("ResourceLedger") / FileName, Settings->LedgerBufferSize, Settings->LedgerFlushInterval);
+		if (!Ledger->IsRecording())
+		{
+			Ledger.Reset();
+		}
+	}
+
+	// Only UI needs the atlas
+	if (!IsRunningDedicatedServer() && !Settings->IconAtlas.IsNull())
+	{
+		UAssetManager::GetStreamableManager().RequestAsyncLoad(Settings->IconAtlas.ToSoftObjectPath(),
+			FStreamableDelegate::CreateUObject(this, &UResourceManagerSubsystem::OnIconAtlasStreamed));
+	}
+}
+
+void UResourceManagerSubsystem::OnIconAtlasStreamed()
+{
+	const TSoftObjectPtr<UResourceIconAtlas>& AtlasRef = GetDefault<UResourceSettings>()->IconAtlas;
+	IconAtlas = AtlasRef.Get();
+	if (!IconAtlas)
+	{
+		UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_11] Failed to load icon atlas '%s'"), *AtlasRef.ToString());
+		return;
+	}
+
+	// The atlas is keyed by name, the UI looks icons up by ID
+	IconUVsById.SetNum(ResourceTable.Num());
+	for (int32 ResourceId = 0; ResourceId < ResourceTable.Num(); ++ResourceId)
+	{
+		if (!IconAtlas->GetIconUVs(ResourceTable[ResourceId], IconUVsById[ResourceId]))
+		{
+			IconUVsById[ResourceId] = FBox2f(ForceInit);
+		}
+	}
+	OnIconAtlasLoaded.Broadcast();
+}
+
+bool UResourceManagerSubsystem::MakeAtlasIconBrush(int32 ResourceId, FSlateBrush& OutBrush) const
+{
+	if (!IconAtlas || !ResourceTable.IsValidIndex(ResourceId)) return false;
+
+	// Resources registered after the atlas arrived fall back to the name lookup
+	FBox2f UVs(ForceInit);
+	if (IconUVsById.IsValidIndex(ResourceId))
+	{
+		UVs = IconUVsById[ResourceId];
+	}
+	else
+	{
+		IconAtlas->GetIconUVs(ResourceTable[ResourceId], UVs);
+	}
+	if (!UVs.bIsValid) return false;
+
+	OutBrush.SetResourceObject(IconAtlas->Texture);
+	OutBrush.SetUVRegion(FBox2D(FVector2D(UVs.Min), FVector2D(UVs.Max)));
+	OutBrush.ImageSize = FVector2D(IconAtlas->IconSize, IconAtlas->IconSize);
+	return true;
+}
+
+void UResourceManagerSubsystem::RecordChange(const UResourceSystemComponent* ResourceComponent, int32 ResourceId, int32 Delta, int32 NewBalance, EResourceChangeReason Reason)
+{
+	if (!Ledger) return;
+
+	const AActor* Owner = ResourceComponent->GetOwner();
+	Ledger->Record(GetWorld()->GetTimeSeconds(), Owner ? Owner->GetFName() : ResourceComponent->GetFName(), ResourceTable[ResourceId], Delta, NewBalance, Reason);
 }
 
 void UResourceManagerSubsystem::RegisterComponent(UResourceSystemComponent* Comp)
@@ -86,60 +296,309 @@ void UResourceManagerSubsystem::RegisterComponent(UResourceSystemComponent* Comp
     // Only register on server-authoritative side
     if (Comp && GetWorld()->GetAuthGameMode())
     {
-        ComponentResourceMap.FindOrAdd(Comp);
-        UE_LOG(LogResourceSystem, Log, TEXT("[RESOURCEMGR_INFO_05] Registered component %s. Total Components %d."), *Comp->GetName(), ComponentResourceMap.Num());
+        if (Comp->ResourceSlot == INDEX_NONE)
+        {
+            int32 Slot;
+            if (FreeSlots.Num() > 0)
+            {
+                // Reuse the last hole
+                Slot = FreeSlots.Pop(/*bAllowShrinking=*/false);
+                SlotComponents[Slot] = Comp;
+            }
+            else
+            {
+                Slot = SlotComponents.Add(Comp);
+                {
+                    FWriteScopeLock StorageWriteLock(StorageLock);
+                    Balances.AddUninitialized(BalanceRowStride);
+                    SlotGenerations.Add(0);
+                }
+                ProductionRates.AddUninitialized(BalanceRowStride);
+                ProductionRemainders.AddUninitialized(BalanceRowStride);
+                CapacityBonuses.AddUninitialized(BalanceRowStride);
+                LastSettleTimes.AddUninitialized();
+                ProducingResourceCounts.AddUninitialized();
+                StorageFullTimers.AddDefaulted();
+            }
+            static_assert(UnsetBalance == -1, "Rows are reset with all bits set");
+            FMemory::Memset(GetBalanceRow(Slot), 0xFF, BalanceRowStride * sizeof(int32));
+            FMemory::Memzero(&ProductionRates[Slot * BalanceRowStride], BalanceRowStride * sizeof(float));
+            FMemory::Memzero(&ProductionRemainders[Slot * BalanceRowStride], BalanceRowStride * sizeof(double));
+            FMemory::Memzero(&CapacityBonuses[Slot * BalanceRowStride], BalanceRowStride * sizeof(int32));
+            LastSettleTimes[Slot] = GetWorld()->GetTimeSeconds();
+            ProducingResourceCounts[Slot] = 0;
+            Comp->ResourceSlot = Slot;
+            OnComponentRegistered.Broadcast(Comp);
+        }
+        Comp->SetNetTable(NetTable);
+        UE_LOG(LogResourceSystem, Log, TEXT("[RESOURCEMGR_INFO_05] Registered component %s in slot %d. Total Components %d."),
+        	*Comp->GetName(), Comp->ResourceSlot, SlotComponents.Num() - FreeSlots.Num());
 	}
 }
 
 void UResourceManagerSubsystem::UnregisterComponent(UResourceSystemComponent* Comp)
 {
-    if (Comp && GetWorld()->GetAuthGameMode())
+    if (Comp && GetWorld()->GetAuthGameMode() && SlotComponents.IsValidIndex(Comp->ResourceSlot))
+    {
+        GetWorld()->GetTimerManager().ClearTimer(StorageFullTimers[Comp->ResourceSlot]);
+        {
+            // Waits for worker threads still spending from the row
+            FWriteScopeLock StorageWriteLock(StorageLock);
+            ++SlotGenerations[Comp->ResourceSlot];
+        }
+        SlotComponents[Comp->ResourceSlot].Reset();
+        FreeSlots.Add(Comp->ResourceSlot);
+        Comp->ResourceSlot = INDEX_NONE;
+        UE_LOG(LogResourceSystem, Log, TEXT("[RESOURCEMGR_INFO_06] Unregistered component %s. Total Components %d."), *Comp->GetName(), SlotComponents.Num() - FreeSlots.Num());
+    }
+}
+
+void UResourceManagerSubsystem::ResetBalances(UResourceSystemComponent* Comp)
+{
+    if (!Comp || !GetWorld()->GetAuthGameMode() || !SlotComponents.IsValidIndex(Comp->ResourceSlot)) return;
+
+    const int32 Slot = Comp->ResourceSlot;
     {
-        ComponentResourceMap.Remove(Comp);
-        UE_LOG(LogResourceSystem, Log, TEXT("[RESOURCEMGR_INFO_06] Unregistered component %s. Total Components %d."), *Comp->GetName(), ComponentResourceMap.Num());
+        // Same as a freed slot for worker threads still holding a handle
+        FWriteScopeLock StorageWriteLock(StorageLock);
+        ++SlotGenerations[Slot];
     }
+
+    // Production up to now is dropped with the rest, it starts over from here
+    LastSettleTimes[Slot] = GetWorld()->GetTimeSeconds();
+    int32* Row = GetBalanceRow(Slot);
+    for (int32 ResourceId = 0; ResourceId < ResourceTable.Num(); ++ResourceId)
+    {
+        ProductionRemainders[Slot * BalanceRowStride + ResourceId] = 0.0;
+        const int32 OldAmount = Row[ResourceId];
+        if (OldAmount == UnsetBalance) continue;
+
+        // Kept at zero rather than unset, the owner already shows the resource
+        Row[ResourceId] = 0;
+        if (OldAmount != 0)
+        {
+            RecordChange(Comp, ResourceId, -OldAmount, 0, EResourceChangeReason::Reset);
+            Comp->PublishResourceAmount(ResourceId, 0, -OldAmount, GetCapacity(Slot, ResourceId));
+        }
+    }
+    ScheduleStorageFull(Slot);
+    UE_LOG(LogResourceSystem, Verbose, TEXT("[RESOURCEMGR_INFO_13] Reset the balances of %s"), *Comp->GetName());
 }
 
 void UResourceManagerSubsystem::AddResource(UResourceSystemComponent* ResourceComponent, FName ResourceName, int32 Amount)
 {
     if (!GetWorld()->GetAuthGameMode() || !ResourceComponent || Amount <= 0) return;
 
-    FResourceBucket& Bucket = ComponentResourceMap.FindOrAdd(ResourceComponent);
-    int32& CurrentAmount = Bucket.Resources.FindOrAdd(ResourceName);
-    const int32 OldAmount = CurrentAmount;
-    CurrentAmount += Amount;
+    AddResourceById(ResourceComponent, FindOrAddResourceId(ResourceName), Amount);
+}
+
+void UResourceManagerSubsystem::AddResourceById(UResourceSystemComponent* ResourceComponent, int32 ResourceId, int32 Amount, EResourceChangeReason Reason)
+{
+    if (!GetWorld()->GetAuthGameMode() || !ResourceComponent || Amount <= 0 || !ResourceTable.IsValidIndex(ResourceId)) return;
+
+    const int32 Slot = ResourceComponent->ResourceSlot;
+    if (Slot == INDEX_NONE)
+    {
+        UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_04] Component %s has no resource bucket"), *ResourceComponent->GetName());
+        return;
+    }
+
+    SettleProduction(Slot);
+    const int32 Capacity = GetCapacity(Slot, ResourceId);
+    int32 OldAmount;
+    const int32 CurrentAmount = UpdateBalance(GetBalanceRow(Slot)[ResourceId], [Amount, Capacity](int32 Balance)
+    {
+        return SaturatingAdd(FMath::Max(Balance, 0), Amount, Capacity);
+    }, &OldAmount);
 	
 	// We anticipate many enemies dying frequently and calling this functions often. This log is only for diagnostics,
 	// it is not needed often.
     if (UE_LOG_ACTIVE(LogResourceSystem, Verbose))
     {
         UE_LOG(LogResourceSystem, Verbose, TEXT("[RESOURCEMGR_INFO_07] Added %d of '%s' to %s (old: %d, new: %d, diff: +%d)"),
-			Amount, *ResourceName.ToString(), *ResourceComponent->GetName(), OldAmount, CurrentAmount, Amount);
+			Amount, *ResourceTable[ResourceId].ToString(), *ResourceComponent->GetName(), OldAmount, CurrentAmount, Amount);
+    }
+    // A full storage swallows the grant, owners only hear about what was actually added
+    if (CurrentAmount != OldAmount)
+    {
+	    RecordChange(ResourceComponent, ResourceId, CurrentAmount - FMath::Max(OldAmount, 0), CurrentAmount, Reason);
+	    ResourceComponent->PublishResourceAmount(ResourceId, CurrentAmount, CurrentAmount - FMath::Max(OldAmount, 0), Capacity);
+	    ScheduleStorageFull(Slot);
+    }
+}
+
+void UResourceManagerSubsystem::QueueAddResource(UResourceSystemComponent* ResourceComponent, FName ResourceName, int32 Amount)
+{
+    if (!ResourceComponent || Amount <= 0) return;
+
+    QueuedGrants.Enqueue({ ResourceComponent, ResourceName, Amount });
+}
+
+void UResourceManagerSubsystem::FlushQueuedGrants()
+{
+    check(IsInGameThread());
+
+    // Shards are swapped out under their lock, workers never wait for the grants to be applied
+    TArray<FConcurrentChange> ConcurrentGrants;
+    TArray<FConcurrentChange> ConcurrentSpends;
+    for (FConcurrentShard& Shard : ConcurrentShards)
+    {
+        FScopeLock ShardLock(&Shard.Lock);
+        ConcurrentGrants.Append(MoveTemp(Shard.Grants));
+        ConcurrentSpends.Append(MoveTemp(Shard.Spends));
+        Shard.Grants.Reset();
+        Shard.Spends.Reset();
+    }
+    PublishConcurrentSpends(ConcurrentSpends);
+    if (QueuedGrants.IsEmpty() && ConcurrentGrants.Num() == 0) return;
+
+    struct FResolvedGrant
+    {
+        UResourceSystemComponent* Component;
+        int32 Slot;
+        int32 ResourceId;
+        int32 Amount;
+    };
+    TArray<FResolvedGrant> Grants;
+
+    for (const FConcurrentChange& Change : ConcurrentGrants)
+    {
+        UResourceSystemComponent* Comp = IsCurrentHandle(Change.Slot, Change.Generation) ? SlotComponents[Change.Slot].Get() : nullptr;
+        if (!Comp || !ResourceTable.IsValidIndex(Change.ResourceId)) continue;
+        Grants.Add({ Comp, Change.Slot, Change.ResourceId, Change.Amount });
+    }
+
+    FQueuedResourceGrant Queued;
+    while (QueuedGrants.Dequeue(Queued))
+    {
+        UResourceSystemComponent* Comp = Queued.Component.Get();
+        if (!Comp || Comp->ResourceSlot == INDEX_NONE) continue;
+
+        const int32 ResourceId = FindOrAddResourceId(Queued.ResourceName);
+        if (ResourceId == INDEX_NONE) continue;
+        Grants.Add({ Comp, Comp->ResourceSlot, ResourceId, Queued.Amount });
+    }
+
+    // Equal (slot, resource) pairs end up next to each other and are applied as one grant
+    Grants.Sort([](const FResolvedGrant& A, const FResolvedGrant& B)
+    {
+        return A.Slot != B.Slot ? A.Slot < B.Slot : A.ResourceId < B.ResourceId;
+    });
+
+    for (int32 First = 0; First < Grants.Num();)
+    {
+        int64 Total = 0;
+        int32 Next = First;
+        for (; Next < Grants.Num() && Grants[Next].Slot == Grants[First].Slot && Grants[Next].ResourceId == Grants[First].ResourceId; ++Next)
+        {
+            Total += Grants[Next].Amount;
+        }
+        AddResourceById(Grants[First].Component, Grants[First].ResourceId, static_cast<int32>(FMath::Min<int64>(Total, MAX_int32)), EResourceChangeReason::QueuedGrant);
+        First = Next;
+    }
+}
+
+void UResourceManagerSubsystem::PublishConcurrentSpends(TArray<FConcurrentChange>& Spends)
+{
+    Spends.Sort([](const FConcurrentChange& A, const FConcurrentChange& B)
+    {
+        return A.Slot != B.Slot ? A.Slot < B.Slot : A.ResourceId < B.ResourceId;
+    });
+
+    for (int32 First = 0; First < Spends.Num();)
+    {
+        const FConcurrentChange& Spend = Spends[First];
+        int64 Total = 0;
+        int32 Next = First;
+        for (; Next < Spends.Num() && Spends[Next].Slot == Spend.Slot && Spends[Next].ResourceId == Spend.ResourceId; ++Next)
+        {
+            Total += Spends[Next].Amount;
+        }
+        First = Next;
+
+        // Spends from a row that was freed since are gone with it
+        UResourceSystemComponent* Comp = IsCurrentHandle(Spend.Slot, Spend.Generation) ? SlotComponents[Spend.Slot].Get() : nullptr;
+        if (!Comp) continue;
+
+        const int32 Delta = static_cast<int32>(FMath::Max<int64>(-Total, MIN_int32));
+        const int32 Balance = GetBalanceRow(Spend.Slot)[Spend.ResourceId];
+        RecordChange(Comp, Spend.ResourceId, Delta, Balance, EResourceChangeReason::WorkerSpend);
+        Comp->PublishResourceAmount(Spend.ResourceId, Balance, Delta, GetCapacity(Spend.Slot, Spend.ResourceId));
+        if (Next == Spends.Num() || Spends[Next].Slot != Spend.Slot)
+        {
+            ScheduleStorageFull(Spend.Slot);
+        }
+    }
+}
+
+FResourceWalletHandle UResourceManagerSubsystem::GetWalletHandle(const UResourceSystemComponent* ResourceComponent) const
+{
+    if (!ResourceComponent || ResourceComponent->ResourceSlot == INDEX_NONE) return FResourceWalletHandle();
+
+    return { ResourceComponent->ResourceSlot, SlotGenerations[ResourceComponent->ResourceSlot] };
+}
+
+void UResourceManagerSubsystem::AddResourceConcurrent(const FResourceWalletHandle& Wallet, int32 ResourceId, int32 Amount)
+{
+    if (!Wallet.IsValid() || ResourceId < 0 || Amount <= 0) return;
+
+    FConcurrentShard& Shard = GetThreadShard();
+    FScopeLock ShardLock(&Shard.Lock);
+    Shard.Grants.Add({ Wallet.Slot, Wallet.Generation, ResourceId, Amount });
+}
+
+bool UResourceManagerSubsystem::TrySpendConcurrent(const FResourceWalletHandle& Wallet, int32 ResourceId, int32 Amount)
+{
+    if (!Wallet.IsValid() || ResourceId < 0 || Amount <= 0) return false;
+
+    {
+        FReadScopeLock StorageReadLock(StorageLock);
+        // IDs interned after the row was laid out are past the stride, within it they are unset and fail below
+        if (!IsCurrentHandle(Wallet.Slot, Wallet.Generation) || ResourceId >= BalanceRowStride) return false;
+
+        int32 NewBalance;
+        if (!TryDeductBalance(GetBalanceRow(Wallet.Slot)[ResourceId], Amount, NewBalance)) return false;
+    }
+
+    FConcurrentShard& Shard = GetThreadShard();
+    FScopeLock ShardLock(&Shard.Lock);
+    Shard.Spends.Add({ Wallet.Slot, Wallet.Generation, ResourceId, Amount });
+    return true;
+}
+
+void UResourceManagerSubsystem::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+    if (World == GetWorld())
+    {
+        FlushQueuedGrants();
     }
-	//ResourceComponent->OnResourceChanged.Broadcast(ResourceName, CurrentAmount, Amount);
-	ResourceComponent->Client_UpdateResource(ResourceName, CurrentAmount, Amount);
 }
 
 int32 UResourceManagerSubsystem::GetResource(const UResourceSystemComponent* ResourceComponent, FName ResourceName) const
 {
-	if (!ResourceComponent)	return -1;
-	
-	if (const FResourceBucket* Bucket = ComponentResourceMap.Find(ResourceComponent))
-	{
-		if (const int32* Amount = Bucket->Resources.Find(ResourceName))
-		{
-			return *Amount;
-		}
-	}
-	return -1;
+	return GetResourceById(ResourceComponent, GetResourceId(ResourceName));
+}
+
+int32 UResourceManagerSubsystem::GetResourceById(const UResourceSystemComponent* ResourceComponent, int32 ResourceId) const
+{
+	if (!ResourceComponent || ResourceComponent->ResourceSlot == INDEX_NONE || !ResourceTable.IsValidIndex(ResourceId)) return -1;
+
+	// Never held resources read as UnsetBalance, which is the -1 callers expect
+	return GetProjectedBalance(ResourceComponent->ResourceSlot, ResourceId);
 }
 
 void UResourceManagerSubsystem::GetAllResources(const UResourceSystemComponent* Comp, TMap<FName, int32>& OutAvailableResources) const
 {
-	if (!Comp) return;
-	if (ComponentResourceMap.Contains(Comp))
+	if (!Comp || Comp->ResourceSlot == INDEX_NONE) return;
+
+	OutAvailableResources.Reset();
+	const int32* Row = GetBalanceRow(Comp->ResourceSlot);
+	for (int32 ResourceId = 0; ResourceId < ResourceTable.Num(); ++ResourceId)
 	{
-		OutAvailableResources = ComponentResourceMap.Find(Comp)->Resources;
+		if (Row[ResourceId] != UnsetBalance)
+		{
+			OutAvailableResources.Add(ResourceTable[ResourceId], GetProjectedBalance(Comp->ResourceSlot, ResourceId));
+		}
 	}
 }
 
@@ -147,41 +606,508 @@ bool UResourceManagerSubsystem::SpendResource(UResourceSystemComponent* Resource
 {
     if (!GetWorld()->GetAuthGameMode() || !ResourceComponent || Amount <= 0) return false;
 
-    FResourceBucket* Bucket = ComponentResourceMap.Find(ResourceComponent);
-    if (!Bucket)
+    const int32 ResourceId = GetResourceId(ResourceName);
+    if (ResourceId == INDEX_NONE)
     {
-        UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_04] Component %s has no resource bucket"), *ResourceComponent->GetName());
+        UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_05] Resource '%s' not found for component %s"), *ResourceName.ToString(), *ResourceComponent->GetName());
         return false;
     }
+    return SpendResourceById(ResourceComponent, ResourceId, Amount);
+}
 
-    int32* CurrentAmount = Bucket->Resources.Find(ResourceName);
-    if (!CurrentAmount)
+bool UResourceManagerSubsystem::SpendResourceById(UResourceSystemComponent* ResourceComponent, int32 ResourceId, int32 Amount, EResourceChangeReason Reason)
+{
+    if (!GetWorld()->GetAuthGameMode() || !ResourceComponent || Amount <= 0 || !ResourceTable.IsValidIndex(ResourceId)) return false;
+
+    const int32 Slot = ResourceComponent->ResourceSlot;
+    if (Slot == INDEX_NONE)
     {
-        UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_05] Resource '%s' not found for component %s"), *ResourceName.ToString(), *ResourceComponent->GetName());
+        UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_04] Component %s has no resource bucket"), *ResourceComponent->GetName());
         return false;
     }
-    if (*CurrentAmount < Amount)
+
+    SettleProduction(Slot);
+    int32 CurrentAmount;
+    if (!TryDeductBalance(GetBalanceRow(Slot)[ResourceId], Amount, CurrentAmount))
     {
-        UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_06] Not enough '%s' for component %s (have: %d, need: %d)"),
-        	*ResourceName.ToString(), *ResourceComponent->GetName(), *CurrentAmount, Amount);
+        if (CurrentAmount == UnsetBalance)
+        {
+            UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_05] Resource '%s' not found for component %s"), *ResourceTable[ResourceId].ToString(), *ResourceComponent->GetName());
+        }
+        else
+        {
+            UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_06] Not enough '%s' for component %s (have: %d, need: %d)"),
+        	    *ResourceTable[ResourceId].ToString(), *ResourceComponent->GetName(), CurrentAmount, Amount);
+        }
         return false;
     }
 
-    const int32 OldAmount = *CurrentAmount;
-    *CurrentAmount -= Amount;
     if (UE_LOG_ACTIVE(LogResourceSystem, Verbose))
     {
 	    UE_LOG(LogResourceSystem, Verbose, TEXT("[RESOURCEMGR_INFO_08] Spent %d of '%s' from %s (old: %d, new: %d, diff: -%d)"),
-	           Amount, *ResourceName.ToString(), *ResourceComponent->GetName(), OldAmount, *CurrentAmount, Amount);
+	           Amount, *ResourceTable[ResourceId].ToString(), *ResourceComponent->GetName(), CurrentAmount + Amount, CurrentAmount, Amount);
     }
-    //ResourceComponent->OnResourceChanged.Broadcast(ResourceName, *CurrentAmount, (Amount * -1));
-    ResourceComponent->Client_UpdateResource(ResourceName, *CurrentAmount, (Amount * -1));
+    RecordChange(ResourceComponent, ResourceId, -Amount, CurrentAmount, Reason);
+    ResourceComponent->PublishResourceAmount(ResourceId, CurrentAmount, (Amount * -1), GetCapacity(Slot, ResourceId));
+    ScheduleStorageFull(Slot);
     return true;
 }
 
+bool UResourceManagerSubsystem::TrySpend(UResourceSystemComponent* ResourceComponent, TConstArrayView<FResourceAmount> Costs, EResourceChangeReason Reason)
+{
+    // Scatter into a dense row so the check below is one pass over contiguous memory
+    TArray<int32, TInlineAllocator<BalanceRowAlignment * 2>> DenseCosts;
+    DenseCosts.SetNumZeroed(ResourceTable.Num());
+    for (const FResourceAmount& Cost : Costs)
+    {
+        if (!DenseCosts.IsValidIndex(Cost.ResourceId) || Cost.Amount < 0)
+        {
+            UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_07] Invalid cost (resource %d, amount %d) in transaction"), Cost.ResourceId, Cost.Amount);
+            return false;
+        }
+        DenseCosts[Cost.ResourceId] += Cost.Amount;
+    }
+    return TrySpendDense(ResourceComponent, DenseCosts, Reason);
+}
+
+bool UResourceManagerSubsystem::TrySpendDense(UResourceSystemComponent* ResourceComponent, TConstArrayView<int32> DenseCosts, EResourceChangeReason Reason)
+{
+    if (!GetWorld()->GetAuthGameMode() || !ResourceComponent || DenseCosts.Num() > ResourceTable.Num()) return false;
+
+    const int32 Slot = ResourceComponent->ResourceSlot;
+    if (Slot == INDEX_NONE)
+    {
+        UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_04] Component %s has no resource bucket"), *ResourceComponent->GetName());
+        return false;
+    }
+
+    SettleProduction(Slot);
+    int32* Row = GetBalanceRow(Slot);
+    const int32* Costs = DenseCosts.GetData();
+    const int32 Num = DenseCosts.Num();
+
+    // Branch free so the compiler can vectorize it. Unset balances are -1 and fail any positive cost.
+    int32 Insufficient = 0;
+    for (int32 i = 0; i < Num; ++i)
+    {
+        Insufficient |= (Row[i] < Costs[i]) & (Costs[i] > 0);
+    }
+
+    if (Insufficient)
+    {
+        if (UE_LOG_ACTIVE(LogResourceSystem, Warning))
+        {
+            for (int32 i = 0; i < Num; ++i)
+            {
+                if (Costs[i] > 0 && Row[i] < Costs[i])
+                {
+                    UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_06] Not enough '%s' for component %s (have: %d, need: %d)"),
+                        *ResourceTable[i].ToString(), *ResourceComponent->GetName(), FMath::Max(Row[i], 0), Costs[i]);
+                    break;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Worker threads may have spent since the check, so each deduction is a compare and swap and a lost race rolls back
+    TArray<int32, TInlineAllocator<BalanceRowAlignment * 2>> NewBalances;
+    NewBalances.SetNumUninitialized(Num);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        if (Costs[i] > 0 && !TryDeductBalance(Row[i], Costs[i], NewBalances[i]))
+        {
+            for (int32 Taken = 0; Taken < i; ++Taken)
+            {
+                if (Costs[Taken] > 0)
+                {
+                    FPlatformAtomics::InterlockedAdd(&Row[Taken], Costs[Taken]);
+                }
+            }
+            UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_06] Not enough '%s' for component %s (have: %d, need: %d)"),
+                *ResourceTable[i].ToString(), *ResourceComponent->GetName(), FMath::Max(NewBalances[i], 0), Costs[i]);
+            return false;
+        }
+    }
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        if (Costs[i] > 0)
+        {
+            RecordChange(ResourceComponent, i, -Costs[i], NewBalances[i], Reason);
+            ResourceComponent->PublishResourceAmount(i, NewBalances[i], -Costs[i], GetCapacity(Slot, i));
+        }
+    }
+    ScheduleStorageFull(Slot);
+
+    if (UE_LOG_ACTIVE(LogResourceSystem, Verbose))
+    {
+        UE_LOG(LogResourceSystem, Verbose, TEXT("[RESOURCEMGR_INFO_10] Transaction of %d resource type(s) spent from %s"), Num, *ResourceComponent->GetName());
+    }
+    return true;
+}
+
+bool UResourceManagerSubsystem::AddProductionRate(UResourceSystemComponent* ResourceComponent, int32 ResourceId, float DeltaPerMinute)
+{
+    if (!GetWorld()->GetAuthGameMode() || !ResourceComponent || !ResourceTable.IsValidIndex(ResourceId) || DeltaPerMinute == 0.f) return false;
+
+    const int32 Slot = ResourceComponent->ResourceSlot;
+    if (Slot == INDEX_NONE)
+    {
+        UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_04] Component %s has no resource bucket"), *ResourceComponent->GetName());
+        return false;
+    }
+
+    // Everything produced so far was produced at the old rate
+    SettleProduction(Slot);
+
+    const int32 Index = Slot * BalanceRowStride + ResourceId;
+    float& Rate = ProductionRates[Index];
+    const bool bWasProducing = Rate != 0.f;
+    Rate += DeltaPerMinute;
+    // Adding and removing the same rates may not land exactly on zero
+    if (FMath::IsNearlyZero(Rate, KINDA_SMALL_NUMBER))
+    {
+        Rate = 0.f;
+        ProductionRemainders[Index] = 0.0;
+    }
+    ProducingResourceCounts[Slot] += static_cast<int32>(Rate != 0.f) - static_cast<int32>(bWasProducing);
+
+    int32& Balance = Balances[Index];
+    FPlatformAtomics::InterlockedCompareExchange(&Balance, 0, UnsetBalance);
+
+    if (UE_LOG_ACTIVE(LogResourceSystem, Verbose))
+    {
+        UE_LOG(LogResourceSystem, Verbose, TEXT("[RESOURCEMGR_INFO_11] Production of '%s' for %s changed by %.2f to %.2f per minute"),
+            *ResourceTable[ResourceId].ToString(), *ResourceComponent->GetName(), DeltaPerMinute, Rate);
+    }
+    ResourceComponent->PublishProductionRate(ResourceId, Balance, Rate, GetCapacity(Slot, ResourceId));
+    ScheduleStorageFull(Slot);
+    return true;
+}
+
+bool UResourceManagerSubsystem::AddCapacity(UResourceSystemComponent* ResourceComponent, int32 ResourceId, int32 Delta)
+{
+    if (!GetWorld()->GetAuthGameMode() || !ResourceComponent || !ResourceTable.IsValidIndex(ResourceId) || Delta == 0) return false;
+
+    const int32 Slot = ResourceComponent->ResourceSlot;
+    if (Slot == INDEX_NONE)
+    {
+        UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_04] Component %s has no resource bucket"), *ResourceComponent->GetName());
+        return false;
+    }
+    if (BaseCapacities[ResourceId] == MAX_int32)
+    {
+        UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_08] Resource '%s' has no capacity, storage bonus ignored"), *ResourceTable[ResourceId].ToString());
+        return false;
+    }
+
+    // Production up to now is capped by the old capacity
+    SettleProduction(Slot);
+    int32& Bonus = CapacityBonuses[Slot * BalanceRowStride + ResourceId];
+    Bonus = static_cast<int32>(FMath::Clamp<int64>(static_cast<int64>(Bonus) + Delta, MIN_int32, MAX_int32));
+
+    int32& Balance = Balances[Slot * BalanceRowStride + ResourceId];
+    FPlatformAtomics::InterlockedCompareExchange(&Balance, 0, UnsetBalance);
+    const int32 Capacity = GetCapacity(Slot, ResourceId);
+    if (UE_LOG_ACTIVE(LogResourceSystem, Verbose))
+    {
+        UE_LOG(LogResourceSystem, Verbose, TEXT("[RESOURCEMGR_INFO_12] Capacity of '%s' for %s changed by %d to %d"),
+            *ResourceTable[ResourceId].ToString(), *ResourceComponent->GetName(), Delta, Capacity);
+    }
+    ResourceComponent->PublishResourceAmount(ResourceId, Balance, 0, Capacity);
+    ScheduleStorageFull(Slot);
+    return true;
+}
+
+int32 UResourceManagerSubsystem::GetCapacityById(const UResourceSystemComponent* ResourceComponent, int32 ResourceId) const
+{
+	if (!ResourceComponent || ResourceComponent->ResourceSlot == INDEX_NONE || !ResourceTable.IsValidIndex(ResourceId)) return MAX_int32;
+
+	return GetCapacity(ResourceComponent->ResourceSlot, ResourceId);
+}
+
+int32 UResourceManagerSubsystem::GetCapacity(int32 Slot, int32 ResourceId) const
+{
+	const int32 Base = BaseCapacities[ResourceId];
+	if (Base == MAX_int32) return MAX_int32;
+	return static_cast<int32>(FMath::Clamp<int64>(static_cast<int64>(Base) + CapacityBonuses[Slot * BalanceRowStride + ResourceId], 0, MAX_int32));
+}
+
+void UResourceManagerSubsystem::ScheduleStorageFull(int32 Slot)
+{
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	if (ProducingResourceCounts[Slot] == 0)
+	{
+		TimerManager.ClearTimer(StorageFullTimers[Slot]);
+		return;
+	}
+
+	// Solve Remainder + Rate * t / 60 >= Capacity - Balance for the first resource to fill up
+	const double Elapsed = GetWorld()->GetTimeSeconds() - LastSettleTimes[Slot];
+	double SecondsUntilFull = TNumericLimits<double>::Max();
+	for (int32 ResourceId = 0; ResourceId < ResourceTable.Num(); ++ResourceId)
+	{
+		const int32 Index = Slot * BalanceRowStride + ResourceId;
+		const float Rate = ProductionRates[Index];
+		const int32 Capacity = GetCapacity(Slot, ResourceId);
+		if (Rate <= 0.f || Capacity == MAX_int32 || Balances[Index] >= Capacity) continue;
+
+		const double MissingUnits = Capacity - FMath::Max(Balances[Index], 0) - ProductionRemainders[Index];
+		SecondsUntilFull = FMath::Min(SecondsUntilFull, MissingUnits * 60.0 / Rate - Elapsed);
+	}
+
+	if (SecondsUntilFull == TNumericLimits<double>::Max())
+	{
+		TimerManager.ClearTimer(StorageFullTimers[Slot]);
+		return;
+	}
+	// A little late rather than early, so the settle in the callback reaches the full unit
+	TimerManager.SetTimer(StorageFullTimers[Slot], FTimerDelegate::CreateUObject(this, &UResourceManagerSubsystem::OnStorageFullTimer, Slot),
+		static_cast<float>(FMath::Max(SecondsUntilFull, 0.0)) + 0.01f, false);
+}
+
+void UResourceManagerSubsystem::OnStorageFullTimer(int32 Slot)
+{
+	if (!SlotComponents.IsValidIndex(Slot) || !SlotComponents[Slot].IsValid()) return;
+
+	// Settling publishes the capped balance, the owner raises OnStorageFull when it sees it
+	SettleProduction(Slot);
+	ScheduleStorageFull(Slot);
+}
+
+float UResourceManagerSubsystem::GetProductionRate(const UResourceSystemComponent* ResourceComponent, int32 ResourceId) const
+{
+	if (!ResourceComponent || ResourceComponent->ResourceSlot == INDEX_NONE || !ResourceTable.IsValidIndex(ResourceId)) return 0.f;
+
+	return ProductionRates[ResourceComponent->ResourceSlot * BalanceRowStride + ResourceId];
+}
+
+void UResourceManagerSubsystem::SettleProduction(int32 Slot)
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	const double Elapsed = Now - LastSettleTimes[Slot];
+	LastSettleTimes[Slot] = Now;
+	if (ProducingResourceCounts[Slot] == 0 || Elapsed <= 0.0) return;
+
+	UResourceSystemComponent* Comp = SlotComponents[Slot].Get();
+	int32* Row = GetBalanceRow(Slot);
+	const float* Rates = &ProductionRates[Slot * BalanceRowStride];
+	double* Remainders = &ProductionRemainders[Slot * BalanceRowStride];
+	for (int32 ResourceId = 0; ResourceId < ResourceTable.Num(); ++ResourceId)
+	{
+		if (Rates[ResourceId] == 0.f) continue;
+
+		// Whole units are credited, the fraction carries over so nothing is lost between settles
+		const double Produced = Remainders[ResourceId] + Rates[ResourceId] * Elapsed / 60.0;
+		const double WholeUnits = FMath::FloorToDouble(Produced);
+		Remainders[ResourceId] = Produced - WholeUnits;
+		if (WholeUnits == 0.0) continue;
+
+		const int32 Capacity = GetCapacity(Slot, ResourceId);
+		int32 OldAmount;
+		const int32 NewAmount = UpdateBalance(Row[ResourceId], [WholeUnits, Capacity](int32 Balance)
+		{
+			return SaturatingAdd(FMath::Max(Balance, 0), static_cast<int64>(WholeUnits), Capacity);
+		}, &OldAmount);
+		OldAmount = FMath::Max(OldAmount, 0);
+		if (Rates[ResourceId] > 0.f && NewAmount >= Capacity)
+		{
+			// Full storage wastes production, nothing carries over
+			Remainders[ResourceId] = 0.0;
+		}
+		if (Comp && NewAmount != OldAmount)
+		{
+			RecordChange(Comp, ResourceId, NewAmount - OldAmount, NewAmount, EResourceChangeReason::Production);
+			Comp->PublishResourceAmount(ResourceId, NewAmount, NewAmount - OldAmount, Capacity);
+		}
+	}
+}
+
+int32 UResourceManagerSubsystem::GetProjectedBalance(int32 Slot, int32 ResourceId) const
+{
+	const int32 Index = Slot * BalanceRowStride + ResourceId;
+	if (ProductionRates[Index] == 0.f) return Balances[Index];
+
+	// Same arithmetic as SettleProduction, so a later settle credits exactly what was reported here
+	const double Elapsed = GetWorld()->GetTimeSeconds() - LastSettleTimes[Slot];
+	const double Produced = ProductionRemainders[Index] + ProductionRates[Index] * Elapsed / 60.0;
+	return SaturatingAdd(FMath::Max(Balances[Index], 0), static_cast<int64>(FMath::FloorToDouble(Produced)), GetCapacity(Slot, ResourceId));
+}
+
+UResourceSystemComponent* UResourceManagerSubsystem::FindResourceComponentForActor(const AActor* Actor) const
+{
+	for (const AActor* Current = Actor; Current; Current = Current->GetOwner())
+	{
+		if (UResourceSystemComponent* Comp = Current->FindComponentByClass<UResourceSystemComponent>())
+		{
+			return Comp;
+		}
+
+		const APlayerState* PlayerState = nullptr;
+		if (const APawn* Pawn = Cast<APawn>(Current))
+		{
+			PlayerState = Pawn->GetPlayerState();
+		}
+		else if (const AController* Controller = Cast<AController>(Current))
+		{
+			PlayerState = Controller->PlayerState;
+		}
+
+		if (PlayerState)
+		{
+			if (UResourceSystemComponent* Comp = PlayerState->FindComponentByClass<UResourceSystemComponent>())
+			{
+				return Comp;
+			}
+		}
+	}
+	return nullptr;
+}
+
 UResourceDefinition* UResourceManagerSubsystem::GetDefinition(FName ResourceName) const
 {
 	if (Definitions.Contains(ResourceName))	return Definitions[ResourceName];
 	
 	return nullptr;
 }
+
+bool UResourceManagerSubsystem::RegisterUntaggedDefinition(const FAssetData& AssetData)
+{
+	// Saved before ResourceName was searchable. Only these are loaded during the scan, resaving the asset fixes it.
+	UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_09] '%s' has no ResourceName tag and is loaded to read it, resave the asset"),
+		*AssetData.GetObjectPathString());
+	UResourceDefinition* Asset = Cast<UResourceDefinition>(AssetData.GetAsset());
+	if (!Asset)
+	{
+        UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_01] Failed to load UResourceDefinition '%s'"), *AssetData.GetObjectPathString());
+		return false;
+	}
+
+	FResourceDefinitionInfo& Info = DefinitionInfos.Add(Asset->ResourceName);
+	Info.AssetPath = AssetData.GetSoftObjectPath();
+	Info.bLimitedCapacity = Asset->bLimitedCapacity;
+	Info.BaseCapacity = Asset->BaseCapacity;
+	Definitions.Add(Asset->ResourceName, Asset);
+	return true;
+}
+
+void UResourceManagerSubsystem::RequestDefinition(FName ResourceName, bool bLoadIcon, FOnResourceDefinitionLoaded OnLoaded)
+{
+	const FResourceDefinitionInfo* Info = DefinitionInfos.Find(ResourceName);
+	if (!Info)
+	{
+		OnLoaded.ExecuteIfBound(nullptr);
+		return;
+	}
+
+	UResourceDefinition* Definition = GetDefinition(ResourceName);
+	if (!Definition)
+	{
+		// The streamable manager merges requests for the same asset, concurrent callers share one load
+		UAssetManager::GetStreamableManager().RequestAsyncLoad(Info->AssetPath, FStreamableDelegate::CreateWeakLambda(this,
+			[this, ResourceName, bLoadIcon, OnLoaded]()
+			{
+				UResourceDefinition* Loaded = Cast<UResourceDefinition>(DefinitionInfos.FindRef(ResourceName).AssetPath.ResolveObject());
+				if (!Loaded)
+				{
+					UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCEMGR_ERR_10] Failed to load the definition of '%s'"), *ResourceName.ToString());
+					OnLoaded.ExecuteIfBound(nullptr);
+					return;
+				}
+				Definitions.Add(ResourceName, Loaded);
+				RequestDefinition(ResourceName, bLoadIcon, OnLoaded);
+			}));
+		return;
+	}
+
+	if (!bLoadIcon || Definition->Icon.IsNull() || Definition->Icon.IsValid())
+	{
+		OnLoaded.ExecuteIfBound(Definition);
+		return;
+	}
+
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Definition->Icon.ToSoftObjectPath(),
+		FStreamableDelegate::CreateWeakLambda(this, [this, ResourceName, OnLoaded]()
+		{
+			OnLoaded.ExecuteIfBound(GetDefinition(ResourceName));
+		}));
+	if (Handle)
+	{
+		IconHandles.Add(ResourceName, Handle);
+	}
+}
+
+int32 UResourceManagerSubsystem::FindOrAddResourceId(FName ResourceName)
+{
+	if (const int32* ExistingId = ResourceTableLookup.Find(ResourceName))
+	{
+		return *ExistingId;
+	}
+
+	// IDs travel as uint16 on the wire
+	if (!ensureMsgf(ResourceTable.Num() < MAX_uint16, TEXT("Resource table is full")))
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 NewId = ResourceTable.Add(ResourceName);
+	ResourceTableLookup.Add(ResourceName, NewId);
+	const FResourceDefinitionInfo* Definition = DefinitionInfos.Find(ResourceName);
+	BaseCapacities.Add(Definition && Definition->bLimitedCapacity ? FMath::Max(Definition->BaseCapacity, 0) : MAX_int32);
+	if (NewId >= BalanceRowStride)
+	{
+		GrowBalanceRows(ResourceTable.Num());
+	}
+	UE_LOG(LogResourceSystem, Verbose, TEXT("[RESOURCEMGR_INFO_09] Interned resource '%s' as ID %d"), *ResourceName.ToString(), NewId);
+	RefreshNetTable();
+	return NewId;
+}
+
+int32 UResourceManagerSubsystem::GetResourceId(FName ResourceName) const
+{
+	const int32* ExistingId = ResourceTableLookup.Find(ResourceName);
+	return ExistingId ? *ExistingId : INDEX_NONE;
+}
+
+FName UResourceManagerSubsystem::GetResourceName(int32 ResourceId) const
+{
+	return ResourceTable.IsValidIndex(ResourceId) ? ResourceTable[ResourceId] : NAME_None;
+}
+
+void UResourceManagerSubsystem::SetUpgradePathTable(const TArray<FName>& InUpgradePaths)
+{
+	NetTable.UpgradePaths = InUpgradePaths;
+	RefreshNetTable();
+}
+
+void UResourceManagerSubsystem::RefreshNetTable()
+{
+	NetTable.ResourceNames = ResourceTable;
+	NetTable.Hash = NetTable.ComputeHash();
+	NetTable.bHashComputed = true;
+
+	// Tables only grow while the catalog loads or when a never seen resource is granted, so this is rare
+	for (const TWeakObjectPtr<UResourceSystemComponent>& WeakComp : SlotComponents)
+	{
+		if (UResourceSystemComponent* Comp = WeakComp.Get())
+		{
+			Comp->SetNetTable(NetTable);
+		}
+	}
+}
+
+void UResourceManagerSubsystem::GrowBalanceRows(int32 MinResourceCount)
+{
+	const int32 NewStride = Align(FMath::Max(MinResourceCount, 1), BalanceRowAlignment);
+	if (NewStride <= BalanceRowStride) return;
+
+	// Only happens when a row fills up, normally once while the definitions are seeded and before any component registers
+	const int32 NumRows = SlotComponents.Num();
+	FWriteScopeLock StorageWriteLock(StorageLock);
+	WidenRows(Balances, NumRows, BalanceRowStride, NewStride, UnsetBalance);
+	WidenRows(ProductionRates, NumRows, BalanceRowStride, NewStride, 0.f);
+	WidenRows(ProductionRemainders, NumRows, BalanceRowStride, NewStride, 0.0);
+	WidenRows(CapacityBonuses, NumRows, BalanceRowStride, NewStride, 0);
+	BalanceRowStride = NewStride;
+}
@@ -6,21 +6,39 @@
 #include "ResourceDefinition.h"
 #include "Subsystems/WorldSubsystem.h"
 #include "ResourceSystemComponent.h"
+#include "ResourceLedger.h"
 #include "Logging/LogMacros.h"
+#include "Containers/Queue.h"
+#include "HAL/CriticalSection.h"
+#include "Engine/StreamableManager.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogResourceSystem, Log, All);
+
+class UResourceIconAtlas;
+struct FSlateBrush;
+
+DECLARE_DELEGATE_OneParam(FOnResourceDefinitionLoaded, UResourceDefinition* /*Definition, nullptr on failure*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnResourceComponentRegistered, UResourceSystemComponent* /*Component*/);
 #include "ResourceManagerSubsystem.generated.h"
 
-USTRUCT(BlueprintType)
-struct FResourceBucket
+/** One (resource, amount) pair of a multi-resource transaction */
+struct FResourceAmount
 {
-	GENERATED_BODY()
-
-	/** Map of resource identifier to current amount */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Resources")
-	TMap<FName, int32> Resources;
+	int32 ResourceId = INDEX_NONE;
+	int32 Amount = 0;
 };
 
+/**
+ * Names a component's balances for code running off the game thread, where the component itself must not be touched.
+ * Taken on the game thread with GetWalletHandle. Goes stale once the component unregisters.
+ */
+struct FResourceWalletHandle
+{
+	int32 Slot = INDEX_NONE;
+	uint32 Generation = 0;
+
+	bool IsValid() const { return Slot != INDEX_NONE; }
+};
 
 UCLASS()
 class PLUGIN_DEVELOPMENT_API UResourceManagerSubsystem : public UWorldSubsystem
@@ -36,8 +54,20 @@ public:
 	/** Register a resource component (called in component's BeginPlay) */
 	void RegisterComponent(UResourceSystemComponent* Comp);
 
+	/** Broadcast when a component gets a new, empty resource bucket, so rates and capacities meant for it can be applied */
+	FOnResourceComponentRegistered OnComponentRegistered;
+
+	/** True if the component has a resource bucket, only then do balance, rate and capacity changes reach it */
+	bool IsComponentRegistered(const UResourceSystemComponent* Comp) const { return Comp && SlotComponents.IsValidIndex(Comp->ResourceSlot); }
+
 	/** Unregister a resource component (called in component's EndPlay) */
 	void UnregisterComponent(UResourceSystemComponent* Comp);
+
+	/**
+	 * Empties the component's balances, e.g. for an actor taken from a pool. Rates and capacities stay, they belong to
+	 * whatever granted them. Wallet handles taken before are stale afterwards, so work queued for the old balances is dropped.
+	 */
+	void ResetBalances(UResourceSystemComponent* Comp);
 	/**
  * Adds the specified amount of a resource for the given PlayerState.
  * Broadcasts OnResourceChanged after updating.
@@ -63,16 +93,281 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Resources System")
 	bool SpendResource(UResourceSystemComponent* ResourceComponent, FName ResourceName, int32 Amount);
 
-	/** Returns nullptr if this name isn’t defined */
+	/**
+	 * Deferred AddResource for high frequency grants such as kill rewards. Safe to call from any thread.
+	 * All grants queued during a frame are summed per component and resource and applied once after actors ticked,
+	 * so each resource changes, broadcasts and replicates once per frame however many grants it received.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Resources System")
+	void QueueAddResource(UResourceSystemComponent* ResourceComponent, FName ResourceName, int32 Amount);
+
+	/** Applies every queued grant now and publishes spends made on worker threads. Runs automatically once per frame. */
+	void FlushQueuedGrants();
+
+	/** Game thread only. Handle for the concurrent functions below, invalid if the component is not registered. */
+	FResourceWalletHandle GetWalletHandle(const UResourceSystemComponent* ResourceComponent) const;
+
+	/**
+	 * Grant for AI and simulation tasks, safe to call from any thread. ResourceId must already be interned.
+	 * The grant goes to a per thread shard without touching the balances and is applied with the queued grants.
+	 */
+	void AddResourceConcurrent(const FResourceWalletHandle& Wallet, int32 ResourceId, int32 Amount);
+
+	/**
+	 * Spend for AI and simulation tasks, safe to call from any thread. Deducts with a compare and swap and fails
+	 * instead of waiting if the balance is too low. Only the settled balance counts: production since the last
+	 * settle and grants waiting for the flush cannot be spent here yet. The owner is notified with the next flush.
+	 */
+	bool TrySpendConcurrent(const FResourceWalletHandle& Wallet, int32 ResourceId, int32 Amount);
+
+	/**
+	 * Spends every cost or nothing. All balances are checked first and only then deducted, so a failed
+	 * transaction never leaves the wallet partially charged. The owner gets a single OnResourcesChanged.
+	 * Repeated resource IDs add up.
+	 */
+	bool TrySpend(UResourceSystemComponent* ResourceComponent, TConstArrayView<FResourceAmount> Costs,
+		EResourceChangeReason Reason = EResourceChangeReason::Spend);
+
+	/** TrySpend with costs given as a dense vector indexed by resource ID, e.g. from UUpgradeManagerSubsystem::GetDenseUpgradeCosts */
+	bool TrySpendDense(UResourceSystemComponent* ResourceComponent, TConstArrayView<int32> DenseCosts,
+		EResourceChangeReason Reason = EResourceChangeReason::Spend);
+
+	/**
+	 * Same as the FName versions, for callers that already hold a resource ID. These skip the name lookup.
+	 * Reason is only recorded in the ledger.
+	 */
+	void AddResourceById(UResourceSystemComponent* ResourceComponent, int32 ResourceId, int32 Amount,
+		EResourceChangeReason Reason = EResourceChangeReason::Grant);
+	int32 GetResourceById(const UResourceSystemComponent* ResourceComponent, int32 ResourceId) const;
+	bool SpendResourceById(UResourceSystemComponent* ResourceComponent, int32 ResourceId, int32 Amount,
+		EResourceChangeReason Reason = EResourceChangeReason::Spend);
+
+	/**
+	 * Changes how much of ResourceId the component passively produces per minute. Negative values lower the rate.
+	 * Production is not ticked. Each row remembers when it was last settled and credits the produced amount the next
+	 * time it is read, spent, granted or its rate changes, so idle producers cost nothing per frame.
+	 * @return - false if the change was not applied, e.g. because the component has no bucket
+	 */
+	bool AddProductionRate(UResourceSystemComponent* ResourceComponent, int32 ResourceId, float DeltaPerMinute);
+
+	/** Current production of ResourceId in units per minute */
+	float GetProductionRate(const UResourceSystemComponent* ResourceComponent, int32 ResourceId) const;
+
+	/**
+	 * Raises (or lowers) the component's storage for ResourceId on top of the definition's BaseCapacity.
+	 * Only resources whose definition has a limited capacity can be changed. Grants and production stop at the capacity.
+	 * @return - false if the change was not applied, e.g. because the component has no bucket or the resource no capacity
+	 */
+	bool AddCapacity(UResourceSystemComponent* ResourceComponent, int32 ResourceId, int32 Delta);
+
+	/** MAX_int32 for resources without a capacity */
+	int32 GetCapacityById(const UResourceSystemComponent* ResourceComponent, int32 ResourceId) const;
+
+	/**
+	 * Finds the resource component that pays for Actor: one on the actor itself, on its player state
+	 * (for pawns and controllers) or further up the owner chain. Returns nullptr if there is none.
+	 */
+	UFUNCTION(BlueprintPure, Category="Resources System")
+	UResourceSystemComponent* FindResourceComponentForActor(const AActor* Actor) const;
+
+	/** Returns nullptr if this name isn’t defined or its definition was not loaded yet, see RequestDefinition */
 	UFUNCTION(BlueprintPure, Category="Resources System")
 	UResourceDefinition* GetDefinition(FName ResourceName) const;
 
+	/** True if the scan found a definition for ResourceName, loaded or not */
+	bool HasDefinition(FName ResourceName) const { return DefinitionInfos.Contains(ResourceName); }
+
+	/**
+	 * Streams in the definition of ResourceName, and its icon if bLoadIcon. OnLoaded runs on the game thread once
+	 * everything is in memory (right away if it already is) and gets nullptr if the name is not defined or loading failed.
+	 * Requested definitions and icons stay loaded until the world ends.
+	 */
+	void RequestDefinition(FName ResourceName, bool bLoadIcon, FOnResourceDefinitionLoaded OnLoaded);
+
+	/**
+	 * Points OutBrush at the resource's cell in the icon atlas. All brushes share the atlas texture, so a whole resource
+	 * bar draws in one batch. Returns false while the atlas is still streaming in or if it has no icon for the resource.
+	 */
+	bool MakeAtlasIconBrush(int32 ResourceId, FSlateBrush& OutBrush) const;
+
+	/** Broadcast once the icon atlas finished streaming in */
+	FSimpleMulticastDelegate OnIconAtlasLoaded;
+
+	/**
+	 * Interns ResourceName into the shared resource table and returns its ID.
+	 * IDs are stable for the lifetime of the world and are what the network layer sends instead of FNames.
+	 */
+	int32 FindOrAddResourceId(FName ResourceName);
+
+	/** Returns the ID of ResourceName or INDEX_NONE if it was never interned */
+	int32 GetResourceId(FName ResourceName) const;
+
+	/** Returns NAME_None for unknown IDs */
+	FName GetResourceName(int32 ResourceId) const;
+
+	const TArray<FName>& GetResourceTable() const { return ResourceTable; }
+
+	/** Upgrade paths known to the catalog. Only sent to clients as part of the net table for validation. */
+	void SetUpgradePathTable(const TArray<FName>& InUpgradePaths);
+
+	/** Tables and hash handed to every registered component's owner */
+	const FResourceNetTable& GetNetTable() const { return NetTable; }
+
 private:
-	/** Internal map of PlayerState to its resource bucket */
-	TMap<TWeakObjectPtr<UResourceSystemComponent>, FResourceBucket> ComponentResourceMap;
+	/** Rows are padded to a multiple of this many balances so each one starts on its own cache line */
+	static constexpr int32 BalanceRowAlignment = PLATFORM_CACHE_LINE_SIZE / sizeof(int32);
+
+	/** Balance of a resource the component never held. GetResource reports it as -1. */
+	static constexpr int32 UnsetBalance = INDEX_NONE;
+
+	/** Registered components by slot. Unregistered slots are reset and reused. */
+	TArray<TWeakObjectPtr<UResourceSystemComponent>> SlotComponents;
+
+	/** Holes in SlotComponents */
+	TArray<int32> FreeSlots;
+
+	/** Per slot. Bumped when the slot is freed so wallet handles to it go stale. */
+	TArray<uint32> SlotGenerations;
+
+	/**
+	 * Worker threads read and swap balances in place. This is held for writing whenever Balances or SlotGenerations
+	 * reallocate or a slot is freed, and for reading by the concurrent functions. Game thread reads need no lock.
+	 */
+	mutable FRWLock StorageLock;
+
+	/** One row of BalanceRowStride balances per slot, indexed by resource ID */
+	TArray<int32, TAlignedHeapAllocator<PLATFORM_CACHE_LINE_SIZE>> Balances;
+
+	int32 BalanceRowStride = 0;
+
+	int32* GetBalanceRow(int32 Slot) { return Balances.GetData() + Slot * BalanceRowStride; }
+	const int32* GetBalanceRow(int32 Slot) const { return Balances.GetData() + Slot * BalanceRowStride; }
+
+	/** Production per minute, same layout as Balances */
+	TArray<float, TAlignedHeapAllocator<PLATFORM_CACHE_LINE_SIZE>> ProductionRates;
+
+	/** Fraction of a unit produced but not credited yet, same layout as Balances. Keeps settling exact. */
+	TArray<double, TAlignedHeapAllocator<PLATFORM_CACHE_LINE_SIZE>> ProductionRemainders;
+
+	/** Per slot. World time the row was last settled at. */
+	TArray<double> LastSettleTimes;
+
+	/** Per slot. Number of resources with a non zero rate, rows without any skip settling. */
+	TArray<int32> ProducingResourceCounts;
+
+	/** Storage added on top of the base capacity, same layout as Balances */
+	TArray<int32, TAlignedHeapAllocator<PLATFORM_CACHE_LINE_SIZE>> CapacityBonuses;
+
+	/** Per resource ID. Capacity from the definition, MAX_int32 for unlimited resources. */
+	TArray<int32> BaseCapacities;
+
+	/** Per slot. Fires when the first producing resource of the row reaches its capacity. */
+	TArray<FTimerHandle> StorageFullTimers;
+
+	int32 GetCapacity(int32 Slot, int32 ResourceId) const;
+
+	/** Computes when the row's first producing resource fills up and sets the slot's timer, or clears it if none will */
+	void ScheduleStorageFull(int32 Slot);
+
+	void OnStorageFullTimer(int32 Slot);
+
+	/** Re-lays out every row when the resource table outgrows the current stride */
+	void GrowBalanceRows(int32 MinResourceCount);
 
-	/** Map of resource-name → its design-time data asset */
+	/** Credits everything the slot produced since it was last settled */
+	void SettleProduction(int32 Slot);
+
+	/** Balance including production not settled yet, without settling */
+	int32 GetProjectedBalance(int32 Slot, int32 ResourceId) const;
+
+	/** A grant waiting for the next flush. The name is resolved on the game thread because interning is not thread safe. */
+	struct FQueuedResourceGrant
+	{
+		TWeakObjectPtr<UResourceSystemComponent> Component;
+		FName ResourceName;
+		int32 Amount = 0;
+	};
+
+	/** Lock free, any number of producer threads and the game thread as the only consumer */
+	TQueue<FQueuedResourceGrant, EQueueMode::Mpsc> QueuedGrants;
+
+	/** Grant or spend made off the game thread, waiting for the next flush */
+	struct FConcurrentChange
+	{
+		int32 Slot;
+		uint32 Generation;
+		int32 ResourceId;
+		int32 Amount;
+	};
+
+	/** Threads pick a shard by thread ID, so concurrent producers rarely share a lock or a cache line */
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FConcurrentShard
+	{
+		FCriticalSection Lock;
+		TArray<FConcurrentChange> Grants;
+		TArray<FConcurrentChange> Spends;
+	};
+
+	static constexpr uint32 NumConcurrentShards = 32;
+
+	FConcurrentShard ConcurrentShards[NumConcurrentShards];
+
+	FConcurrentShard& GetThreadShard() { return ConcurrentShards[FPlatformTLS::GetCurrentThreadId() % NumConcurrentShards]; }
+
+	bool IsCurrentHandle(int32 Slot, uint32 Generation) const { return SlotGenerations.IsValidIndex(Slot) && SlotGenerations[Slot] == Generation; }
+
+	/** Notifies owners of balances worker threads spent from since the last flush */
+	void PublishConcurrentSpends(TArray<FConcurrentChange>& Spends);
+
+	FDelegateHandle PostActorTickHandle;
+
+	/** Set on the server while UResourceSettings::bRecordLedger is on */
+	TUniquePtr<FResourceLedger> Ledger;
+
+	/** Appends a balance change to the ledger if one is recording */
+	void RecordChange(const UResourceSystemComponent* ResourceComponent, int32 ResourceId, int32 Delta, int32 NewBalance, EResourceChangeReason Reason);
+
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/** What the scan reads from the asset registry, enough to run without loading the definition */
+	struct FResourceDefinitionInfo
+	{
+		FSoftObjectPath AssetPath;
+		bool bLimitedCapacity = false;
+		int32 BaseCapacity = 0;
+	};
+
+	/** Every definition found by the scan, by resource name */
+	TMap<FName, FResourceDefinitionInfo> DefinitionInfos;
+
+	/** Definitions loaded so far, by resource name */
 	UPROPERTY()
-	TMap<FName, UResourceDefinition*> Definitions;
+	TMap<FName, TObjectPtr<UResourceDefinition>> Definitions;
+
+	/** Keep requested icons in memory, the definitions only hold them softly */
+	TMap<FName, TSharedPtr<FStreamableHandle>> IconHandles;
+
+	/** Streamed in on clients from UResourceSettings::IconAtlas */
+	UPROPERTY()
+	TObjectPtr<UResourceIconAtlas> IconAtlas;
+
+	/** Atlas UVs by resource ID, built when the atlas arrives. Empty boxes for resources without an icon. */
+	TArray<FBox2f> IconUVsById;
+
+	void OnIconAtlasStreamed();
+
+	/** Registers a definition the registry has no tags for, by loading it */
+	bool RegisterUntaggedDefinition(const FAssetData& AssetData);
+
+	/** Interned resource names. The index is the resource ID. */
+	TArray<FName> ResourceTable;
+
+	/** Reverse lookup of ResourceTable */
+	TMap<FName, int32> ResourceTableLookup;
+
+	FResourceNetTable NetTable;
+
+	/** Recomputes the net table hash and pushes the table to every registered component */
+	void RefreshNetTable();
 	
 };
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "ResourceSettings.generated.h"
+
+class UResourceIconAtlas;
+
+UCLASS(config=Game, defaultconfig, meta=(DisplayName="Resource System Settings"))
+class PLUGIN_DEVELOPMENT_API UResourceSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	// Folder scanned for UResourceDefinition assets. Definitions are registered from asset registry tags and only
+	// loaded when requested.
+	UPROPERTY(EditAnywhere, config, Category="Resource Catalog")
+	FString ResourceScanPath = TEXT("/Game/Data/Resources");
+
+	// Atlas of every resource icon, used by the resource bar. Updated in the editor whenever a definition's icon changes.
+	UPROPERTY(EditAnywhere, config, Category="Resource Catalog")
+	TSoftObjectPtr<UResourceIconAtlas> IconAtlas;
+
+	// Records every balance change on the server to Saved/ResourceLedger, for tracking down exploits and for analytics.
+	// Query the files offline with the ResourceLedger commandlet.
+	UPROPERTY(EditAnywhere, config, Category="Ledger")
+	bool bRecordLedger = false;
+
+	// Changes buffered between two writes, rounded up to a power of two. When the buffer is full, changes are dropped
+	// and counted in the file rather than stalling the game thread.
+	UPROPERTY(EditAnywhere, config, Category="Ledger", meta=(ClampMin="1024"))
+	int32 LedgerBufferSize = 65536;
+
+	// Seconds between two writes to disk
+	UPROPERTY(EditAnywhere, config, Category="Ledger", meta=(ClampMin="0.1"))
+	float LedgerFlushInterval = 1.f;
+};
@@ -1,18 +1,269 @@
 #include "ResourceSystemComponent.h"
 #include "ResourceManagerSubsystem.h"
+#include "../RequestRateLimiterSubsystem.h"
 #include "GameFramework/PlayerState.h"
 #include "GameFramework/Controller.h"
+#include "GameFramework/GameStateBase.h"
+#include "Net/UnrealNetwork.h"
+#include "TimerManager.h"
+
+DECLARE_STATS_GROUP(TEXT("ResourceSystem"), STATGROUP_ResourceSystem, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bucket Items Published"), STAT_ResourceItemsPublished, STATGROUP_ResourceSystem);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bucket Items Received"), STAT_ResourceItemsReceived, STATGROUP_ResourceSystem);
+
+uint32 FResourceNetTable::ComputeHash() const
+{
+    uint32 Crc = 0;
+    for (const FName& ResourceName : ResourceNames)
+    {
+        Crc = FCrc::StrCrc32(*ResourceName.ToString(), Crc);
+    }
+    // Separator so moving a name from one table to the other changes the hash
+    Crc = FCrc::MemCrc32(TEXT("|"), sizeof(TCHAR), Crc);
+    for (const FName& UpgradePath : UpgradePaths)
+    {
+        Crc = FCrc::StrCrc32(*UpgradePath.ToString(), Crc);
+    }
+    return Crc;
+}
+
+void FResourceReplicatedItem::PostReplicatedAdd(const FResourceReplicatedList& InArraySerializer)
+{
+    if (InArraySerializer.OwnerComponent)
+    {
+        InArraySerializer.OwnerComponent->ApplyReplicatedItem(*this);
+    }
+}
+
+void FResourceReplicatedItem::PostReplicatedChange(const FResourceReplicatedList& InArraySerializer)
+{
+    if (InArraySerializer.OwnerComponent)
+    {
+        InArraySerializer.OwnerComponent->ApplyReplicatedItem(*this);
+    }
+}
+
+FResourceReplicatedItem& FResourceReplicatedList::FindOrAddItem(uint16 ResourceId)
+{
+    // Buckets hold a handful of resource types, a linear scan beats hashing here
+    for (FResourceReplicatedItem& Item : Items)
+    {
+        if (Item.ResourceId == ResourceId)
+        {
+            return Item;
+        }
+    }
+
+    FResourceReplicatedItem& NewItem = Items.AddDefaulted_GetRef();
+    NewItem.ResourceId = ResourceId;
+    return NewItem;
+}
+
+void FResourceReplicatedList::SetAmount(uint16 ResourceId, int32 NewAmount, double SettleTime, int32 Capacity)
+{
+    FResourceReplicatedItem& Item = FindOrAddItem(ResourceId);
+    Item.Amount = NewAmount;
+    Item.SettleTime = SettleTime;
+    Item.Capacity = Capacity;
+    MarkItemDirty(Item);
+}
+
+void FResourceReplicatedList::SetProduction(uint16 ResourceId, int32 Amount, float RatePerMinute, double SettleTime, int32 Capacity)
+{
+    FResourceReplicatedItem& Item = FindOrAddItem(ResourceId);
+    Item.Amount = Amount;
+    Item.RatePerMinute = RatePerMinute;
+    Item.SettleTime = SettleTime;
+    Item.Capacity = Capacity;
+    MarkItemDirty(Item);
+}
+
+void FResourceReplicatedList::PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
+{
+    if (OwnerComponent)
+    {
+        OwnerComponent->BroadcastResourcesChanged();
+    }
+}
 
 UResourceSystemComponent::UResourceSystemComponent()
 {
     PrimaryComponentTick.bCanEverTick = false;
     SetIsReplicatedByDefault(true);
+    ReplicatedResources.OwnerComponent = this;
 }
 
-void UResourceSystemComponent::Client_UpdateResource_Implementation(FName ResourceName, int32 NewAmount, int32 DeltaAmount)
+void UResourceSystemComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
-    LocalResources.FindOrAdd(ResourceName) = NewAmount;
-    OnResourceChanged.Broadcast(ResourceName, NewAmount, DeltaAmount);
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+    DOREPLIFETIME_CONDITION(UResourceSystemComponent, NetTable, COND_OwnerOnly);
+    DOREPLIFETIME_CONDITION(UResourceSystemComponent, ReplicatedResources, COND_OwnerOnly);
+}
+
+void UResourceSystemComponent::SetNetTable(const FResourceNetTable& InNetTable)
+{
+    NetTable = InNetTable;
+    RebuildNetResourceIds();
+}
+
+void UResourceSystemComponent::RebuildNetResourceIds()
+{
+    NetResourceIds.Reset();
+    for (int32 i = 0; i < NetTable.ResourceNames.Num(); ++i)
+    {
+        NetResourceIds.Add(NetTable.ResourceNames[i], static_cast<uint16>(i));
+    }
+}
+
+int32 UResourceSystemComponent::GetNetResourceId(FName ResourceName) const
+{
+    const uint16* ResourceId = NetResourceIds.Find(ResourceName);
+    return ResourceId ? *ResourceId : INDEX_NONE;
+}
+
+void UResourceSystemComponent::OnRep_NetTable()
+{
+    if (!NetTable.IsValid())
+    {
+        UE_LOG(LogResourceSystem, Error, TEXT("[RESOURCECOMP_ERR_00] Received resource table with invalid hash %u on %s"), NetTable.Hash, *GetName());
+        NetResourceIds.Reset();
+        return;
+    }
+    RebuildNetResourceIds();
+
+    // The client builds the same tables from its local catalog. A mismatch means cost previews may disagree with the server.
+    if (const UResourceManagerSubsystem* Sub = GetResourceSubsystem())
+    {
+        if (Sub->GetNetTable().Hash != NetTable.Hash)
+        {
+            UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCECOMP_ERR_01] Local resource table (hash %u) differs from the server table (hash %u)"),
+                Sub->GetNetTable().Hash, NetTable.Hash);
+        }
+    }
+
+    // Items that arrived before the table could not be resolved, apply them now
+    for (const FResourceReplicatedItem& Item : ReplicatedResources.Items)
+    {
+        ApplyReplicatedItem(Item);
+    }
+    BroadcastResourcesChanged();
+}
+
+void UResourceSystemComponent::PublishResourceAmount(int32 ResourceId, int32 NewAmount, int32 DeltaAmount, int32 Capacity)
+{
+    INC_DWORD_STAT(STAT_ResourceItemsPublished);
+    const double Now = GetServerTime();
+    ReplicatedResources.SetAmount(static_cast<uint16>(ResourceId), NewAmount, Now, Capacity);
+
+    // Replication callbacks never run on the server, so a locally owned bucket is notified directly.
+    // This matches where the old Client RPC used to execute.
+    if (GetOwner() && !GetOwner()->GetNetConnection() && NetTable.ResourceNames.IsValidIndex(ResourceId))
+    {
+        const FName ResourceName = NetTable.ResourceNames[ResourceId];
+        int32& LocalAmount = LocalResources.FindOrAdd(ResourceName);
+        const int32 OldAmount = LocalAmount;
+        LocalAmount = NewAmount;
+        if (FLocalProduction* Production = LocalProduction.Find(ResourceName))
+        {
+            Production->SettleTime = Now;
+        }
+        // Capacity changes are published without a delta
+        if (DeltaAmount != 0)
+        {
+            OnResourceChanged.Broadcast(ResourceName, NewAmount, DeltaAmount);
+        }
+        UpdateLocalCapacity(ResourceName, OldAmount, NewAmount, Capacity);
+        MarkResourcesChanged();
+    }
+}
+
+void UResourceSystemComponent::PublishProductionRate(int32 ResourceId, int32 Amount, float RatePerMinute, int32 Capacity)
+{
+    const double Now = GetServerTime();
+    ReplicatedResources.SetProduction(static_cast<uint16>(ResourceId), Amount, RatePerMinute, Now, Capacity);
+
+    if (GetOwner() && !GetOwner()->GetNetConnection() && NetTable.ResourceNames.IsValidIndex(ResourceId))
+    {
+        const FName ResourceName = NetTable.ResourceNames[ResourceId];
+        int32& LocalAmount = LocalResources.FindOrAdd(ResourceName);
+        const int32 OldAmount = LocalAmount;
+        LocalAmount = Amount;
+        CacheLocalProduction(ResourceName, RatePerMinute, Now);
+        UpdateLocalCapacity(ResourceName, OldAmount, Amount, Capacity);
+        MarkResourcesChanged();
+    }
+}
+
+void UResourceSystemComponent::CacheLocalProduction(FName ResourceName, float RatePerMinute, double SettleTime)
+{
+    if (RatePerMinute == 0.f)
+    {
+        LocalProduction.Remove(ResourceName);
+        return;
+    }
+    FLocalProduction& Production = LocalProduction.FindOrAdd(ResourceName);
+    Production.RatePerMinute = RatePerMinute;
+    Production.SettleTime = SettleTime;
+}
+
+void UResourceSystemComponent::UpdateLocalCapacity(FName ResourceName, int32 OldAmount, int32 NewAmount, int32 Capacity)
+{
+    if (Capacity == MAX_int32)
+    {
+        LocalCapacities.Remove(ResourceName);
+        return;
+    }
+    LocalCapacities.FindOrAdd(ResourceName) = Capacity;
+    if (OldAmount < Capacity && NewAmount >= Capacity)
+    {
+        OnStorageFull.Broadcast(ResourceName, Capacity);
+    }
+}
+
+double UResourceSystemComponent::GetServerTime() const
+{
+    const UWorld* World = GetWorld();
+    if (!World) return 0.0;
+    const AGameStateBase* GameState = World->GetGameState();
+    return GameState ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
+void UResourceSystemComponent::MarkResourcesChanged()
+{
+    if (bResourcesChangedPending) return;
+
+    bResourcesChangedPending = true;
+    GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UResourceSystemComponent::BroadcastResourcesChanged);
+}
+
+void UResourceSystemComponent::BroadcastResourcesChanged()
+{
+    if (!bResourcesChangedPending) return;
+
+    bResourcesChangedPending = false;
+    OnResourcesChanged.Broadcast();
+}
+
+void UResourceSystemComponent::ApplyReplicatedItem(const FResourceReplicatedItem& Item)
+{
+    INC_DWORD_STAT(STAT_ResourceItemsReceived);
+    // Resolved again from OnRep_NetTable if the table is not here yet
+    if (!NetTable.ResourceNames.IsValidIndex(Item.ResourceId)) return;
+
+    const FName ResourceName = NetTable.ResourceNames[Item.ResourceId];
+    int32& LocalAmount = LocalResources.FindOrAdd(ResourceName);
+    // Every server side change since the last net update arrives as one delta
+    const int32 OldAmount = LocalAmount;
+    const int32 DeltaAmount = Item.Amount - LocalAmount;
+    LocalAmount = Item.Amount;
+    CacheLocalProduction(ResourceName, Item.RatePerMinute, Item.SettleTime);
+    if (DeltaAmount != 0)
+    {
+        OnResourceChanged.Broadcast(ResourceName, Item.Amount, DeltaAmount);
+    }
+    UpdateLocalCapacity(ResourceName, OldAmount, Item.Amount, Item.Capacity);
+    // The item only replicates when something changed, a new capacity counts too
+    bResourcesChangedPending = true;
 }
 
 void UResourceSystemComponent::BeginPlay()
@@ -48,50 +299,110 @@ UResourceManagerSubsystem* UResourceSystemComponent::GetResourceSubsystem() cons
 
 void UResourceSystemComponent::AddResource(FName ResourceName, int32 Amount)
 {
+    // Ignored like on the server, sending it would fail the RPC's validation and disconnect this client
+    if (Amount <= 0) return;
+
     if (GetOwner() && GetOwner()->HasAuthority())
     {
         GetResourceSubsystem()->AddResource(this, ResourceName, Amount);
     }
     else
     {
-        Server_AddResource(ResourceName, Amount);
+        const int32 ResourceId = GetNetResourceId(ResourceName);
+        if (ResourceId == INDEX_NONE)
+        {
+            UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCECOMP_ERR_02] Resource '%s' is not in the server resource table"), *ResourceName.ToString());
+            return;
+        }
+        Server_AddResource(static_cast<uint16>(ResourceId), Amount);
     }
 }
 
 void UResourceSystemComponent::SpendResource(FName ResourceName, int32 Amount)
 {
+    // Ignored like on the server, sending it would fail the RPC's validation and disconnect this client
+    if (Amount <= 0) return;
+
     if (GetOwner() && GetOwner()->HasAuthority())
     {
         GetResourceSubsystem()->SpendResource(this, ResourceName, Amount);
     }
     else
     {
-        Server_SpendResource(ResourceName, Amount);
+        const int32 ResourceId = GetNetResourceId(ResourceName);
+        if (ResourceId == INDEX_NONE)
+        {
+            UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCECOMP_ERR_02] Resource '%s' is not in the server resource table"), *ResourceName.ToString());
+            return;
+        }
+        Server_SpendResource(static_cast<uint16>(ResourceId), Amount);
     }
 }
 
 int32 UResourceSystemComponent::GetResource(FName ResourceName) const
 {
-    if (const int32* Val = LocalResources.Find(ResourceName))
+    const int32* Val = LocalResources.Find(ResourceName);
+    if (!Val) return -1;
+
+    // Production between two server settles is extrapolated here, nothing ticks to keep the cached amount current
+    if (const FLocalProduction* Production = LocalProduction.Find(ResourceName))
     {
-        return *Val;
+        const double Produced = Production->RatePerMinute * FMath::Max(GetServerTime() - Production->SettleTime, 0.0) / 60.0;
+        const int32* Capacity = LocalCapacities.Find(ResourceName);
+        const int64 Upper = Capacity && Produced > 0.0 ? FMath::Max(*Capacity, *Val) : MAX_int32;
+        return static_cast<int32>(FMath::Clamp<int64>(*Val + static_cast<int64>(FMath::FloorToDouble(Produced)), 0, Upper));
     }
-    return -1;
+    return *Val;
+}
+
+int32 UResourceSystemComponent::GetCapacity(FName ResourceName) const
+{
+    const int32* Capacity = LocalCapacities.Find(ResourceName);
+    return Capacity ? *Capacity : MAX_int32;
+}
+
+float UResourceSystemComponent::GetProductionRate(FName ResourceName) const
+{
+    const FLocalProduction* Production = LocalProduction.Find(ResourceName);
+    return Production ? Production->RatePerMinute : 0.f;
 }
 
 void UResourceSystemComponent::GetAllResources(TMap<FName, int32>& OutAvailableResources) const
 {
     OutAvailableResources = LocalResources;
+    for (const auto& Pair : LocalProduction)
+    {
+        OutAvailableResources.FindOrAdd(Pair.Key) = GetResource(Pair.Key);
+    }
 }
 
-void UResourceSystemComponent::Server_AddResource_Implementation(FName ResourceName, int32 Amount)
+bool UResourceSystemComponent::Server_AddResource_Validate(uint16 ResourceId, int32 Amount) { return Amount > 0; }
+
+void UResourceSystemComponent::Server_AddResource_Implementation(uint16 ResourceId, int32 Amount)
 {
-    GetResourceSubsystem()->AddResource(this, ResourceName, Amount);
+    URequestRateLimiterSubsystem* RateLimiter = GetWorld()->GetSubsystem<URequestRateLimiterSubsystem>();
+    if (!bAcceptClientGrants)
+    {
+        if (!RateLimiter || RateLimiter->ShouldLogRejection(TEXT("RESOURCECOMP_ERR_03")))
+        {
+            UE_LOG(LogResourceSystem, Warning, TEXT("[RESOURCECOMP_ERR_03] %s does not accept resource grants from its client"), *GetNameSafe(GetOwner()));
+        }
+        return;
+    }
+    if (RateLimiter && !RateLimiter->TryConsume(this, ERateLimitedRequest::Resource)) return;
+
+    // Unknown IDs are rejected by the index check inside
+    GetResourceSubsystem()->AddResourceById(this, ResourceId, Amount, EResourceChangeReason::ClientRequest);
 }
 
-void UResourceSystemComponent::Server_SpendResource_Implementation(FName ResourceName, int32 Amount)
+bool UResourceSystemComponent::Server_SpendResource_Validate(uint16 ResourceId, int32 Amount) { return Amount > 0; }
+
+void UResourceSystemComponent::Server_SpendResource_Implementation(uint16 ResourceId, int32 Amount)
 {
-    GetResourceSubsystem()->SpendResource(this, ResourceName, Amount);
+    URequestRateLimiterSubsystem* RateLimiter = GetWorld()->GetSubsystem<URequestRateLimiterSubsystem>();
+    if (RateLimiter && !RateLimiter->TryConsume(this, ERateLimitedRequest::Resource)) return;
+
+    GetResourceSubsystem()->SpendResourceById(this, ResourceId, Amount, EResourceChangeReason::ClientRequest);
 }
 
 void UResourceSystemComponent::HandleResourceChanged_Implementation(FName ResourceName, int32 NewAmount, int32 AmountChange)
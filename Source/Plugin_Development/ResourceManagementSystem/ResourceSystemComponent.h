@@ -3,11 +3,115 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Net/Serialization/FastArraySerializer.h"
 #include "ResourceSystemComponent.generated.h"
 
 class UResourceManagerSubsystem;
+class UResourceSystemComponent;
+struct FResourceReplicatedList;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnResourceChanged, FName, ResourceName, int32, NewAmount, int32, DeltaAmount);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnResourcesChanged);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnStorageFull, FName, ResourceName, int32, Capacity);
+
+/**
+ * Interned name tables sent to each owning client once.
+ * After the handshake resources travel as uint16 indices into ResourceNames instead of FName strings.
+ */
+USTRUCT()
+struct PLUGIN_DEVELOPMENT_API FResourceNetTable
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FName> ResourceNames;
+
+	UPROPERTY()
+	TArray<FName> UpgradePaths;
+
+	/** Hash of both tables, computed by the server. Any value, 0 included, is a legitimate CRC. */
+	UPROPERTY()
+	uint32 Hash = 0;
+
+	/** Set once the server filled the tables and computed Hash, a default constructed table is never valid */
+	UPROPERTY()
+	bool bHashComputed = false;
+
+	uint32 ComputeHash() const;
+	bool IsValid() const { return bHashComputed && Hash == ComputeHash(); }
+};
+
+/** One replicated (resource, amount) entry of a component's bucket */
+USTRUCT()
+struct FResourceReplicatedItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	/** Index into FResourceNetTable::ResourceNames */
+	UPROPERTY()
+	uint16 ResourceId = 0;
+
+	UPROPERTY()
+	int32 Amount = 0;
+
+	/** Passive production per minute. Clients extrapolate Amount from it between updates. */
+	UPROPERTY()
+	float RatePerMinute = 0.f;
+
+	/** Server world time Amount was valid at */
+	UPROPERTY()
+	double SettleTime = 0.0;
+
+	/** Storage limit, MAX_int32 for resources without one */
+	UPROPERTY()
+	int32 Capacity = MAX_int32;
+
+	void PostReplicatedAdd(const FResourceReplicatedList& InArraySerializer);
+	void PostReplicatedChange(const FResourceReplicatedList& InArraySerializer);
+};
+
+/**
+ * Owner-only replicated copy of the server side bucket.
+ * Only items marked dirty since the last net update are sent, so many changes to the same resource
+ * between two updates collapse into a single item delta.
+ */
+USTRUCT()
+struct FResourceReplicatedList : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FResourceReplicatedItem> Items;
+
+	/** Component that owns this list. Used by the client side callbacks. */
+	UPROPERTY(NotReplicated)
+	TObjectPtr<UResourceSystemComponent> OwnerComponent = nullptr;
+
+	/** Server only. Writes the new amount and marks the item dirty. */
+	void SetAmount(uint16 ResourceId, int32 NewAmount, double SettleTime, int32 Capacity);
+
+	/** Server only. Writes amount and production rate together and marks the item dirty. */
+	void SetProduction(uint16 ResourceId, int32 Amount, float RatePerMinute, double SettleTime, int32 Capacity);
+
+	FResourceReplicatedItem& FindOrAddItem(uint16 ResourceId);
+
+	/** Client side. Runs once per received update, after all item callbacks. */
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FResourceReplicatedItem, FResourceReplicatedList>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FResourceReplicatedList> : public TStructOpsTypeTraitsBase2<FResourceReplicatedList>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
 
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class PLUGIN_DEVELOPMENT_API UResourceSystemComponent : public UActorComponent
@@ -16,7 +120,7 @@ class PLUGIN_DEVELOPMENT_API UResourceSystemComponent : public UActorComponent
 
 public:
 	UResourceSystemComponent();
-	
+
 	/** Adds Amount of ResourceName to the owner player's bucket */
 	UFUNCTION(BlueprintCallable, Category="Resource System")
 	void AddResource(FName ResourceName, int32 Amount);
@@ -25,10 +129,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Resource System")
 	void SpendResource(FName ResourceName, int32 Amount);
 
-	/** Returns the current amount of ResourceName for the owner */
+	/** Returns the current amount of ResourceName for the owner, including passive production since the last update */
 	UFUNCTION(BlueprintPure, Category="Resource System")
 	int32 GetResource(FName ResourceName) const;
 
+	/** Passive production of ResourceName in units per minute */
+	UFUNCTION(BlueprintPure, Category="Resource System")
+	float GetProductionRate(FName ResourceName) const;
+
+	/** Most the owner can hold of ResourceName, MAX_int32 if it is unlimited */
+	UFUNCTION(BlueprintPure, Category="Resource System")
+	int32 GetCapacity(FName ResourceName) const;
+
 	UFUNCTION(BlueprintPure, Category="Resource System")
 	void GetAllResources(TMap<FName, int32>& OutAvailableResources) const;
 
@@ -36,27 +148,114 @@ public:
 	UPROPERTY(BlueprintAssignable, Category="Resource System")
 	FOnResourceChanged OnResourceChanged;
 
-	/** Server RPC to forward client requests */
-	UFUNCTION(Server, Reliable)
-	void Server_AddResource(FName ResourceName, int32 Amount);
+	/**
+	 * Fired once after any number of resources changed together: once per received net update on clients and
+	 * once per frame for a locally owned bucket. A multi-resource spend therefore produces a single event.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Resource System")
+	FOnResourcesChanged OnResourcesChanged;
+
+	/**
+	 * Fired on the owner when a resource reaches its capacity. Production fills storage without any update in between,
+	 * the server schedules one for the moment it becomes full so this fires on time.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Resource System")
+	FOnStorageFull OnStorageFull;
+
+	/**
+	 * Server RPC to forward client requests. ResourceId indexes the handshake table.
+	 * Non-positive amounts fail validation, requests over the connection's budget are dropped.
+	 */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void Server_AddResource(uint16 ResourceId, int32 Amount);
 
-	UFUNCTION(Server, Reliable)
-	void Server_SpendResource(FName ResourceName, int32 Amount);
+	UFUNCTION(Server, Reliable, WithValidation)
+	void Server_SpendResource(uint16 ResourceId, int32 Amount);
+
+	/** If false, resources can only be granted by server gameplay code and client AddResource requests are rejected */
+	UPROPERTY(EditDefaultsOnly, Category="Resource System")
+	bool bAcceptClientGrants = false;
+
+	/**
+	 * Server only. Pushes the authoritative amount into the replicated list.
+	 * Remote owners receive it with the next net update, a local owner is notified immediately.
+	 */
+	void PublishResourceAmount(int32 ResourceId, int32 NewAmount, int32 DeltaAmount, int32 Capacity);
+
+	/** Server only. Pushes a changed production rate together with the settled amount it starts from. */
+	void PublishProductionRate(int32 ResourceId, int32 Amount, float RatePerMinute, int32 Capacity);
+
+	/** Server only. Sends the interned name tables to the owner. Called on registration and whenever the tables grow. */
+	void SetNetTable(const FResourceNetTable& InNetTable);
+
+	/** Returns the handshake table index of ResourceName, or INDEX_NONE before the table arrived */
+	int32 GetNetResourceId(FName ResourceName) const;
 
-	/** Client RPCs */
-	UFUNCTION(Client, Reliable)
-	void Client_UpdateResource(FName ResourceName, int32 NewAmount, int32 DeltaAmount);
-	
 	UFUNCTION(BlueprintNativeEvent, Category="Resource System")
 	void HandleResourceChanged(FName ResourceName, int32 NewAmount, int32 AmountChange);
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 protected:
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 private:
+	friend struct FResourceReplicatedItem;
+	friend class UResourceManagerSubsystem;
+
+	/** Server only. Row of this component's balances in the manager, INDEX_NONE while unregistered. */
+	int32 ResourceSlot = INDEX_NONE;
+
 	TMap<FName, int32> LocalResources;
-	
+
+	struct FLocalProduction
+	{
+		float RatePerMinute = 0.f;
+		double SettleTime = 0.0;
+	};
+
+	/** Owner side production of resources with a non zero rate, used to extrapolate LocalResources */
+	TMap<FName, FLocalProduction> LocalProduction;
+
+	void CacheLocalProduction(FName ResourceName, float RatePerMinute, double SettleTime);
+
+	/** Owner side capacities of limited resources */
+	TMap<FName, int32> LocalCapacities;
+
+	/** Stores the new capacity and fires OnStorageFull if the amount just reached it */
+	void UpdateLocalCapacity(FName ResourceName, int32 OldAmount, int32 NewAmount, int32 Capacity);
+
+	/** Server world time on the owner, the clock SettleTime is measured in */
+	double GetServerTime() const;
+
+	/** Declared before ReplicatedResources so the table is received ahead of the items that index into it */
+	UPROPERTY(ReplicatedUsing=OnRep_NetTable)
+	FResourceNetTable NetTable;
+
+	/** Reverse lookup of NetTable.ResourceNames */
+	TMap<FName, uint16> NetResourceIds;
+
+	/** Bucket replicated to the owning client only */
+	UPROPERTY(Replicated)
+	FResourceReplicatedList ReplicatedResources;
+
+	UFUNCTION()
+	void OnRep_NetTable();
+
+	void RebuildNetResourceIds();
+
+	/** Client side. Applies a replicated item and broadcasts the change since the last received value. */
+	void ApplyReplicatedItem(const FResourceReplicatedItem& Item);
+
+	/** Set by every applied change, cleared when OnResourcesChanged fires */
+	bool bResourcesChangedPending = false;
+
+	/** Local owner. Collects this frame's changes into one OnResourcesChanged on the next tick. */
+	void MarkResourcesChanged();
+
+	void BroadcastResourcesChanged();
+
 	/** Cached pointer to the WorldSubsystem */
 	UResourceManagerSubsystem* GetResourceSubsystem() const;
 
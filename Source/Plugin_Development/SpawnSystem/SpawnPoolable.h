@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "SpawnPoolable.generated.h"
+
+UINTERFACE(MinimalAPI, BlueprintType)
+class USpawnPoolable : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Optional for actors spawned through USpawnerManagementSubsystem. Pooled actors are hidden, lose collision and stop
+ * ticking, their running upgrades are canceled and their instanced meshes removed. They keep their components and
+ * registrations (e.g. with the upgrade and resource subsystems), so any state a fresh spawn would not have must be
+ * reset here.
+ */
+class PLUGIN_DEVELOPMENT_API ISpawnPoolable
+{
+	GENERATED_BODY()
+
+public:
+	/** Called after the actor is taken from the pool and moved to its spawn transform, or the nearest free spot */
+	UFUNCTION(BlueprintNativeEvent, Category="Spawn System")
+	void OnSpawnedFromPool();
+
+	/** Called before the actor is deactivated and put back into the pool */
+	UFUNCTION(BlueprintNativeEvent, Category="Spawn System")
+	void OnReturnedToPool();
+};
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "SpawnSettings.generated.h"
+
+UCLASS(config=Game, defaultconfig, meta=(DisplayName="Spawn System Settings"))
+class PLUGIN_DEVELOPMENT_API USpawnSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	// Folder containing spawn wave definitions: DataTables of FSpawnWaveEntry rows, USpawnWaveDataAssets or JSON files.
+	// For assets this should be a "/Game/..." path. JSON files are loaded from the corresponding directory on disk.
+	UPROPERTY(EditAnywhere, config, Category="Waves")
+	FString WaveDataFolderPath = TEXT("/Game/Data/Waves");
+
+	// Milliseconds per frame spent spawning or reactivating queued actors. At least one actor is spawned per frame.
+	UPROPERTY(EditAnywhere, config, Category="Spawning", meta=(ClampMin="0.1"))
+	float SpawnBudgetMs = 1.f;
+
+	// Released actors kept per class for reuse. Actors released beyond this are destroyed.
+	UPROPERTY(EditAnywhere, config, Category="Pooling", meta=(ClampMin="0"))
+	int32 MaxPooledActorsPerClass = 256;
+};
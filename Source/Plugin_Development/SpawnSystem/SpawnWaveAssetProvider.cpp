@@ -0,0 +1,27 @@
+#include "SpawnWaveAssetProvider.h"
+#include "SpawnWaveDataAsset.h"
+#include "SpawnerManagementSubsystem.h"
+
+void USpawnWaveAssetProvider::InitializeData(TMap<FName, TArray<FSpawnWaveEntry>>& OutWaves)
+{
+    int32 LoadedAssets = 0;
+    for (const FAssetData& AssetData : DetectedAssets)
+    {
+        const USpawnWaveDataAsset* Asset = Cast<USpawnWaveDataAsset>(AssetData.GetAsset());
+        if (!Asset)
+        {
+            UE_LOG(LogSpawnSystem, Warning, TEXT("[WAVEASSET_ERR_01] Failed to load SpawnWaveDataAsset '%s'"), *AssetData.GetObjectPathString());
+            continue;
+        }
+        ++LoadedAssets;
+
+        // Fallback to asset name if no WaveId is set
+        const FName WaveId = !Asset->WaveId.IsNone() ? Asset->WaveId : AssetData.AssetName;
+        if (OutWaves.Contains(WaveId))
+        {
+            UE_LOG(LogSpawnSystem, Warning, TEXT("[WAVECATALOG_WARN_01] Duplicate wave '%s' found in asset '%s'. Overriding previous data."), *WaveId.ToString(), *AssetData.AssetName.ToString());
+        }
+        OutWaves.Add(WaveId, Asset->Entries);
+    }
+    UE_LOG(LogSpawnSystem, Log, TEXT("[WAVEASSET_INFO_01] Loaded %d wave asset(s)"), LoadedAssets);
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpawnWaveDataProvider.h"
+#include "SpawnWaveAssetProvider.generated.h"
+
+UCLASS()
+class PLUGIN_DEVELOPMENT_API USpawnWaveAssetProvider : public USpawnWaveDataProvider
+{
+    GENERATED_BODY()
+
+public:
+    virtual void InitializeData(TMap<FName, TArray<FSpawnWaveEntry>>& OutWaves) override;
+};
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "SpawnWaveContainers.generated.h"
+
+/** One group of actors spawned at a point of a wave. Rows of a wave DataTable. */
+USTRUCT(BlueprintType)
+struct PLUGIN_DEVELOPMENT_API FSpawnWaveEntry : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	/** Seconds after the wave starts */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawn Wave", meta=(ClampMin="0"))
+	float Time = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawn Wave")
+	TSoftClassPtr<AActor> ActorClass;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawn Wave", meta=(ClampMin="1"))
+	int32 Count = 1;
+
+	/** Spawners with this ASpawner::SpawnerTag share the actors. None uses every spawner. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawn Wave")
+	FName SpawnerTag;
+
+	/** Upgrade level the spawned actors' upgradable components are set to, -1 keeps their own InitialLevel */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawn Wave", meta=(ClampMin="-1"))
+	int32 InitialUpgradeLevel = INDEX_NONE;
+};
+
+/**
+ * A wave compiled for playback, entries sorted by time with one array per field so the scheduler only walks Times.
+ * Classes and spawner tags are indices into the tables of USpawnerManagementSubsystem.
+ */
+struct FSpawnWaveTimeline
+{
+	TArray<float> Times;
+	TArray<uint16> ClassIndices;
+	TArray<uint16> SpawnerTagIndices;
+	TArray<int32> Counts;
+	TArray<int32> InitialUpgradeLevels;
+
+	int32 Num() const { return Times.Num(); }
+};
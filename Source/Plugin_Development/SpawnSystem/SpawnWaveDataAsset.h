@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "SpawnWaveContainers.h"
+#include "SpawnWaveDataAsset.generated.h"
+
+UCLASS()
+class PLUGIN_DEVELOPMENT_API USpawnWaveDataAsset : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// Wave ID used to start the wave (if None, will use asset name)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawn Wave")
+	FName WaveId = NAME_None;
+
+	// In any order, entries are sorted by time when the wave is compiled
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawn Wave")
+	TArray<FSpawnWaveEntry> Entries;
+};
@@ -0,0 +1,89 @@
+#include "SpawnWaveDataProvider.h"
+#include "SpawnWaveAssetProvider.h"
+#include "SpawnWaveDataAsset.h"
+#include "SpawnWaveJsonProvider.h"
+#include "SpawnWaveTableProvider.h"
+#include "SpawnerManagementSubsystem.h"
+#include "Engine/DataTable.h"
+#include "Misc/Paths.h"
+#include "../UpgradableManagementSystem/MightyraiderFunctionLibrary.h"
+
+TArray<USpawnWaveDataProvider*> USpawnWaveDataProvider::Scan(const FString& FolderPath)
+{
+    TArray<USpawnWaveDataProvider*> Providers;
+
+    FString AssetPath = FolderPath;
+    if (!AssetPath.StartsWith(TEXT("/Game")))
+    {
+        AssetPath = FPaths::Combine(TEXT("/Game"), AssetPath);
+    }
+
+    UE_LOG(LogSpawnSystem, Log, TEXT("[WAVEDATA_INFO_01] Scanning folder '%s' for spawn waves"), *AssetPath);
+
+    ScanForAssets(AssetPath, Providers);
+    ScanForFiles(AssetPath, Providers);
+
+    UE_LOG(LogSpawnSystem, Log, TEXT("[WAVEDATA_INFO_02] Found %d wave providers"), Providers.Num());
+    return Providers;
+}
+
+void USpawnWaveDataProvider::ScanForAssets(const FString& FolderPath, TArray<USpawnWaveDataProvider*>& Providers)
+{
+    // Map asset class path to provider class for easy extension
+    const TMap<FTopLevelAssetPath, TSubclassOf<USpawnWaveDataProvider>> ClassToProvider = {
+        {UDataTable::StaticClass()->GetClassPathName(), USpawnWaveTableProvider::StaticClass()},
+        {USpawnWaveDataAsset::StaticClass()->GetClassPathName(), USpawnWaveAssetProvider::StaticClass()}
+    };
+
+    TArray<FAssetData> AssetsInFolder = UMightyraiderFunctionLibrary::GetAssetsInFolder(FolderPath);
+    // Temporary storage of assets grouped by provider class
+    TMap<TSubclassOf<USpawnWaveDataProvider>, TArray<FAssetData>> ProviderAssets;
+    for (const FAssetData& AssetData : AssetsInFolder)
+    {
+        if (const TSubclassOf<USpawnWaveDataProvider>* ProviderClass = ClassToProvider.Find(AssetData.AssetClassPath))
+        {
+            ProviderAssets.FindOrAdd(*ProviderClass).Add(AssetData);
+        }
+    }
+
+    // Instantiate providers and assign detected assets
+    for (const auto& Pair : ProviderAssets)
+    {
+        if (!Pair.Key) continue;
+        USpawnWaveDataProvider* Provider = NewObject<USpawnWaveDataProvider>(this, *Pair.Key);
+        Provider->DetectedAssets = Pair.Value;
+        Providers.Add(Provider);
+        UE_LOG(LogSpawnSystem, Verbose, TEXT("[WAVEDATA_INFO_03] Created provider %s with %d asset(s)"), *Pair.Key->GetName(), Pair.Value.Num());
+    }
+}
+
+void USpawnWaveDataProvider::ScanForFiles(const FString& FolderPath, TArray<USpawnWaveDataProvider*>& Providers)
+{
+    // Map file extension to provider class for easy extension
+    const TMap<FString, TSubclassOf<USpawnWaveDataProvider>> ExtensionToProvider = {
+        {TEXT("json"), USpawnWaveJsonProvider::StaticClass()}
+    };
+
+    // Temporary storage of files grouped by provider class
+    TMap<TSubclassOf<USpawnWaveDataProvider>, TArray<FString>> ProviderFiles;
+    for (const auto& Pair : ExtensionToProvider)
+    {
+        if (!Pair.Value) continue;
+
+        TArray<FString> FoundFiles = UMightyraiderFunctionLibrary::GetFilesInFolder(FolderPath, *Pair.Key);
+        if (FoundFiles.Num() > 0)
+        {
+            ProviderFiles.FindOrAdd(Pair.Value).Append(FoundFiles);
+        }
+    }
+
+    // Instantiate providers and assign detected files
+    for (const auto& Pair : ProviderFiles)
+    {
+        if (!Pair.Key) continue;
+        USpawnWaveDataProvider* Provider = NewObject<USpawnWaveDataProvider>(this, *Pair.Key);
+        Provider->DetectedFiles = Pair.Value;
+        Providers.Add(Provider);
+        UE_LOG(LogSpawnSystem, Verbose, TEXT("[WAVEDATA_INFO_04] Created provider %s with %d file(s)"), *Pair.Key->GetName(), Pair.Value.Num());
+    }
+}
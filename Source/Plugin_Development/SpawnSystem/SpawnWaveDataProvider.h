@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetRegistry/AssetData.h"
+#include "SpawnWaveContainers.h"
+#include "SpawnWaveDataProvider.generated.h"
+
+/** Reads spawn wave definitions. Discovered and instantiated the same way as UUpgradeDataProvider. */
+UCLASS(Abstract)
+class PLUGIN_DEVELOPMENT_API USpawnWaveDataProvider : public UObject
+{
+    GENERATED_BODY()
+
+public:
+    /**
+     * Scans FolderPath once and creates provider instances for each supported
+     * data type found, selected via a class-to-provider mapping.
+     * The returned providers are ready for InitializeData().
+     */
+    virtual TArray<USpawnWaveDataProvider*> Scan(const FString& FolderPath);
+
+    // Currently supported Data Tables and Data Assets
+    virtual void ScanForAssets(const FString& FolderPath, TArray<USpawnWaveDataProvider*>& Providers);
+    // Currently supported files (e.g. JSON). Extend ExtensionToProvider map in ScanForFiles to support more types.
+    virtual void ScanForFiles(const FString& FolderPath, TArray<USpawnWaveDataProvider*>& Providers);
+
+    /**
+     * Reads the waves of any assets/files gathered by Scan().
+     *
+     * @param OutWaves Entries of every wave by wave ID, unsorted.
+     */
+    virtual void InitializeData(TMap<FName, TArray<FSpawnWaveEntry>>& OutWaves) PURE_VIRTUAL(USpawnWaveDataProvider::InitializeData, );
+
+protected:
+    /** Assets discovered during Scan() */
+    UPROPERTY()
+    TArray<FAssetData> DetectedAssets;
+
+    /** File paths discovered during Scan() */
+    UPROPERTY()
+    TArray<FString> DetectedFiles;
+};
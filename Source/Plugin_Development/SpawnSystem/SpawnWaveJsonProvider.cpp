@@ -0,0 +1,81 @@
+#include "SpawnWaveJsonProvider.h"
+#include "SpawnerManagementSubsystem.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+/*
+ * {
+ *   "WaveId": "Wave1",
+ *   "Entries": [
+ *     { "Time": 0, "ActorClass": "/Game/Enemies/BP_Grunt.BP_Grunt_C", "Count": 10, "SpawnerTag": "North", "InitialUpgradeLevel": 2 }
+ *   ]
+ * }
+ */
+void USpawnWaveJsonProvider::InitializeData(TMap<FName, TArray<FSpawnWaveEntry>>& OutWaves)
+{
+    int32 LoadedFiles = 0;
+    for (const FString& File : DetectedFiles)
+    {
+        FString JsonString;
+        if (!FFileHelper::LoadFileToString(JsonString, *File))
+        {
+            UE_LOG(LogSpawnSystem, Warning, TEXT("[WAVEJSON_ERR_01] Failed to read JSON file: %s"), *File);
+            continue;
+        }
+
+        TSharedPtr<FJsonObject> Root;
+        TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+        if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid())
+        {
+            UE_LOG(LogSpawnSystem, Warning, TEXT("[WAVEJSON_ERR_02] Invalid JSON in file: %s"), *File);
+            continue;
+        }
+
+        const TArray<TSharedPtr<FJsonValue>>* EntryValues;
+        if (!Root->TryGetArrayField(TEXT("Entries"), EntryValues))
+        {
+            // Upgrade definitions may share the folder, files without entries are not waves
+            continue;
+        }
+        ++LoadedFiles;
+
+        // Fallback to file name if no WaveId is set
+        FString WaveIdString;
+        const FName WaveId = Root->TryGetStringField(TEXT("WaveId"), WaveIdString) && !WaveIdString.IsEmpty()
+            ? FName(*WaveIdString) : FName(*FPaths::GetBaseFilename(File));
+        if (OutWaves.Contains(WaveId))
+        {
+            UE_LOG(LogSpawnSystem, Warning, TEXT("[WAVECATALOG_WARN_01] Duplicate wave '%s' found in file '%s'. Overriding previous data."), *WaveId.ToString(), *File);
+        }
+
+        TArray<FSpawnWaveEntry>& Entries = OutWaves.FindOrAdd(WaveId);
+        Entries.Reset(EntryValues->Num());
+        for (const TSharedPtr<FJsonValue>& EntryValue : *EntryValues)
+        {
+            const TSharedPtr<FJsonObject>* EntryObj;
+            if (!EntryValue->TryGetObject(EntryObj))
+            {
+                UE_LOG(LogSpawnSystem, Warning, TEXT("[WAVEJSON_ERR_03] Failed to parse entry object in file '%s'"), *File);
+                continue;
+            }
+
+            FSpawnWaveEntry& Entry = Entries.AddDefaulted_GetRef();
+            (*EntryObj)->TryGetNumberField(TEXT("Time"), Entry.Time);
+            (*EntryObj)->TryGetNumberField(TEXT("Count"), Entry.Count);
+            (*EntryObj)->TryGetNumberField(TEXT("InitialUpgradeLevel"), Entry.InitialUpgradeLevel);
+            FString ClassPath;
+            if ((*EntryObj)->TryGetStringField(TEXT("ActorClass"), ClassPath))
+            {
+                Entry.ActorClass = TSoftClassPtr<AActor>(FSoftObjectPath(ClassPath));
+            }
+            FString SpawnerTag;
+            if ((*EntryObj)->TryGetStringField(TEXT("SpawnerTag"), SpawnerTag))
+            {
+                Entry.SpawnerTag = FName(*SpawnerTag);
+            }
+        }
+    }
+    UE_LOG(LogSpawnSystem, Log, TEXT("[WAVEJSON_INFO_01] Loaded %d wave file(s)"), LoadedFiles);
+}
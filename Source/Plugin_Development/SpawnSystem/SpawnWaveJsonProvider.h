@@ -0,0 +1,14 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpawnWaveDataProvider.h"
+#include "SpawnWaveJsonProvider.generated.h"
+
+UCLASS()
+class PLUGIN_DEVELOPMENT_API USpawnWaveJsonProvider : public USpawnWaveDataProvider
+{
+    GENERATED_BODY()
+
+public:
+    virtual void InitializeData(TMap<FName, TArray<FSpawnWaveEntry>>& OutWaves) override;
+};
@@ -0,0 +1,30 @@
+#include "SpawnWaveTableProvider.h"
+#include "SpawnerManagementSubsystem.h"
+#include "Engine/DataTable.h"
+
+void USpawnWaveTableProvider::InitializeData(TMap<FName, TArray<FSpawnWaveEntry>>& OutWaves)
+{
+    int32 LoadedTables = 0;
+    for (const FAssetData& AssetData : DetectedAssets)
+    {
+        UDataTable* Table = Cast<UDataTable>(AssetData.GetAsset());
+        // Tables of other row types in the folder are not waves
+        if (!Table || Table->GetRowStruct() != FSpawnWaveEntry::StaticStruct()) continue;
+        ++LoadedTables;
+
+        // The table's name is the wave ID
+        const FName WaveId = AssetData.AssetName;
+        if (OutWaves.Contains(WaveId))
+        {
+            UE_LOG(LogSpawnSystem, Warning, TEXT("[WAVECATALOG_WARN_01] Duplicate wave '%s' found in DataTable '%s'. Overriding previous data."), *WaveId.ToString(), *Table->GetName());
+        }
+
+        TArray<FSpawnWaveEntry>& Entries = OutWaves.FindOrAdd(WaveId);
+        Entries.Reset();
+        for (const auto& Pair : Table->GetRowMap())
+        {
+            Entries.Add(*reinterpret_cast<const FSpawnWaveEntry*>(Pair.Value));
+        }
+    }
+    UE_LOG(LogSpawnSystem, Log, TEXT("[WAVETABLE_INFO_01] Loaded %d wave DataTable(s)"), LoadedTables);
+}
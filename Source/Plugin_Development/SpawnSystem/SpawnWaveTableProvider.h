@@ -0,0 +1,14 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpawnWaveDataProvider.h"
+#include "SpawnWaveTableProvider.generated.h"
+
+UCLASS()
+class PLUGIN_DEVELOPMENT_API USpawnWaveTableProvider : public USpawnWaveDataProvider
+{
+    GENERATED_BODY()
+
+public:
+    virtual void InitializeData(TMap<FName, TArray<FSpawnWaveEntry>>& OutWaves) override;
+};
@@ -2,13 +2,15 @@
 
 
 #include "Spawner.h"
+#include "SpawnerManagementSubsystem.h"
+#include "Engine/World.h"
 
 
 // Sets default values
 ASpawner::ASpawner()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Spawning is driven by BeginPlay, the spawn subsystem's scheduler or SpawnBatch, never by Tick
+	PrimaryActorTick.bCanEverTick = false;
 	SpawningBox = CreateDefaultSubobject<UBoxComponent>(FName("Spawning Box"));
 	SetRootComponent(SpawningBox);
 }
@@ -17,7 +19,204 @@ ASpawner::ASpawner()
 void ASpawner::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	if (!HasAuthority()) return;
+
+	if (USpawnerManagementSubsystem* Subsystem = GetWorld()->GetSubsystem<USpawnerManagementSubsystem>())
+	{
+		Subsystem->RegisterSpawner(this);
+	}
+	if (!bSpawnOnBeginPlay) return;
+
+	if (SpawnInterval > 0.f)
+	{
+		StartSpawning();
+	}
+	else
+	{
+		SpawnBatch(SpawnCount);
+	}
+}
+
+void ASpawner::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USpawnerManagementSubsystem* Subsystem = GetWorld()->GetSubsystem<USpawnerManagementSubsystem>())
+	{
+		Subsystem->UnregisterSpawner(this);
+		Subsystem->CancelSpawns(this);
+	}
+	QueuedCount = 0;
+	AwaitingSpawns.Reset();
+	AwaitingPlacementCount = 0;
+	InvalidatePointCache();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASpawner::SpawnBatch(int32 Count)
+{
+	QueueSpawns(SpawnClass, Count);
+}
+
+void ASpawner::QueueSpawns(TSubclassOf<AActor> ActorClass, int32 Count, int32 InitialUpgradeLevel)
+{
+	if (!ActorClass || !GetWorld()->GetSubsystem<USpawnerManagementSubsystem>()) return;
+
+	if (MaxAlive > 0)
+	{
+		Count = FMath::Min(Count, MaxAlive - AliveCount - QueuedCount - AwaitingPlacementCount);
+	}
+	if (Count <= 0) return;
+
+	if (!CachedBoxTransform.Equals(SpawningBox->GetComponentTransform()))
+	{
+		InvalidatePointCache();
+	}
+
+	AwaitingSpawns.Add({ ActorClass, Count, InitialUpgradeLevel });
+	AwaitingPlacementCount += Count;
+	// Queries in flight commit everything awaiting once they are done
+	if (OutstandingQueries > 0) return;
+
+	const int32 MissingPoints = FMath::Min(AwaitingPlacementCount, MaxCachedPoints) - ValidatedPoints.Num();
+	if (MissingPoints > 0)
+	{
+		RequestCandidates(FMath::Min(MissingPoints * CandidateOversample, MaxCachedPoints - ValidatedPoints.Num()));
+	}
+	else
+	{
+		CommitAwaitingSpawns();
+	}
+}
+
+void ASpawner::RequestCandidates(int32 Count)
+{
+	TArray<FVector> Candidates;
+	GenerateStratifiedPoints(Count, Candidates);
+
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(ClearanceRadius);
+	const FCollisionQueryParams Params(SCENE_QUERY_STAT(SpawnerPlacement), /*bTraceComplex=*/false, this);
+	const FOverlapDelegate Delegate = FOverlapDelegate::CreateUObject(this, &ASpawner::OnPlacementOverlapDone, PlacementGeneration);
+	for (const FVector& Candidate : Candidates)
+	{
+		GetWorld()->AsyncOverlapByChannel(Candidate, FQuat::Identity, PlacementChannel, Shape, Params, FCollisionResponseParams::DefaultResponseParam, &Delegate);
+	}
+	OutstandingQueries += Candidates.Num();
+}
+
+void ASpawner::OnPlacementOverlapDone(const FTraceHandle& Handle, FOverlapDatum& Datum, uint32 Generation)
+{
+	if (Generation != PlacementGeneration) return;
+
+	const bool bBlocked = Datum.OutOverlaps.ContainsByPredicate([](const FOverlapResult& Overlap) { return Overlap.bBlockingHit; });
+	if (!bBlocked && ValidatedPoints.Num() < MaxCachedPoints)
+	{
+		ValidatedPoints.Add(Datum.Pos);
+	}
+
+	if (--OutstandingQueries == 0)
+	{
+		CommitAwaitingSpawns();
+	}
 }
 
+void ASpawner::CommitAwaitingSpawns()
+{
+	USpawnerManagementSubsystem* Subsystem = GetWorld()->GetSubsystem<USpawnerManagementSubsystem>();
+	if (!Subsystem || AwaitingPlacementCount == 0) return;
+
+	if (ValidatedPoints.IsEmpty())
+	{
+		UE_LOG(LogSpawnSystem, Warning, TEXT("[SPAWNER_ERR_01] %s found no free spawn point, %d spawns dropped"), *GetName(), AwaitingPlacementCount);
+		AwaitingSpawns.Reset();
+		AwaitingPlacementCount = 0;
+		return;
+	}
 
+	// Batches larger than the cache and later batches reuse points that may still be occupied. The subsystem moves
+	// spawned and reactivated actors off anything their collision blocks, actors that do not block each other may overlap.
+	for (const FAwaitingSpawn& Awaiting : AwaitingSpawns)
+	{
+		for (int32 i = 0; i < Awaiting.Count; ++i)
+		{
+			Subsystem->RequestSpawn(Awaiting.ActorClass, FTransform(GetActorRotation(), ValidatedPoints[NextCachedPoint]), this, Awaiting.InitialUpgradeLevel);
+			NextCachedPoint = (NextCachedPoint + 1) % ValidatedPoints.Num();
+		}
+	}
+	QueuedCount += AwaitingPlacementCount;
+	AwaitingSpawns.Reset();
+	AwaitingPlacementCount = 0;
+}
+
+void ASpawner::InvalidatePointCache()
+{
+	ValidatedPoints.Reset();
+	NextCachedPoint = 0;
+	OutstandingQueries = 0;
+	++PlacementGeneration;
+	CachedBoxTransform = SpawningBox->GetComponentTransform();
+}
+
+void ASpawner::StartSpawning()
+{
+	if (USpawnerManagementSubsystem* Subsystem = GetWorld()->GetSubsystem<USpawnerManagementSubsystem>())
+	{
+		Subsystem->ScheduleSpawner(this, SpawnInterval);
+	}
+}
+
+void ASpawner::StopSpawning()
+{
+	if (USpawnerManagementSubsystem* Subsystem = GetWorld()->GetSubsystem<USpawnerManagementSubsystem>())
+	{
+		Subsystem->UnscheduleSpawner(this);
+	}
+}
+
+void ASpawner::HandleSpawnFinished(AActor* SpawnedActor)
+{
+	QueuedCount = FMath::Max(QueuedCount - 1, 0);
+	if (!SpawnedActor) return;
+
+	++AliveCount;
+	OnActorSpawned.Broadcast(SpawnedActor);
+}
+
+void ASpawner::HandleActorReleased(AActor* Actor)
+{
+	AliveCount = FMath::Max(AliveCount - 1, 0);
+}
+
+void ASpawner::GenerateStratifiedPoints(int32 Count, TArray<FVector>& OutPoints) const
+{
+	if (Count <= 0) return;
+
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count)));
+	TArray<int32> Cells;
+	Cells.SetNumUninitialized(GridSize * GridSize);
+	for (int32 i = 0; i < Cells.Num(); ++i)
+	{
+		Cells[i] = i;
+	}
+	// Partial shuffle, only the first Count cells are used
+	for (int32 i = 0; i < Count; ++i)
+	{
+		Cells.Swap(i, FMath::RandRange(i, Cells.Num() - 1));
+	}
+
+	// Local space, the component transform applies rotation and scale
+	const FVector Extent = SpawningBox->GetUnscaledBoxExtent();
+	const FTransform& BoxTransform = SpawningBox->GetComponentTransform();
+	const FVector2D CellSize(2.0 * Extent.X / GridSize, 2.0 * Extent.Y / GridSize);
+	OutPoints.Reserve(OutPoints.Num() + Count);
+	for (int32 i = 0; i < Count; ++i)
+	{
+		const int32 CellX = Cells[i] % GridSize;
+		const int32 CellY = Cells[i] / GridSize;
+		const FVector LocalPoint(
+			-Extent.X + (CellX + FMath::FRand()) * CellSize.X,
+			-Extent.Y + (CellY + FMath::FRand()) * CellSize.Y,
+			FMath::FRandRange(-Extent.Z, Extent.Z));
+		OutPoints.Add(BoxTransform.TransformPosition(LocalPoint));
+	}
+}
@@ -5,8 +5,20 @@
 #include "CoreMinimal.h"
 #include "Components/BoxComponent.h"
 #include "GameFramework/Actor.h"
+#include "WorldCollision.h"
 #include "Spawner.generated.h"
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnSpawnerActorSpawnedDelegate, AActor*, SpawnedActor);
+
+/**
+ * Spawns SpawnClass inside its box through USpawnerManagementSubsystem, on the server only.
+ * Does not tick: batches are triggered by BeginPlay, the spawn subsystem's scheduler every SpawnInterval, spawn wave
+ * entries for its SpawnerTag, or SpawnBatch.
+ *
+ * Spawn points are stratified over the box, one jittered point per grid cell, and validated with asynchronous overlap
+ * queries. A batch that needs new points is therefore spawned in the frame after it was requested. Validated points are
+ * cached and reused by later batches until the box moves.
+ */
 UCLASS()
 class PLUGIN_DEVELOPMENT_API ASpawner : public AActor
 {
@@ -16,9 +28,119 @@ public:
 	// Sets default values for this actor's properties
 	ASpawner();
 
+	/** Queues up to Count actors of SpawnClass, fewer if MaxAlive would be exceeded */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Spawner")
+	void SpawnBatch(int32 Count);
+
+	/**
+	 * Queues up to Count actors of ActorClass, fewer if MaxAlive would be exceeded.
+	 * An InitialUpgradeLevel other than -1 is set on their upgradable components.
+	 */
+	void QueueSpawns(TSubclassOf<AActor> ActorClass, int32 Count, int32 InitialUpgradeLevel = INDEX_NONE);
+
+	/** Spawns SpawnCount actors every SpawnInterval seconds until stopped */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Spawner")
+	void StartSpawning();
+
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Spawner")
+	void StopSpawning();
+
+	/** Actors spawned by this spawner that are neither released nor destroyed */
+	UFUNCTION(BlueprintPure, Category = "Spawner")
+	int32 GetAliveCount() const { return AliveCount; }
+
+	int32 GetSpawnCount() const { return SpawnCount; }
+
+	FName GetSpawnerTag() const { return SpawnerTag; }
+
+	/** Called by the spawn subsystem once a queued actor is spawned, with null if spawning failed */
+	void HandleSpawnFinished(AActor* SpawnedActor);
+
+	/** Called by the spawn subsystem when one of this spawner's actors is released or destroyed */
+	void HandleActorReleased(AActor* Actor);
+
+	UPROPERTY(BlueprintAssignable, Category = "Spawner")
+	FOnSpawnerActorSpawnedDelegate OnActorSpawned;
+
+	/** Count points spread over the box, one jittered point in each of Count randomly chosen cells of a square grid */
+	void GenerateStratifiedPoints(int32 Count, TArray<FVector>& OutPoints) const;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(VisibleAnywhere, Category = "Spawner")
+	TObjectPtr<UBoxComponent> SpawningBox = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawner")
+	TSubclassOf<AActor> SpawnClass;
+
+	/** Spawn wave entries with this tag spawn from this spawner. Not changeable at runtime. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawner")
+	FName SpawnerTag;
+
+	/** Actors per batch */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawner", meta=(ClampMin="1"))
+	int32 SpawnCount = 1;
+
+	/** Seconds between batches once spawning is started. 0 spawns a single batch. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawner", meta=(ClampMin="0"))
+	float SpawnInterval = 0.f;
+
+	/** Upper limit of alive and queued actors, 0 for no limit */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawner", meta=(ClampMin="0"))
+	int32 MaxAlive = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawner")
+	bool bSpawnOnBeginPlay = true;
+
+	/** Radius around a spawn point that must be free of blocking geometry */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawner|Placement", meta=(ClampMin="0"))
+	float ClearanceRadius = 50.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawner|Placement")
+	TEnumAsByte<ECollisionChannel> PlacementChannel = ECC_Pawn;
+
+	/** Candidates tested per missing point, to make up for candidates that are blocked */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawner|Placement", meta=(ClampMin="1"))
+	int32 CandidateOversample = 2;
+
+	/** Validated points kept for reuse. Once full, batches cycle through the cached points without new queries. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawner|Placement", meta=(ClampMin="1"))
+	int32 MaxCachedPoints = 128;
+
+private:
+	int32 AliveCount = 0;
+	int32 QueuedCount = 0;
+
+	struct FAwaitingSpawn
+	{
+		TSubclassOf<AActor> ActorClass;
+		int32 Count = 0;
+		int32 InitialUpgradeLevel = INDEX_NONE;
+	};
+
+	/** Actors requested but waiting for their spawn points to be validated, and their total */
+	TArray<FAwaitingSpawn> AwaitingSpawns;
+	int32 AwaitingPlacementCount = 0;
+
+	TArray<FVector> ValidatedPoints;
+	int32 NextCachedPoint = 0;
+
+	/** Box transform the cached points were generated for */
+	FTransform CachedBoxTransform;
+
+	int32 OutstandingQueries = 0;
+
+	/** Incremented whenever the cache is dropped, so results of older queries are ignored */
+	uint32 PlacementGeneration = 0;
+
+	void RequestCandidates(int32 Count);
+	void OnPlacementOverlapDone(const FTraceHandle& Handle, FOverlapDatum& Datum, uint32 Generation);
+
+	/** Requests the awaiting actors from the subsystem at cached points */
+	void CommitAwaitingSpawns();
 
-	UBoxComponent* SpawningBox = nullptr;
+	void InvalidatePointCache();
 };
@@ -2,6 +2,20 @@
 
 
 #include "SpawnerManagementSubsystem.h"
+#include "Spawner.h"
+#include "SpawnPoolable.h"
+#include "SpawnSettings.h"
+#include "SpawnWaveDataProvider.h"
+#include "../UpgradableManagementSystem/UpgradableComponent.h"
+#include "../UpgradableManagementSystem/UpgradeManagerSubsystem.h"
+#include "../ResourceManagementSystem/ResourceManagerSubsystem.h"
+#include "../ResourceManagementSystem/ResourceSystemComponent.h"
+#include "Algo/StableSort.h"
+#include "Algo/BinarySearch.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+
+DEFINE_LOG_CATEGORY(LogSpawnSystem);
 
 USpawnerManagementSubsystem::USpawnerManagementSubsystem()
 {
@@ -14,10 +28,451 @@ void USpawnerManagementSubsystem::Initialize(FSubsystemCollectionBase& Collectio
 
 void USpawnerManagementSubsystem::Deinitialize()
 {
+	PendingSpawns.Empty();
+	NextPendingSpawn = 0;
+	Pools.Empty();
+	ActiveActors.Empty();
+	RunningWaves.Empty();
+	ScheduledSpawners.Empty();
+	SpawnersByTag.Empty();
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(SchedulerTimer);
+	}
 	Super::Deinitialize();
 }
 
 void USpawnerManagementSubsystem::OnWorldBeginPlay(UWorld& InWorld)
 {
 	Super::OnWorldBeginPlay(InWorld);
+	if (InWorld.GetNetMode() != NM_Client)
+	{
+		LoadWaves();
+	}
+}
+
+void USpawnerManagementSubsystem::LoadWaves()
+{
+	// The provider base is abstract, its default object does the scanning
+	USpawnWaveDataProvider* Scanner = GetMutableDefault<USpawnWaveDataProvider>();
+	TMap<FName, TArray<FSpawnWaveEntry>> Waves;
+	for (USpawnWaveDataProvider* Provider : Scanner->Scan(GetDefault<USpawnSettings>()->WaveDataFolderPath))
+	{
+		if (Provider)
+		{
+			Provider->InitializeData(Waves);
+		}
+	}
+
+	for (TPair<FName, TArray<FSpawnWaveEntry>>& Wave : Waves)
+	{
+		Algo::StableSortBy(Wave.Value, &FSpawnWaveEntry::Time);
+
+		FSpawnWaveTimeline& Timeline = WaveTimelines.FindOrAdd(Wave.Key);
+		for (const FSpawnWaveEntry& Entry : Wave.Value)
+		{
+			// Waves are compiled once at begin play, loading the classes here keeps spawning free of loads
+			UClass* ActorClass = Entry.ActorClass.LoadSynchronous();
+			if (!ActorClass || Entry.Count <= 0)
+			{
+				UE_LOG(LogSpawnSystem, Warning, TEXT("[SPAWNMGR_ERR_04] Skipping entry at %.2fs of wave '%s': class '%s' could not be loaded or count is %d"),
+					Entry.Time, *Wave.Key.ToString(), *Entry.ActorClass.ToString(), Entry.Count);
+				continue;
+			}
+
+			const int32 ClassIndex = WaveClasses.AddUnique(ActorClass);
+			const int32 TagIndex = WaveSpawnerTags.AddUnique(Entry.SpawnerTag);
+			if (ClassIndex > MAX_uint16 || TagIndex > MAX_uint16)
+			{
+				UE_LOG(LogSpawnSystem, Error, TEXT("[SPAWNMGR_ERR_05] Too many distinct classes or spawner tags in waves, skipping the rest of wave '%s'"), *Wave.Key.ToString());
+				break;
+			}
+			Timeline.Times.Add(Entry.Time);
+			Timeline.ClassIndices.Add(static_cast<uint16>(ClassIndex));
+			Timeline.SpawnerTagIndices.Add(static_cast<uint16>(TagIndex));
+			Timeline.Counts.Add(Entry.Count);
+			Timeline.InitialUpgradeLevels.Add(Entry.InitialUpgradeLevel);
+		}
+	}
+	UE_LOG(LogSpawnSystem, Log, TEXT("[SPAWNMGR_INFO_01] Compiled %d spawn wave(s) using %d actor class(es)"), WaveTimelines.Num(), WaveClasses.Num());
+}
+
+void USpawnerManagementSubsystem::RequestSpawn(TSubclassOf<AActor> ActorClass, const FTransform& Transform, ASpawner* Spawner, int32 InitialUpgradeLevel)
+{
+	if (!ActorClass)
+	{
+		UE_LOG(LogSpawnSystem, Warning, TEXT("[SPAWNMGR_ERR_01] Spawn requested without an actor class"));
+		return;
+	}
+	PendingSpawns.Add({ ActorClass, Transform, Spawner, InitialUpgradeLevel });
+}
+
+void USpawnerManagementSubsystem::CancelSpawns(const ASpawner* Spawner)
+{
+	for (int32 i = NextPendingSpawn; i < PendingSpawns.Num(); ++i)
+	{
+		if (PendingSpawns[i].Spawner == Spawner)
+		{
+			// Skipped by Tick, removing would shift the queue
+			PendingSpawns[i].ActorClass = nullptr;
+		}
+	}
+}
+
+void USpawnerManagementSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Deadline = FPlatformTime::Seconds() + GetDefault<USpawnSettings>()->SpawnBudgetMs / 1000.0;
+	while (NextPendingSpawn < PendingSpawns.Num())
+	{
+		// Copied, spawner callbacks may queue more and grow PendingSpawns
+		const FPendingSpawn Request = PendingSpawns[NextPendingSpawn++];
+		if (!Request.ActorClass) continue;
+
+		AActor* Actor = AcquireActor(Request.ActorClass, Request.Transform);
+		if (Actor)
+		{
+			ActiveActors.Add(Actor, Request.Spawner);
+			ApplyInitialUpgradeLevel(Actor, Request.InitialUpgradeLevel);
+			OnActorSpawned.Broadcast(Actor);
+		}
+		if (ASpawner* Spawner = Request.Spawner.Get())
+		{
+			Spawner->HandleSpawnFinished(Actor);
+		}
+
+		if (FPlatformTime::Seconds() >= Deadline) break;
+	}
+
+	if (NextPendingSpawn >= PendingSpawns.Num())
+	{
+		PendingSpawns.Reset();
+		NextPendingSpawn = 0;
+	}
+}
+
+AActor* USpawnerManagementSubsystem::AcquireActor(UClass* ActorClass, const FTransform& Transform)
+{
+	if (TArray<FPooledActor>* Pool = Pools.Find(ActorClass))
+	{
+		while (Pool->Num() > 0)
+		{
+			const FPooledActor Pooled = Pool->Pop(/*bAllowShrinking=*/false);
+			AActor* Actor = Pooled.Actor.Get();
+			if (!IsValid(Actor)) continue;
+
+			// Same collision handling as a fresh spawn: moved off blocking geometry and other actors if possible, placed anyway
+			Actor->SetActorEnableCollision(true);
+			FVector Location = Transform.GetLocation();
+			const FRotator Rotation = Transform.Rotator();
+			GetWorld()->FindTeleportSpot(Actor, Location, Rotation);
+			Actor->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+			Actor->SetActorHiddenInGame(false);
+			Actor->SetActorTickEnabled(Pooled.bActorTickEnabled);
+			for (const TWeakObjectPtr<UActorComponent>& Component : Pooled.TickingComponents)
+			{
+				if (UActorComponent* TickingComponent = Component.Get())
+				{
+					TickingComponent->SetComponentTickEnabled(true);
+				}
+			}
+			SetUpgradablesPooled(Actor, /*bPooled=*/false);
+			// Starts with empty balances like a fresh spawn, its upgrade levels are reset by ApplyInitialUpgradeLevel.
+			// Only a wallet on the actor itself, FindResourceComponentForActor could return its owner's.
+			UResourceSystemComponent* Wallet = Actor->FindComponentByClass<UResourceSystemComponent>();
+			UResourceManagerSubsystem* ResourceManager = GetWorld()->GetSubsystem<UResourceManagerSubsystem>();
+			if (Wallet && ResourceManager)
+			{
+				ResourceManager->ResetBalances(Wallet);
+			}
+			if (Actor->Implements<USpawnPoolable>())
+			{
+				ISpawnPoolable::Execute_OnSpawnedFromPool(Actor);
+			}
+			++PoolHitCount;
+			return Actor;
+		}
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	AActor* Actor = GetWorld()->SpawnActor<AActor>(ActorClass, Transform, SpawnParams);
+	if (!Actor)
+	{
+		UE_LOG(LogSpawnSystem, Warning, TEXT("[SPAWNMGR_ERR_02] Failed to spawn %s"), *GetNameSafe(ActorClass));
+		return nullptr;
+	}
+	Actor->OnDestroyed.AddDynamic(this, &USpawnerManagementSubsystem::OnManagedActorDestroyed);
+	++PoolMissCount;
+	return Actor;
+}
+
+void USpawnerManagementSubsystem::ApplyInitialUpgradeLevel(AActor* Actor, int32 Level) const
+{
+	UUpgradeManagerSubsystem* UpgradeManager = GetWorld()->GetSubsystem<UUpgradeManagerSubsystem>();
+	if (!UpgradeManager) return;
+
+	// Components registered at BeginPlay with their own InitialLevel, pooled ones still have the level of their last use
+	TInlineComponentArray<UUpgradableComponent*> Upgradables(Actor);
+	for (UUpgradableComponent* Upgradable : Upgradables)
+	{
+		const int32 TargetLevel = Level != INDEX_NONE ? Level : Upgradable->InitialLevel;
+		if (Upgradable->GetComponentId() != INDEX_NONE && Upgradable->GetCurrentUpgradeLevel() != TargetLevel)
+		{
+			UpgradeManager->UpdateUpgradeLevel(Upgradable->GetComponentId(), TargetLevel);
+		}
+	}
+}
+
+void USpawnerManagementSubsystem::SetUpgradablesPooled(AActor* Actor, bool bPooled) const
+{
+	UUpgradeManagerSubsystem* UpgradeManager = GetWorld()->GetSubsystem<UUpgradeManagerSubsystem>();
+
+	TInlineComponentArray<UUpgradableComponent*> Upgradables(Actor);
+	for (UUpgradableComponent* Upgradable : Upgradables)
+	{
+		// A pooled actor must not complete an upgrade, the resources are refunded as for any cancel
+		if (bPooled && UpgradeManager && UpgradeManager->IsUpgradeTimerActive(Upgradable->GetComponentId()))
+		{
+			UpgradeManager->CancelUpgrade(Upgradable->GetComponentId());
+		}
+		Upgradable->SetPooled(bPooled);
+	}
+}
+
+void USpawnerManagementSubsystem::ReleaseActor(AActor* Actor)
+{
+	TWeakObjectPtr<ASpawner> Spawner;
+	if (!IsValid(Actor) || !ActiveActors.RemoveAndCopyValue(Actor, Spawner))
+	{
+		UE_LOG(LogSpawnSystem, Warning, TEXT("[SPAWNMGR_ERR_03] %s was not spawned by the spawn system or is already released"), *GetNameSafe(Actor));
+		return;
+	}
+	if (ASpawner* OwningSpawner = Spawner.Get())
+	{
+		OwningSpawner->HandleActorReleased(Actor);
+	}
+
+	TArray<FPooledActor>& Pool = Pools.FindOrAdd(Actor->GetClass());
+	if (Pool.Num() >= GetDefault<USpawnSettings>()->MaxPooledActorsPerClass)
+	{
+		Actor->Destroy();
+		return;
+	}
+
+	if (Actor->Implements<USpawnPoolable>())
+	{
+		ISpawnPoolable::Execute_OnReturnedToPool(Actor);
+	}
+	SetUpgradablesPooled(Actor, /*bPooled=*/true);
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+
+	FPooledActor& Pooled = Pool.AddDefaulted_GetRef();
+	Pooled.Actor = Actor;
+	Pooled.bActorTickEnabled = Actor->IsActorTickEnabled();
+	Actor->SetActorTickEnabled(false);
+	for (UActorComponent* Component : Actor->GetComponents())
+	{
+		if (Component && Component->IsComponentTickEnabled())
+		{
+			Pooled.TickingComponents.Add(Component);
+			Component->SetComponentTickEnabled(false);
+		}
+	}
+}
+
+void USpawnerManagementSubsystem::OnManagedActorDestroyed(AActor* DestroyedActor)
+{
+	// Destroyed while active, e.g. by gameplay code that does not know about pooling
+	TWeakObjectPtr<ASpawner> Spawner;
+	if (ActiveActors.RemoveAndCopyValue(DestroyedActor, Spawner))
+	{
+		if (ASpawner* OwningSpawner = Spawner.Get())
+		{
+			OwningSpawner->HandleActorReleased(DestroyedActor);
+		}
+	}
+}
+
+int32 USpawnerManagementSubsystem::GetPooledCount(TSubclassOf<AActor> ActorClass) const
+{
+	const TArray<FPooledActor>* Pool = Pools.Find(ActorClass.Get());
+	return Pool ? Pool->Num() : 0;
+}
+
+void USpawnerManagementSubsystem::RegisterSpawner(ASpawner* Spawner)
+{
+	if (!Spawner) return;
+	SpawnersByTag.FindOrAdd(Spawner->GetSpawnerTag()).AddUnique(Spawner);
+}
+
+void USpawnerManagementSubsystem::UnregisterSpawner(ASpawner* Spawner)
+{
+	if (TArray<TWeakObjectPtr<ASpawner>>* Spawners = SpawnersByTag.Find(Spawner->GetSpawnerTag()))
+	{
+		Spawners->Remove(Spawner);
+	}
+	UnscheduleSpawner(Spawner);
+}
+
+void USpawnerManagementSubsystem::ScheduleSpawner(ASpawner* Spawner, float Interval)
+{
+	if (!Spawner || Interval <= 0.f) return;
+
+	UnscheduleSpawner(Spawner);
+	ScheduledSpawners.Add({ Spawner, GetWorld()->GetTimeSeconds(), Interval });
+	RescheduleTimer();
+}
+
+void USpawnerManagementSubsystem::UnscheduleSpawner(const ASpawner* Spawner)
+{
+	ScheduledSpawners.RemoveAllSwap([Spawner](const FScheduledSpawner& Scheduled) { return Scheduled.Spawner == Spawner; });
+}
+
+bool USpawnerManagementSubsystem::StartWave(FName WaveId)
+{
+	if (!WaveTimelines.Contains(WaveId))
+	{
+		UE_LOG(LogSpawnSystem, Warning, TEXT("[SPAWNMGR_ERR_06] No spawn wave '%s'"), *WaveId.ToString());
+		return false;
+	}
+
+	StopWave(WaveId);
+	RunningWaves.Add({ WaveId, GetWorld()->GetTimeSeconds(), 0 });
+	RunScheduler();
+	return true;
+}
+
+void USpawnerManagementSubsystem::StopWave(FName WaveId)
+{
+	RunningWaves.RemoveAllSwap([WaveId](const FRunningWave& Wave) { return Wave.WaveId == WaveId; });
+}
+
+bool USpawnerManagementSubsystem::FastForwardWave(FName WaveId, float WaveTime, bool bSpawnSkippedEntries)
+{
+	FRunningWave* Wave = RunningWaves.FindByPredicate([WaveId](const FRunningWave& Running) { return Running.WaveId == WaveId; });
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (!Wave || WaveTime < Now - Wave->StartTime) return false;
+
+	// Entries up to WaveTime are due, the scheduler runs them unless the ones before WaveTime are dropped here
+	Wave->StartTime = Now - WaveTime;
+	if (!bSpawnSkippedEntries)
+	{
+		const FSpawnWaveTimeline& Timeline = WaveTimelines.FindChecked(WaveId);
+		Wave->NextEntry = FMath::Max(Wave->NextEntry, Algo::LowerBound(Timeline.Times, WaveTime));
+	}
+	RunScheduler();
+	return true;
+}
+
+float USpawnerManagementSubsystem::GetWaveTime(FName WaveId) const
+{
+	const FRunningWave* Wave = RunningWaves.FindByPredicate([WaveId](const FRunningWave& Running) { return Running.WaveId == WaveId; });
+	return Wave ? static_cast<float>(GetWorld()->GetTimeSeconds() - Wave->StartTime) : -1.f;
+}
+
+void USpawnerManagementSubsystem::RunScheduler()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	for (int32 i = RunningWaves.Num() - 1; i >= 0; --i)
+	{
+		FRunningWave& Wave = RunningWaves[i];
+		const FSpawnWaveTimeline& Timeline = WaveTimelines.FindChecked(Wave.WaveId);
+		const float WaveTime = static_cast<float>(Now - Wave.StartTime);
+		while (Wave.NextEntry < Timeline.Num() && Timeline.Times[Wave.NextEntry] <= WaveTime)
+		{
+			ExecuteWaveEntry(Timeline, Wave.NextEntry++);
+		}
+		if (Wave.NextEntry >= Timeline.Num())
+		{
+			UE_LOG(LogSpawnSystem, Log, TEXT("[SPAWNMGR_INFO_02] Spawn wave '%s' finished"), *Wave.WaveId.ToString());
+			RunningWaves.RemoveAtSwap(i);
+		}
+	}
+
+	for (int32 i = ScheduledSpawners.Num() - 1; i >= 0; --i)
+	{
+		FScheduledSpawner& Scheduled = ScheduledSpawners[i];
+		ASpawner* Spawner = Scheduled.Spawner.Get();
+		if (!Spawner)
+		{
+			ScheduledSpawners.RemoveAtSwap(i);
+			continue;
+		}
+		if (Scheduled.NextTime > Now) continue;
+
+		// A hitch fires one batch, not one per missed interval
+		Scheduled.NextTime = FMath::Max(Scheduled.NextTime + Scheduled.Interval, Now + Scheduled.Interval * 0.5);
+		Spawner->SpawnBatch(Spawner->GetSpawnCount());
+	}
+
+	RescheduleTimer();
+}
+
+void USpawnerManagementSubsystem::RescheduleTimer()
+{
+	double NextTime = TNumericLimits<double>::Max();
+	for (const FRunningWave& Wave : RunningWaves)
+	{
+		const FSpawnWaveTimeline& Timeline = WaveTimelines.FindChecked(Wave.WaveId);
+		if (Timeline.Times.IsValidIndex(Wave.NextEntry))
+		{
+			NextTime = FMath::Min(NextTime, Wave.StartTime + Timeline.Times[Wave.NextEntry]);
+		}
+	}
+	for (const FScheduledSpawner& Scheduled : ScheduledSpawners)
+	{
+		NextTime = FMath::Min(NextTime, Scheduled.NextTime);
+	}
+
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	if (NextTime == TNumericLimits<double>::Max())
+	{
+		TimerManager.ClearTimer(SchedulerTimer);
+		return;
+	}
+	// A rate of zero would clear the timer, due work runs on the next frame instead
+	const float Delay = FMath::Max(static_cast<float>(NextTime - GetWorld()->GetTimeSeconds()), KINDA_SMALL_NUMBER);
+	TimerManager.SetTimer(SchedulerTimer, this, &USpawnerManagementSubsystem::RunScheduler, Delay, /*bLoop=*/false);
+}
+
+void USpawnerManagementSubsystem::ExecuteWaveEntry(const FSpawnWaveTimeline& Timeline, int32 Index)
+{
+	const FName Tag = WaveSpawnerTags[Timeline.SpawnerTagIndices[Index]];
+	TArray<ASpawner*> Targets;
+	for (const TPair<FName, TArray<TWeakObjectPtr<ASpawner>>>& Pair : SpawnersByTag)
+	{
+		if (!Tag.IsNone() && Pair.Key != Tag) continue;
+		for (const TWeakObjectPtr<ASpawner>& Spawner : Pair.Value)
+		{
+			if (Spawner.IsValid())
+			{
+				Targets.Add(Spawner.Get());
+			}
+		}
+	}
+	if (Targets.IsEmpty())
+	{
+		UE_LOG(LogSpawnSystem, Warning, TEXT("[SPAWNMGR_ERR_07] No spawner with tag '%s' for wave entry at %.2fs"), *Tag.ToString(), Timeline.Times[Index]);
+		return;
+	}
+
+	const int32 Count = Timeline.Counts[Index];
+	for (int32 i = 0; i < Targets.Num(); ++i)
+	{
+		// Even split, the first spawners take the remainder
+		const int32 Share = Count / Targets.Num() + (i < Count % Targets.Num() ? 1 : 0);
+		if (Share > 0)
+		{
+			Targets[i]->QueueSpawns(WaveClasses[Timeline.ClassIndices[Index]], Share, Timeline.InitialUpgradeLevels[Index]);
+		}
+	}
+}
+
+TStatId USpawnerManagementSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USpawnerManagementSubsystem, STATGROUP_Tickables);
 }
@@ -4,13 +4,25 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/WorldSubsystem.h"
+#include "SpawnWaveContainers.h"
 #include "SpawnerManagementSubsystem.generated.h"
 
+class ASpawner;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogSpawnSystem, Log, All);
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnManagedActorSpawned, AActor*);
+
 /**
- * 
+ * Spawns actors for spawners and keeps released actors in pools per class, so they are reactivated instead of destroyed
+ * and spawned again. Requests are queued and worked off within USpawnSettings::SpawnBudgetMs per frame, large waves are
+ * spread over several frames instead of spawning at once.
+ *
+ * Spawn waves found under USpawnSettings::WaveDataFolderPath are compiled into timelines at world begin play. Running
+ * waves and interval spawners share one scheduler timer, set to the earliest due time.
  */
 UCLASS()
-class PLUGIN_DEVELOPMENT_API USpawnerManagementSubsystem : public UWorldSubsystem
+class PLUGIN_DEVELOPMENT_API USpawnerManagementSubsystem : public UTickableWorldSubsystem
 {
 	GENERATED_BODY()
 
@@ -21,7 +33,146 @@ public:
 	virtual void Deinitialize() override;
 	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
 
+	/**
+	 * Queues an actor of ActorClass at Transform. Spawner, if set, is told once it is spawned.
+	 * An InitialUpgradeLevel other than -1 is set on the actor's upgradable components through the upgrade manager,
+	 * otherwise each starts at its own InitialLevel, also when the actor comes from the pool.
+	 */
+	void RequestSpawn(TSubclassOf<AActor> ActorClass, const FTransform& Transform, ASpawner* Spawner = nullptr, int32 InitialUpgradeLevel = INDEX_NONE);
+
+	/** Drops every queued request of Spawner */
+	void CancelSpawns(const ASpawner* Spawner);
+
+	/** Deactivates an actor spawned by this subsystem and keeps it for reuse */
+	UFUNCTION(BlueprintCallable, Category = "Spawn System")
+	void ReleaseActor(AActor* Actor);
+
+	UFUNCTION(BlueprintPure, Category = "Spawn System")
+	int32 GetPendingSpawnCount() const { return PendingSpawns.Num() - NextPendingSpawn; }
+
+	UFUNCTION(BlueprintPure, Category = "Spawn System")
+	int32 GetPooledCount(TSubclassOf<AActor> ActorClass) const;
+
+	/** Queued actors taken from a pool and spawned new since the world started, to size MaxPooledActorsPerClass */
+	int32 GetPoolHitCount() const { return PoolHitCount; }
+	int32 GetPoolMissCount() const { return PoolMissCount; }
+
+	/** Broadcast for every queued actor once it is spawned or taken from a pool, whether a spawner requested it or not */
+	FOnManagedActorSpawned OnActorSpawned;
+
+	/** Makes Spawner a target for wave entries with its SpawnerTag */
+	void RegisterSpawner(ASpawner* Spawner);
+	void UnregisterSpawner(ASpawner* Spawner);
+
+	/** Spawns a batch from Spawner every Interval seconds, starting with the next scheduler run */
+	void ScheduleSpawner(ASpawner* Spawner, float Interval);
+	void UnscheduleSpawner(const ASpawner* Spawner);
+
+	/** Starts the compiled wave WaveId from its beginning. Returns false if there is no such wave. */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Spawn System|Waves")
+	bool StartWave(FName WaveId);
+
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Spawn System|Waves")
+	void StopWave(FName WaveId);
+
+	/**
+	 * Moves the running wave WaveId forward to WaveTime seconds after its start, e.g. to test its late entries.
+	 * @param bSpawnSkippedEntries - spawn the entries that are skipped over at once, or drop them
+	 * @return - false if the wave is not running or already past WaveTime
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Spawn System|Waves")
+	bool FastForwardWave(FName WaveId, float WaveTime, bool bSpawnSkippedEntries = true);
+
+	/** Seconds since the running wave WaveId started, -1 if it is not running */
+	UFUNCTION(BlueprintPure, Category = "Spawn System|Waves")
+	float GetWaveTime(FName WaveId) const;
+
+	//~ Begin UTickableWorldSubsystem
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return GetPendingSpawnCount() > 0; }
+	virtual TStatId GetStatId() const override;
+	//~ End UTickableWorldSubsystem
+
 protected:
 
-	
+	struct FPendingSpawn
+	{
+		TSubclassOf<AActor> ActorClass;
+		FTransform Transform;
+		TWeakObjectPtr<ASpawner> Spawner;
+		int32 InitialUpgradeLevel = INDEX_NONE;
+	};
+
+	/** Requests in order, worked off from NextPendingSpawn */
+	TArray<FPendingSpawn> PendingSpawns;
+	int32 NextPendingSpawn = 0;
+
+	struct FPooledActor
+	{
+		TWeakObjectPtr<AActor> Actor;
+
+		/** Tick state at release, restored on reactivation so actors and components that never ticked stay that way */
+		bool bActorTickEnabled = false;
+		TArray<TWeakObjectPtr<UActorComponent>> TickingComponents;
+	};
+
+	/** Inactive actors by class */
+	TMap<TObjectKey<UClass>, TArray<FPooledActor>> Pools;
+
+	int32 PoolHitCount = 0;
+	int32 PoolMissCount = 0;
+
+	/** Active actors spawned by this subsystem and the spawner that requested them */
+	TMap<TObjectKey<AActor>, TWeakObjectPtr<ASpawner>> ActiveActors;
+
+	/** Takes an actor from the pool, or spawns one if the pool is empty */
+	AActor* AcquireActor(UClass* ActorClass, const FTransform& Transform);
+
+	void ApplyInitialUpgradeLevel(AActor* Actor, int32 Level) const;
+
+	/** Cancels the running upgrades of a released actor's upgradable components and pools or reactivates them */
+	void SetUpgradablesPooled(AActor* Actor, bool bPooled) const;
+
+	/** Compiled waves by ID */
+	TMap<FName, FSpawnWaveTimeline> WaveTimelines;
+
+	/** Actor classes of all timelines, loaded when the waves are compiled */
+	UPROPERTY()
+	TArray<TObjectPtr<UClass>> WaveClasses;
+
+	TArray<FName> WaveSpawnerTags;
+
+	/** Registered spawners by SpawnerTag */
+	TMap<FName, TArray<TWeakObjectPtr<ASpawner>>> SpawnersByTag;
+
+	struct FRunningWave
+	{
+		FName WaveId;
+		double StartTime = 0.0;
+		int32 NextEntry = 0;
+	};
+	TArray<FRunningWave> RunningWaves;
+
+	struct FScheduledSpawner
+	{
+		TWeakObjectPtr<ASpawner> Spawner;
+		double NextTime = 0.0;
+		float Interval = 0.f;
+	};
+	TArray<FScheduledSpawner> ScheduledSpawners;
+
+	FTimerHandle SchedulerTimer;
+
+	/** Reads the wave definitions and compiles them into WaveTimelines */
+	void LoadWaves();
+
+	/** Runs every wave entry and spawner batch that is due, then sets the timer for the next one */
+	void RunScheduler();
+	void RescheduleTimer();
+
+	/** Splits the entry's count over the spawners with its tag */
+	void ExecuteWaveEntry(const FSpawnWaveTimeline& Timeline, int32 Index);
+
+	UFUNCTION()
+	void OnManagedActorDestroyed(AActor* DestroyedActor);
 };
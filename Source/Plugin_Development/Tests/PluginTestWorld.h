@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+/**
+ * Standalone game world for automation tests, with a game mode so server only code runs, and torn down with this object.
+ * Ticking it ticks actors, timers and tickable subsystems like a frame of the game would.
+ */
+class FPluginTestWorld
+{
+public:
+	FPluginTestWorld()
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, /*bInformEngineOfWorld=*/false);
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+
+		const FURL URL;
+		World->SetGameMode(URL);
+		World->InitializeActorsForPlay(URL);
+		World->BeginPlay();
+	}
+
+	~FPluginTestWorld()
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(/*bInformEngineOfWorld=*/false);
+	}
+
+	FPluginTestWorld(const FPluginTestWorld&) = delete;
+	FPluginTestWorld& operator=(const FPluginTestWorld&) = delete;
+
+	UWorld* Get() const { return World; }
+
+	template<typename T>
+	T* GetSubsystem() const { return World->GetSubsystem<T>(); }
+
+	/** Runs one frame and returns its wall time in milliseconds */
+	double Tick(float DeltaSeconds)
+	{
+		const double Start = FPlatformTime::Seconds();
+		World->Tick(LEVELTICK_All, DeltaSeconds);
+		return (FPlatformTime::Seconds() - Start) * 1000.0;
+	}
+
+private:
+	UWorld* World = nullptr;
+};
+
+#endif
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "PluginTestWorld.h"
+#include "../RequestRateLimiterSubsystem.h"
+#include "../ResourceManagementSystem/ResourceManagerSubsystem.h"
+#include "../ResourceManagementSystem/ResourceSystemComponent.h"
+#include "Engine/DemoNetConnection.h"
+#include "GameFramework/PlayerController.h"
+
+namespace
+{
+	/** Player controller that looks remote to the server: requests from it and the actors it owns carry a connection */
+	APlayerController* SpawnRemotePlayer(UWorld* World)
+	{
+		APlayerController* PlayerController = World->SpawnActor<APlayerController>();
+		if (!PlayerController) return nullptr;
+
+		UNetConnection* Connection = NewObject<UDemoNetConnection>();
+		PlayerController->Player = Connection;
+		PlayerController->NetConnection = Connection;
+		return PlayerController;
+	}
+
+	/** Calls Server_SpendResource Count times in a row and returns how many spends went through */
+	int32 FloodSpends(UResourceManagerSubsystem* Resources, UResourceSystemComponent* Wallet, int32 ResourceId, int32 Count)
+	{
+		const int32 Before = Resources->GetResourceById(Wallet, ResourceId);
+		for (int32 i = 0; i < Count; ++i)
+		{
+			// Runs the implementation directly, as the server does for a received RPC that passed validation
+			Wallet->Server_SpendResource(static_cast<uint16>(ResourceId), 1);
+		}
+		return Before - Resources->GetResourceById(Wallet, ResourceId);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRateLimiterFloodTest, "Plugin_Development.NetRequests.RateLimiterFlood",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FRateLimiterFloodTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 FloodCount = 1000;
+	constexpr int32 StartBalance = 10 * FloodCount;
+
+	FPluginTestWorld TestWorld;
+	UResourceManagerSubsystem* Resources = TestWorld.GetSubsystem<UResourceManagerSubsystem>();
+	URequestRateLimiterSubsystem* RateLimiter = TestWorld.GetSubsystem<URequestRateLimiterSubsystem>();
+	if (!TestNotNull(TEXT("Resource subsystem"), Resources) || !TestNotNull(TEXT("Rate limiter"), RateLimiter)) return false;
+
+	const int32 ResourceId = Resources->FindOrAddResourceId(TEXT("RateLimitTestGold"));
+	TArray<UResourceSystemComponent*> Wallets;
+	TArray<APlayerController*> RemotePlayers;
+	for (int32 i = 0; i < 2; ++i)
+	{
+		RemotePlayers.Add(SpawnRemotePlayer(TestWorld.Get()));
+		if (!TestNotNull(TEXT("Remote player"), RemotePlayers.Last())) return false;
+	}
+	// Two remote players and a local one, which is never limited
+	const TArray<AActor*> Owners = { RemotePlayers[0], RemotePlayers[1], TestWorld.Get()->SpawnActor<AActor>() };
+	for (AActor* Owner : Owners)
+	{
+		UResourceSystemComponent* Wallet = NewObject<UResourceSystemComponent>(Owner);
+		Wallet->RegisterComponent();
+		if (!TestTrue(TEXT("Wallet has a bucket"), Resources->IsComponentRegistered(Wallet))) return false;
+		Resources->AddResourceById(Wallet, ResourceId, StartBalance);
+		Wallets.Add(Wallet);
+	}
+
+	// Within the few milliseconds of the flood a bucket refills by well under one token, so a remote player gets its burst
+	// and the rest is dropped. The second player has a bucket of its own.
+	AddExpectedError(TEXT("RATELIMIT_ERR_01"), EAutomationExpectedErrorFlags::Contains, 0);
+	AddExpectedError(TEXT("RATELIMIT_ERR_02"), EAutomationExpectedErrorFlags::Contains, 0);
+	const int32 FirstServed = FloodSpends(Resources, Wallets[0], ResourceId, FloodCount);
+	const int32 SecondServed = FloodSpends(Resources, Wallets[1], ResourceId, FloodCount);
+	const int32 LocalServed = FloodSpends(Resources, Wallets[2], ResourceId, FloodCount);
+	TestTrue(FString::Printf(TEXT("First remote player served %d of %d"), FirstServed, FloodCount), FirstServed > 0 && FirstServed < FloodCount / 10);
+	TestTrue(FString::Printf(TEXT("Second remote player served %d of %d"), SecondServed, FloodCount), SecondServed > 0 && SecondServed < FloodCount / 10);
+	TestEqual(TEXT("Local player served"), LocalServed, FloodCount);
+
+	// An upgrade batch over budget is served in part, and the empty bucket then turns single requests down
+	const int32 BatchServed = RateLimiter->ConsumeUpTo(Wallets[0], ERateLimitedRequest::Upgrade, FloodCount);
+	TestTrue(FString::Printf(TEXT("Upgrade batch served %d of %d"), BatchServed, FloodCount), BatchServed > 0 && BatchServed < FloodCount / 10);
+	TestFalse(TEXT("Upgrade request after the batch drained the bucket"), RateLimiter->TryConsume(Wallets[0], ERateLimitedRequest::Upgrade));
+	TestTrue(TEXT("Local upgrade request"), RateLimiter->TryConsume(Wallets[2], ERateLimitedRequest::Upgrade));
+
+	AddInfo(FString::Printf(TEXT("Flood of %d requests: %d resource and %d upgrade requests served per connection"), FloodCount, FirstServed, BatchServed));
+
+	// The fake connections are not driven by a net driver, detach them before the world is torn down
+	for (APlayerController* RemotePlayer : RemotePlayers)
+	{
+		RemotePlayer->Player = nullptr;
+		RemotePlayer->NetConnection = nullptr;
+	}
+	return true;
+}
+
+#endif
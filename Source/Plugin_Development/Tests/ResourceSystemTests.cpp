@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "PluginTestWorld.h"
+#include "../ResourceManagementSystem/ResourceManagerSubsystem.h"
+#include "../ResourceManagementSystem/ResourceSystemComponent.h"
+#include "Async/ParallelFor.h"
+#include "GameFramework/Actor.h"
+#include <atomic>
+
+namespace
+{
+	/** Spawns an actor with a resource component, which registers for a bucket as it begins play */
+	UResourceSystemComponent* SpawnWallet(UWorld* World)
+	{
+		AActor* Owner = World->SpawnActor<AActor>();
+		if (!Owner) return nullptr;
+
+		UResourceSystemComponent* Wallet = NewObject<UResourceSystemComponent>(Owner);
+		Wallet->RegisterComponent();
+		return Wallet;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FResourceConcurrentWalletTest, "Plugin_Development.ResourceSystem.ConcurrentWallet",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FResourceConcurrentWalletTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Workers = 16;
+	constexpr int32 OpsPerWorker = 2000;
+
+	FPluginTestWorld TestWorld;
+	UResourceManagerSubsystem* Resources = TestWorld.GetSubsystem<UResourceManagerSubsystem>();
+	UResourceSystemComponent* Wallet = Resources ? SpawnWallet(TestWorld.Get()) : nullptr;
+	if (!TestNotNull(TEXT("Registered wallet"), Wallet) || !TestTrue(TEXT("Wallet has a bucket"), Resources->IsComponentRegistered(Wallet))) return false;
+
+	const int32 ResourceId = Resources->FindOrAddResourceId(TEXT("ConcurrencyTestGold"));
+	const FResourceWalletHandle Handle = Resources->GetWalletHandle(Wallet);
+
+	// Contended spends only: exactly the starting balance can be spent, never a unit more
+	constexpr int32 ContendedBalance = 1000;
+	Resources->AddResourceById(Wallet, ResourceId, ContendedBalance);
+	std::atomic<int32> ContendedSpends = 0;
+	double Start = FPlatformTime::Seconds();
+	ParallelFor(Workers, [&](int32)
+	{
+		for (int32 i = 0; i < OpsPerWorker; ++i)
+		{
+			if (Resources->TrySpendConcurrent(Handle, ResourceId, 1))
+			{
+				++ContendedSpends;
+			}
+		}
+	}, EParallelForFlags::Unbalanced);
+	const double ContendedMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+	Resources->FlushQueuedGrants();
+	TestEqual(TEXT("Contended spends"), ContendedSpends.load(), ContendedBalance);
+	TestEqual(TEXT("Balance after contended spends"), Resources->GetResourceById(Wallet, ResourceId), 0);
+
+	// Grants and spends mixed. Grants only land with the flush, so spends draw on the starting balance alone.
+	constexpr int32 StartBalance = 5000;
+	constexpr int32 GrantAmount = 3;
+	constexpr int32 QueuedGrantAmount = 1;
+	constexpr int32 SpendAmount = 2;
+	Resources->AddResourceById(Wallet, ResourceId, StartBalance);
+	std::atomic<int32> MixedSpends = 0;
+	Start = FPlatformTime::Seconds();
+	ParallelFor(Workers, [&](int32)
+	{
+		for (int32 i = 0; i < OpsPerWorker; ++i)
+		{
+			Resources->AddResourceConcurrent(Handle, ResourceId, GrantAmount);
+			Resources->QueueAddResource(Wallet, TEXT("ConcurrencyTestGold"), QueuedGrantAmount);
+			if (Resources->TrySpendConcurrent(Handle, ResourceId, SpendAmount))
+			{
+				++MixedSpends;
+			}
+		}
+	}, EParallelForFlags::Unbalanced);
+	const double MixedMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+	TestEqual(TEXT("Mixed spends before the flush"), MixedSpends.load(), StartBalance / SpendAmount);
+	Resources->FlushQueuedGrants();
+
+	const int32 Expected = StartBalance + Workers * OpsPerWorker * (GrantAmount + QueuedGrantAmount) - MixedSpends.load() * SpendAmount;
+	TestEqual(TEXT("Balance after mixed grants and spends"), Resources->GetResourceById(Wallet, ResourceId), Expected);
+
+	AddInfo(FString::Printf(TEXT("%d workers x %d ops: contended spends %.3f ms, mixed grants and spends %.3f ms"),
+		Workers, OpsPerWorker, ContendedMs, MixedMs));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FResourceDenseRowsTest, "Plugin_Development.ResourceSystem.DenseRows",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FResourceDenseRowsTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Components = 10000;
+	constexpr int32 ComponentsPerActor = 100;
+	constexpr int32 ResourceCount = 20;
+	constexpr int32 Passes = 10;
+
+	FPluginTestWorld TestWorld;
+	UResourceManagerSubsystem* Resources = TestWorld.GetSubsystem<UResourceManagerSubsystem>();
+	if (!TestNotNull(TEXT("Resource subsystem"), Resources)) return false;
+
+	TArray<FName> ResourceNames;
+	TArray<int32> ResourceIds;
+	for (int32 r = 0; r < ResourceCount; ++r)
+	{
+		ResourceNames.Add(*FString::Printf(TEXT("DenseRowsTest%d"), r));
+		ResourceIds.Add(Resources->FindOrAddResourceId(ResourceNames.Last()));
+	}
+
+	// The same balances in the manager's rows and in one map per component, the way components used to store them
+	TArray<UResourceSystemComponent*> Wallets;
+	TArray<TMap<FName, int32>> MapWallets;
+	Wallets.Reserve(Components);
+	MapWallets.Reserve(Components);
+	AActor* Owner = nullptr;
+	for (int32 c = 0; c < Components; ++c)
+	{
+		if (c % ComponentsPerActor == 0)
+		{
+			Owner = TestWorld.Get()->SpawnActor<AActor>();
+		}
+		UResourceSystemComponent* Wallet = NewObject<UResourceSystemComponent>(Owner);
+		Wallet->RegisterComponent();
+		Wallets.Add(Wallet);
+		TMap<FName, int32>& MapWallet = MapWallets.AddDefaulted_GetRef();
+		for (int32 r = 0; r < ResourceCount; ++r)
+		{
+			const int32 Amount = (c * ResourceCount + r) % 97 + 1;
+			Resources->AddResourceById(Wallet, ResourceIds[r], Amount);
+			MapWallet.Add(ResourceNames[r], Amount);
+		}
+	}
+
+	int32 Mismatches = 0;
+	for (int32 c = 0; c < Components; ++c)
+	{
+		for (int32 r = 0; r < ResourceCount; ++r)
+		{
+			Mismatches += Resources->GetResourceById(Wallets[c], ResourceIds[r]) != MapWallets[c][ResourceNames[r]];
+		}
+	}
+	TestEqual(TEXT("Balances differing between rows and maps"), Mismatches, 0);
+
+	int64 DenseSum = 0;
+	double Start = FPlatformTime::Seconds();
+	for (int32 Pass = 0; Pass < Passes; ++Pass)
+	{
+		for (const UResourceSystemComponent* Wallet : Wallets)
+		{
+			for (const int32 ResourceId : ResourceIds)
+			{
+				DenseSum += Resources->GetResourceById(Wallet, ResourceId);
+			}
+		}
+	}
+	const double DenseMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+	int64 MapSum = 0;
+	Start = FPlatformTime::Seconds();
+	for (int32 Pass = 0; Pass < Passes; ++Pass)
+	{
+		for (const TMap<FName, int32>& MapWallet : MapWallets)
+		{
+			for (const FName& ResourceName : ResourceNames)
+			{
+				MapSum += MapWallet.FindRef(ResourceName);
+			}
+		}
+	}
+	const double MapMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+	TestEqual(TEXT("Sum of all balances"), DenseSum, MapSum);
+
+	AddInfo(FString::Printf(TEXT("%d components x %d resources, %d passes: dense rows %.3f ms, maps %.3f ms (%.2fx)"),
+		Components, ResourceCount, Passes, DenseMs, MapMs, MapMs / FMath::Max(DenseMs, UE_DOUBLE_SMALL_NUMBER)));
+	return true;
+}
+
+#endif
@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "PluginTestWorld.h"
+#include "../SpawnSystem/SpawnerManagementSubsystem.h"
+#include "../SpawnSystem/Spawner.h"
+#include "Components/BoxComponent.h"
+#include "GameFramework/Actor.h"
+#include "Algo/Count.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpawnPoolChurnTest, "Plugin_Development.SpawnSystem.PoolChurn",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FSpawnPoolChurnTest::RunTest(const FString& Parameters)
+{
+	// One simulated minute at 60 frames per second, 10k actors requested over it, each released again after 10 seconds
+	constexpr int32 Frames = 60 * 60;
+	constexpr float FrameSeconds = 1.f / 60.f;
+	constexpr int32 ActorsPerMinute = 10000;
+	constexpr int32 LifetimeFrames = 10 * 60;
+
+	FPluginTestWorld TestWorld;
+	USpawnerManagementSubsystem* SpawnSystem = TestWorld.GetSubsystem<USpawnerManagementSubsystem>();
+	if (!TestNotNull(TEXT("Spawn subsystem"), SpawnSystem)) return false;
+
+	struct FLiveActor
+	{
+		TWeakObjectPtr<AActor> Actor;
+		int32 ReleaseFrame = 0;
+	};
+	TArray<FLiveActor> LiveActors;
+	int32 Frame = 0;
+	int32 SpawnedCount = 0;
+	SpawnSystem->OnActorSpawned.AddLambda([&LiveActors, &Frame, &SpawnedCount](AActor* Actor)
+	{
+		LiveActors.Add({ Actor, Frame + LifetimeFrames });
+		++SpawnedCount;
+	});
+
+	const int32 HitsBefore = SpawnSystem->GetPoolHitCount();
+	const int32 MissesBefore = SpawnSystem->GetPoolMissCount();
+	TArray<double> FrameTimes;
+	FrameTimes.Reserve(Frames);
+	int32 RequestedCount = 0;
+	int32 NextLive = 0;
+	for (; Frame < Frames; ++Frame)
+	{
+		const int32 DueCount = static_cast<int32>(static_cast<int64>(Frame + 1) * ActorsPerMinute / Frames);
+		for (; RequestedCount < DueCount; ++RequestedCount)
+		{
+			SpawnSystem->RequestSpawn(AActor::StaticClass(), FTransform(FVector(RequestedCount % 100 * 200.f, RequestedCount / 100 % 100 * 200.f, 0.f)));
+		}
+		// Spawned in order, so the oldest are at the front
+		for (; NextLive < LiveActors.Num() && LiveActors[NextLive].ReleaseFrame <= Frame; ++NextLive)
+		{
+			if (AActor* Actor = LiveActors[NextLive].Actor.Get())
+			{
+				SpawnSystem->ReleaseActor(Actor);
+			}
+		}
+		FrameTimes.Add(TestWorld.Tick(FrameSeconds));
+	}
+	for (int32 DrainFrames = 0; SpawnSystem->GetPendingSpawnCount() > 0 && DrainFrames < 600; ++DrainFrames)
+	{
+		TestWorld.Tick(FrameSeconds);
+	}
+
+	const int32 Hits = SpawnSystem->GetPoolHitCount() - HitsBefore;
+	const int32 Misses = SpawnSystem->GetPoolMissCount() - MissesBefore;
+	TestEqual(TEXT("Every requested actor was spawned"), SpawnedCount, RequestedCount);
+	TestEqual(TEXT("Every spawn is a pool hit or a miss"), Hits + Misses, SpawnedCount);
+	// Nothing is released during the first lifetime, after that releases keep up with requests and most come from the pool
+	const float HitRate = SpawnedCount > 0 ? static_cast<float>(Hits) / SpawnedCount : 0.f;
+	TestTrue(FString::Printf(TEXT("Pool hit rate %.2f is above 0.5"), HitRate), HitRate > 0.5f);
+
+	FrameTimes.Sort();
+	double TotalMs = 0.0;
+	for (const double FrameMs : FrameTimes)
+	{
+		TotalMs += FrameMs;
+	}
+	AddInfo(FString::Printf(TEXT("%d actors over %d frames: frame time avg %.3f ms, p99 %.3f ms, max %.3f ms. Pool hit rate %.1f%% (%d hits, %d misses)"),
+		SpawnedCount, Frames, TotalMs / FrameTimes.Num(), FrameTimes[FrameTimes.Num() * 99 / 100], FrameTimes.Last(), HitRate * 100.f, Hits, Misses));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpawnerPlacementTest, "Plugin_Development.SpawnSystem.Placement",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FSpawnerPlacementTest::RunTest(const FString& Parameters)
+{
+	FPluginTestWorld TestWorld;
+	USpawnerManagementSubsystem* SpawnSystem = TestWorld.GetSubsystem<USpawnerManagementSubsystem>();
+	ASpawner* Spawner = TestWorld.Get()->SpawnActor<ASpawner>();
+	UBoxComponent* Box = Spawner ? Spawner->FindComponentByClass<UBoxComponent>() : nullptr;
+	if (!TestNotNull(TEXT("Spawn subsystem"), SpawnSystem) || !TestNotNull(TEXT("Spawner box"), Box)) return false;
+	Box->SetBoxExtent(FVector(5000.f, 5000.f, 100.f));
+
+	// Point generation alone
+	constexpr int32 PointsPerCall = 10000;
+	constexpr int32 Calls = 50;
+	TArray<FVector> Points;
+	const FBox Bounds = Box->Bounds.GetBox().ExpandBy(1.f);
+	int32 PointsOutside = 0;
+	double GenerateMs = 0.0;
+	for (int32 Call = 0; Call < Calls; ++Call)
+	{
+		Points.Reset();
+		const double Start = FPlatformTime::Seconds();
+		Spawner->GenerateStratifiedPoints(PointsPerCall, Points);
+		GenerateMs += (FPlatformTime::Seconds() - Start) * 1000.0;
+		PointsOutside += Algo::CountIf(Points, [&Bounds](const FVector& Point) { return !Bounds.IsInsideOrOn(Point); });
+	}
+	TestEqual(TEXT("Points generated per call"), Points.Num(), PointsPerCall);
+	TestEqual(TEXT("Points outside the box"), PointsOutside, 0);
+
+	// Round trip of a batch that needs new points: overlap queries are issued by QueueSpawns and answered during a later
+	// world tick, which hands the batch to the subsystem. Moving the spawner drops its cached points before each round.
+	constexpr int32 Rounds = 20;
+	constexpr int32 BatchSize = 128;
+	int32 SpawnedCount = 0;
+	TArray<TWeakObjectPtr<AActor>> SpawnedActors;
+	SpawnSystem->OnActorSpawned.AddLambda([&SpawnedCount, &SpawnedActors](AActor* Actor)
+	{
+		++SpawnedCount;
+		SpawnedActors.Add(Actor);
+	});
+	double RoundTripMs = 0.0;
+	int32 RoundTripFrames = 0;
+	int32 CompletedRounds = 0;
+	for (int32 Round = 0; Round < Rounds; ++Round)
+	{
+		Spawner->SetActorLocation(FVector(Round * 100.f, 0.f, 0.f));
+		SpawnedCount = 0;
+		const double Start = FPlatformTime::Seconds();
+		Spawner->QueueSpawns(AActor::StaticClass(), BatchSize);
+		double RoundMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+		int32 Frames = 0;
+		while (SpawnSystem->GetPendingSpawnCount() == 0 && SpawnedCount == 0 && Frames < 10)
+		{
+			RoundMs += TestWorld.Tick(1.f / 60.f);
+			++Frames;
+		}
+		if (SpawnSystem->GetPendingSpawnCount() > 0 || SpawnedCount > 0)
+		{
+			RoundTripMs += RoundMs;
+			RoundTripFrames += Frames;
+			++CompletedRounds;
+		}
+
+		// Spawn the rest and return everything to the pool, so the next round spawns from it
+		for (int32 DrainFrames = 0; SpawnSystem->GetPendingSpawnCount() > 0 && DrainFrames < 60; ++DrainFrames)
+		{
+			TestWorld.Tick(1.f / 60.f);
+		}
+		for (const TWeakObjectPtr<AActor>& Actor : SpawnedActors)
+		{
+			if (Actor.IsValid()) SpawnSystem->ReleaseActor(Actor.Get());
+		}
+		SpawnedActors.Reset();
+	}
+	TestEqual(TEXT("Every batch got its points validated"), CompletedRounds, Rounds);
+
+	AddInfo(FString::Printf(TEXT("GenerateStratifiedPoints: %.0f points/ms (%d x %d points in %.3f ms)"),
+		PointsPerCall * Calls / FMath::Max(GenerateMs, UE_DOUBLE_SMALL_NUMBER), Calls, PointsPerCall, GenerateMs));
+	if (CompletedRounds > 0)
+	{
+		AddInfo(FString::Printf(TEXT("Overlap round trip: %.3f ms and %.1f frame(s) per batch of %d, %.1f points/ms"),
+			RoundTripMs / CompletedRounds, static_cast<double>(RoundTripFrames) / CompletedRounds, BatchSize,
+			BatchSize * CompletedRounds / FMath::Max(RoundTripMs, UE_DOUBLE_SMALL_NUMBER)));
+	}
+	return true;
+}
+
+#endif
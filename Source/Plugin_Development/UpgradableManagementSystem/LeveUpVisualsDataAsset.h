@@ -14,6 +14,19 @@ enum class EMeshForMaterialSwap : uint8
 	StaticMesh,
 	SkeletalMesh
 };
+/** How a level changes the look of the meshes besides swapping the mesh itself */
+UENUM(BlueprintType)
+enum class EUpgradeVisualsMode : uint8
+{
+	/** SetMaterial per slot from MaterialSwapsPerLevel */
+	MaterialSwaps = 0,
+	/**
+	 * One shared material reads the level from custom primitive data, or per-instance custom data when instanced.
+	 * A level-up only writes a few floats, the material binding and batching stay the same.
+	 */
+	CustomPrimitiveData
+};
+
 /** 
  * Helper struct for describing “at this level, on this mesh, swap this slot to this material.” 
  */
@@ -32,7 +45,7 @@ struct FMaterialSwapInfo
 
 	/** The material to apply */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	UMaterialInterface* Material = nullptr;
+	TSoftObjectPtr<UMaterialInterface> Material;
 };
 
 USTRUCT(BlueprintType)
@@ -45,8 +58,27 @@ struct PLUGIN_DEVELOPMENT_API FMaterialSwapList
 	TArray<FMaterialSwapInfo> MaterialSwaps;
 };
 
-/** TODO: Add a method (Maybe in the UpgradableComponent) to set the visuals of the actor on level up.
- * 
+/** Floats written for one level in EUpgradeVisualsMode::CustomPrimitiveData, after the level index */
+USTRUCT(BlueprintType)
+struct PLUGIN_DEVELOPMENT_API FLevelCustomData
+{
+	GENERATED_BODY()
+
+	/** Written as 3 floats, R G B */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Upgrade")
+	FLinearColor Tint = FLinearColor::White;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Upgrade")
+	float Tier = 0.f;
+
+	/** Anything else the material reads, written after Tier */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Upgrade")
+	TArray<float> Extra;
+};
+
+/**
+ * Meshes, materials and effects per level. All references are soft, only levels that are shown or about to be shown
+ * are streamed in, through ULevelUpVisualsStreamer.
  */
 UCLASS()
 class PLUGIN_DEVELOPMENT_API UOnLeveUpVisualsDataAsset : public UPrimaryDataAsset
@@ -56,20 +88,75 @@ class PLUGIN_DEVELOPMENT_API UOnLeveUpVisualsDataAsset : public UPrimaryDataAsse
 public:
 	// Automatically applied if using UpgradableComponent's ChangeActorVisualsPerUpgradeLevel function
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Upgrade System")
-	TMap<int32, UStaticMesh*> StaticMeshPerLevel;
+	TMap<int32, TSoftObjectPtr<UStaticMesh>> StaticMeshPerLevel;
 
 	// Automatically applied if using UpgradableComponent's ChangeActorVisualsPerUpgradeLevel function
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Upgrade System")
-	TMap<int32, USkeletalMesh*> SkeletalMeshPerLevel;
+	TMap<int32, TSoftObjectPtr<USkeletalMesh>> SkeletalMeshPerLevel;
 
 	/**
 	 * Automatically applied if using UpgradableComponent's ChangeActorVisualsPerUpgradeLevel function
-	 * Map each level to an array of material swaps to apply.
+	 * Map each level to an array of material swaps to apply. Ignored in CustomPrimitiveData mode.
 	*/
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Upgrade System")
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Upgrade System", meta=(EditCondition="VisualsMode == EUpgradeVisualsMode::MaterialSwaps"))
 	TMap<int32, FMaterialSwapList> MaterialSwapsPerLevel;
 
-	// Needs to be activated manually using the Spawn Niagara functions in BP
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Upgrade System|Custom Data")
+	EUpgradeVisualsMode VisualsMode = EUpgradeVisualsMode::MaterialSwaps;
+
+	// First custom data index written. Layout from there: level, tint R, G, B, tier, extra floats
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Upgrade System|Custom Data", meta=(ClampMin="0", EditCondition="VisualsMode == EUpgradeVisualsMode::CustomPrimitiveData"))
+	int32 CustomDataStartIndex = 0;
+
+	// Levels without an entry write their level index with a white tint and tier 0
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Upgrade System|Custom Data", meta=(EditCondition="VisualsMode == EUpgradeVisualsMode::CustomPrimitiveData"))
+	TMap<int32, FLevelCustomData> CustomDataPerLevel;
+
+	/** Custom data floats of Level, to be written from CustomDataStartIndex on */
+	void GetCustomDataForLevel(int32 Level, TArray<float>& OutData) const
+	{
+		static const FLevelCustomData DefaultData;
+		const FLevelCustomData* LevelData = CustomDataPerLevel.Find(Level);
+		if (!LevelData) LevelData = &DefaultData;
+
+		OutData.Reset();
+		OutData.Append({ static_cast<float>(Level), LevelData->Tint.R, LevelData->Tint.G, LevelData->Tint.B, LevelData->Tier });
+		OutData.Append(LevelData->Extra);
+	}
+
+	/** Per-instance custom floats a batch of these visuals needs, 0 unless VisualsMode is CustomPrimitiveData */
+	int32 GetInstanceCustomDataCount() const
+	{
+		if (VisualsMode != EUpgradeVisualsMode::CustomPrimitiveData) return 0;
+		int32 MaxExtra = 0;
+		for (const TPair<int32, FLevelCustomData>& Pair : CustomDataPerLevel)
+		{
+			MaxExtra = FMath::Max(MaxExtra, Pair.Value.Extra.Num());
+		}
+		return CustomDataStartIndex + 5 + MaxExtra;
+	}
+
+	// Needs to be activated manually using the Spawn Niagara functions in BP, get it with GetLoadedNiagaraSystem
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Upgrade System")
-	TMap<int32, UNiagaraSystem*> NiagaraSystemPerLevel;
+	TMap<int32, TSoftObjectPtr<UNiagaraSystem>> NiagaraSystemPerLevel;
+
+	/** Effect of Level if it is streamed in, e.g. after ChangeActorVisualsPerUpgradeLevel applied the level */
+	UFUNCTION(BlueprintPure, Category = "Upgrade System")
+	UNiagaraSystem* GetLoadedNiagaraSystem(int32 Level) const { return NiagaraSystemPerLevel.FindRef(Level).Get(); }
+
+	/** Every asset Level references */
+	void GetAssetsForLevel(int32 Level, TArray<FSoftObjectPath>& OutAssets) const
+	{
+		if (const TSoftObjectPtr<UStaticMesh>* Mesh = StaticMeshPerLevel.Find(Level); Mesh && !Mesh->IsNull()) OutAssets.Add(Mesh->ToSoftObjectPath());
+		if (const TSoftObjectPtr<USkeletalMesh>* Mesh = SkeletalMeshPerLevel.Find(Level); Mesh && !Mesh->IsNull()) OutAssets.Add(Mesh->ToSoftObjectPath());
+		if (const TSoftObjectPtr<UNiagaraSystem>* System = NiagaraSystemPerLevel.Find(Level); System && !System->IsNull()) OutAssets.Add(System->ToSoftObjectPath());
+		const FMaterialSwapList* SwapList = VisualsMode == EUpgradeVisualsMode::MaterialSwaps ? MaterialSwapsPerLevel.Find(Level) : nullptr;
+		if (SwapList)
+		{
+			for (const FMaterialSwapInfo& SwapInfo : SwapList->MaterialSwaps)
+			{
+				if (!SwapInfo.Material.IsNull()) OutAssets.Add(SwapInfo.Material.ToSoftObjectPath());
+			}
+		}
+	}
 };
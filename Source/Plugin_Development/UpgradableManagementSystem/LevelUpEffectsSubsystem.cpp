@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LevelUpEffectsSubsystem.h"
+#include "UpgradableComponent.h"
+#include "UpgradeSettings.h"
+#include "LeveUpVisualsDataAsset.h"
+#include "NiagaraComponent.h"
+#include "NiagaraSystem.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+bool ULevelUpEffectsSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return !IsRunningDedicatedServer() && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool ULevelUpEffectsSubsystem::PlayLevelUpEffect(UNiagaraSystem* System, FVector Location, FRotator Rotation)
+{
+	if (!System || !IsInView(Location)) return false;
+
+	FEffectPool& Pool = Pools.FindOrAdd(System);
+	if (Pool.ActiveCount >= GetDefault<UUpgradeSettings>()->MaxConcurrentEffectsPerSystem) return false;
+
+	UNiagaraComponent* Effect = nullptr;
+	while (!Effect && Pool.Free.Num() > 0)
+	{
+		Effect = Pool.Free.Pop(/*bAllowShrinking=*/false).Get();
+	}
+	if (!Effect)
+	{
+		Effect = CreatePooledComponent(System);
+	}
+
+	++Pool.ActiveCount;
+	Effect->SetWorldLocationAndRotation(Location, Rotation);
+	Effect->Activate(/*bReset=*/true);
+	return true;
+}
+
+bool ULevelUpEffectsSubsystem::PlayLevelUpEffectForComponent(UUpgradableComponent* Component, int32 Level)
+{
+	const AActor* Owner = Component ? Component->GetOwner() : nullptr;
+	const UOnLeveUpVisualsDataAsset* Visuals = Component ? Component->GetLevelUpVisuals() : nullptr;
+	if (!Owner || !Visuals) return false;
+
+	return PlayLevelUpEffect(Visuals->GetLoadedNiagaraSystem(Level), Owner->GetActorLocation(), Owner->GetActorRotation());
+}
+
+void ULevelUpEffectsSubsystem::PrewarmSystem(UNiagaraSystem* System)
+{
+	if (!System) return;
+
+	FEffectPool& Pool = Pools.FindOrAdd(System);
+	const int32 PrewarmCount = GetDefault<UUpgradeSettings>()->EffectPoolPrewarmCount;
+	while (Pool.Free.Num() + Pool.ActiveCount < PrewarmCount)
+	{
+		Pool.Free.Add(CreatePooledComponent(System));
+	}
+}
+
+UNiagaraComponent* ULevelUpEffectsSubsystem::CreatePooledComponent(UNiagaraSystem* System)
+{
+	if (!EffectHost)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		EffectHost = GetWorld()->SpawnActor<AActor>(SpawnParams);
+		USceneComponent* Root = NewObject<USceneComponent>(EffectHost, TEXT("Root"));
+		EffectHost->SetRootComponent(Root);
+		Root->RegisterComponent();
+	}
+
+	UNiagaraComponent* Effect = NewObject<UNiagaraComponent>(EffectHost);
+	Effect->SetAutoActivate(false);
+	Effect->SetAutoDestroy(false);
+	Effect->SetAsset(System);
+	Effect->SetupAttachment(EffectHost->GetRootComponent());
+	Effect->SetUsingAbsoluteLocation(true);
+	Effect->SetUsingAbsoluteRotation(true);
+	Effect->OnSystemFinished.AddDynamic(this, &ULevelUpEffectsSubsystem::OnEffectFinished);
+	Effect->RegisterComponent();
+	EffectHost->AddInstanceComponent(Effect);
+	return Effect;
+}
+
+bool ULevelUpEffectsSubsystem::IsInView(const FVector& Location) const
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (!PlayerController) return true;
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	const FVector ToEffect = Location - ViewLocation;
+	const double CullDistance = GetDefault<UUpgradeSettings>()->EffectCullDistance;
+	if (ToEffect.SizeSquared() > FMath::Square(CullDistance)) return false;
+
+	// Half the horizontal field of view plus a margin for the effect's own size
+	const float FOV = PlayerController->PlayerCameraManager ? PlayerController->PlayerCameraManager->GetFOVAngle() : 90.f;
+	const double CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(FMath::Min(FOV * 0.5f + 15.f, 180.f)));
+	return ToEffect.IsNearlyZero() || FVector::DotProduct(ToEffect.GetUnsafeNormal(), ViewRotation.Vector()) >= CosHalfAngle;
+}
+
+void ULevelUpEffectsSubsystem::OnEffectFinished(UNiagaraComponent* Component)
+{
+	FEffectPool* Pool = Component ? Pools.Find(Component->GetAsset()) : nullptr;
+	if (!Pool) return;
+
+	Pool->ActiveCount = FMath::Max(Pool->ActiveCount - 1, 0);
+	Pool->Free.Add(Component);
+}
+
+void ULevelUpEffectsSubsystem::Deinitialize()
+{
+	Pools.Empty();
+	if (IsValid(EffectHost))
+	{
+		EffectHost->Destroy();
+		EffectHost = nullptr;
+	}
+	Super::Deinitialize();
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LevelUpEffectsSubsystem.generated.h"
+
+class UNiagaraComponent;
+class UNiagaraSystem;
+class UUpgradableComponent;
+
+/**
+ * Plays level-up effects from pools of Niagara components, one pool per system, instead of spawning a component per
+ * level-up. Pools are prewarmed when a level's visuals are prefetched. Each system plays at most
+ * UUpgradeSettings::MaxConcurrentEffectsPerSystem effects at once, and effects outside the local view are not played at all.
+ */
+UCLASS()
+class PLUGIN_DEVELOPMENT_API ULevelUpEffectsSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Plays System at the given transform from its pool.
+	 * @return - false if the effect was culled or the system is at its concurrency cap
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Upgrade System|Visuals")
+	bool PlayLevelUpEffect(UNiagaraSystem* System, FVector Location, FRotator Rotation);
+
+	/** Plays the Niagara system of Level from the component's visuals asset at its owner, if the system is streamed in */
+	UFUNCTION(BlueprintCallable, Category = "Upgrade System|Visuals")
+	bool PlayLevelUpEffectForComponent(UUpgradableComponent* Component, int32 Level);
+
+	/** Creates pooled components for System up to UUpgradeSettings::EffectPoolPrewarmCount */
+	void PrewarmSystem(UNiagaraSystem* System);
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+private:
+	struct FEffectPool
+	{
+		TArray<TWeakObjectPtr<UNiagaraComponent>> Free;
+		int32 ActiveCount = 0;
+	};
+
+	TMap<TObjectKey<UNiagaraSystem>, FEffectPool> Pools;
+
+	/** Transient actor owning the pooled components */
+	UPROPERTY()
+	TObjectPtr<AActor> EffectHost;
+
+	UNiagaraComponent* CreatePooledComponent(UNiagaraSystem* System);
+
+	/** True if Location is close enough to the local view and inside its field of view */
+	bool IsInView(const FVector& Location) const;
+
+	UFUNCTION()
+	void OnEffectFinished(UNiagaraComponent* Component);
+};
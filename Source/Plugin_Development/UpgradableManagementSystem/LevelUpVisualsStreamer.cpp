@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LevelUpVisualsStreamer.h"
+#include "LeveUpVisualsDataAsset.h"
+#include "UpgradeManagerSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+
+void ULevelUpVisualsStreamer::AcquireLevel(const UOnLeveUpVisualsDataAsset* Visuals, int32 Level, bool bHighPriority, FSimpleDelegate OnLoaded)
+{
+	if (!Visuals) return;
+
+	const FLevelKey Key(Visuals, Level);
+	FStreamedLevel& Streamed = StreamedLevels.FindOrAdd(Key);
+	++Streamed.References;
+
+	if (Streamed.bLoaded)
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+	if (OnLoaded.IsBound())
+	{
+		Streamed.PendingCallbacks.Add(MoveTemp(OnLoaded));
+	}
+	if (Streamed.Handle.IsValid())
+	{
+		// Already streaming. A prefetch that is now needed on screen jumps the queue.
+		if (bHighPriority && !Streamed.Handle->HasLoadCompleted())
+		{
+			Streamed.Handle->UpdatePriority(FStreamableManager::AsyncLoadHighPriority);
+		}
+		return;
+	}
+
+	TArray<FSoftObjectPath> Assets;
+	Visuals->GetAssetsForLevel(Level, Assets);
+	TSharedPtr<FStreamableHandle> Handle;
+	if (Assets.Num() > 0)
+	{
+		const TAsyncLoadPriority Priority = bHighPriority ? FStreamableManager::AsyncLoadHighPriority : FStreamableManager::DefaultAsyncLoadPriority;
+		Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(Assets),
+			FStreamableDelegate::CreateUObject(this, &ULevelUpVisualsStreamer::OnLevelStreamed, Key), Priority);
+	}
+
+	// Assets that are already resident complete inside RequestAsyncLoad, and their callbacks may have changed the map
+	FStreamedLevel* Entry = StreamedLevels.Find(Key);
+	if (!Entry) return;
+
+	Entry->Handle = Handle;
+	if (!Handle.IsValid() || Handle->HasLoadCompleted())
+	{
+		OnLevelStreamed(Key);
+	}
+}
+
+bool ULevelUpVisualsStreamer::IsLevelLoaded(const UOnLeveUpVisualsDataAsset* Visuals, int32 Level) const
+{
+	const FStreamedLevel* Streamed = StreamedLevels.Find(FLevelKey(Visuals, Level));
+	return Streamed && Streamed->bLoaded;
+}
+
+void ULevelUpVisualsStreamer::ReleaseLevel(const UOnLeveUpVisualsDataAsset* Visuals, int32 Level)
+{
+	const FLevelKey Key(Visuals, Level);
+	FStreamedLevel* Streamed = StreamedLevels.Find(Key);
+	if (!Streamed || --Streamed->References > 0) return;
+
+	if (Streamed->Handle.IsValid())
+	{
+		Streamed->Handle->ReleaseHandle();
+	}
+	StreamedLevels.Remove(Key);
+	if (UE_LOG_ACTIVE(LogUpgradeSystem, Verbose))
+	{
+		UE_LOG(LogUpgradeSystem, Verbose, TEXT("[VISUALSTREAM_INFO_01] Released level %d visuals. %d level(s) resident"), Level, StreamedLevels.Num());
+	}
+}
+
+void ULevelUpVisualsStreamer::OnLevelStreamed(FLevelKey Key)
+{
+	FStreamedLevel* Streamed = StreamedLevels.Find(Key);
+	// Also ignores the late completion of a handle released before the level was acquired again
+	if (!Streamed || Streamed->bLoaded || (Streamed->Handle.IsValid() && !Streamed->Handle->HasLoadCompleted())) return;
+
+	Streamed->bLoaded = true;
+	TArray<FSimpleDelegate> Callbacks = MoveTemp(Streamed->PendingCallbacks);
+	for (FSimpleDelegate& Callback : Callbacks)
+	{
+		Callback.ExecuteIfBound();
+	}
+}
+
+void ULevelUpVisualsStreamer::Deinitialize()
+{
+	for (TPair<FLevelKey, FStreamedLevel>& Pair : StreamedLevels)
+	{
+		if (Pair.Value.Handle.IsValid())
+		{
+			Pair.Value.Handle->ReleaseHandle();
+		}
+	}
+	StreamedLevels.Empty();
+	Super::Deinitialize();
+}
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LevelUpVisualsStreamer.generated.h"
+
+class UOnLeveUpVisualsDataAsset;
+struct FStreamableHandle;
+
+/**
+ * Reference counted streaming of the assets of one level of a UOnLeveUpVisualsDataAsset.
+ * Every upgradable showing a level, or about to show it, holds one reference. The level's assets stay resident while
+ * it has any and are released with the last one, so only levels in use are in memory no matter how many levels and
+ * upgradable types a map has.
+ */
+UCLASS()
+class PLUGIN_DEVELOPMENT_API ULevelUpVisualsStreamer : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Adds a reference to Level and starts streaming its assets if it is not resident yet.
+	 * @param OnLoaded - Called once the assets are loaded, right away if they already are
+	 * @param bHighPriority - For levels that are about to be shown, prefetches use the default priority
+	 */
+	void AcquireLevel(const UOnLeveUpVisualsDataAsset* Visuals, int32 Level, bool bHighPriority, FSimpleDelegate OnLoaded = FSimpleDelegate());
+
+	/** Drops a reference taken with AcquireLevel. The level's assets are released with the last one. */
+	void ReleaseLevel(const UOnLeveUpVisualsDataAsset* Visuals, int32 Level);
+
+	/** True if Level is referenced and its assets finished loading */
+	bool IsLevelLoaded(const UOnLeveUpVisualsDataAsset* Visuals, int32 Level) const;
+
+	/** Levels currently referenced, over all visuals assets */
+	int32 GetStreamedLevelCount() const { return StreamedLevels.Num(); }
+
+	virtual void Deinitialize() override;
+
+private:
+	struct FStreamedLevel
+	{
+		TSharedPtr<FStreamableHandle> Handle;
+		int32 References = 0;
+		bool bLoaded = false;
+		TArray<FSimpleDelegate> PendingCallbacks;
+	};
+
+	using FLevelKey = TPair<TObjectKey<UOnLeveUpVisualsDataAsset>, int32>;
+
+	TMap<FLevelKey, FStreamedLevel> StreamedLevels;
+
+	void OnLevelStreamed(FLevelKey Key);
+};
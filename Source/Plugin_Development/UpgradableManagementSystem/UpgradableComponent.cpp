@@ -1,6 +1,17 @@
 #include "UpgradableComponent.h"
 #include "UpgradeManagerSubsystem.h"
 #include "GameFramework/Actor.h"
+#include "UpgradeRequestBatcherComponent.h"
+#include "../ResourceManagementSystem/ResourceManagerSubsystem.h"
+#include "../RequestRateLimiterSubsystem.h"
+#include "Net/UnrealNetwork.h"
+#include "GameFramework/GameStateBase.h"
+#include "LevelUpVisualsStreamer.h"
+#include "UpgradableInstanceRenderer.h"
+#include "UpgradeVisualsQueue.h"
+#include "LevelUpEffectsSubsystem.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
 
 UUpgradableComponent::UUpgradableComponent()
 {
@@ -30,47 +41,350 @@ void UUpgradableComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 			Subsystem->UnregisterUpgradableComponent(UpgradableID);
 		}
 	}
+	else if (UpgradableID != -1)
+	{
+		if (UUpgradeManagerSubsystem* Subsystem = GetWorld()->GetSubsystem<UUpgradeManagerSubsystem>())
+		{
+			Subsystem->UnregisterReplicatedComponent(UpgradableID, this);
+		}
+	}
+	ReleaseLevelVisuals();
+	if (UUpgradableInstanceRenderer* Renderer = GetWorld()->GetSubsystem<UUpgradableInstanceRenderer>())
+	{
+		Renderer->RemoveInstance(this);
+	}
+	if (UUpgradeVisualsQueue* VisualsQueue = GetWorld()->GetSubsystem<UUpgradeVisualsQueue>())
+	{
+		VisualsQueue->Dequeue(this);
+	}
 	Super::EndPlay(EndPlayReason);
 }
 
-// void UUpgradableComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
-// {
-// 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-// 	DOREPLIFETIME(UUpgradableComponent, LocalLevel);
-// }
+void UUpgradableComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME(UUpgradableComponent, UpgradableID);
+	DOREPLIFETIME(UUpgradableComponent, UpgradeEndServerTime);
+	DOREPLIFETIME(UUpgradableComponent, UpgradeTotalTime);
+	DOREPLIFETIME(UUpgradableComponent, UpgradeTargetLevel);
+	DOREPLIFETIME(UUpgradableComponent, bPooled);
+}
+
+float UUpgradableComponent::GetUpgradeTimeRemaining() const
+{
+	if (UpgradeEndServerTime <= 0.0) return -1.f;
+
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	const double ServerTime = GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+	return FMath::Max(static_cast<float>(UpgradeEndServerTime - ServerTime), 0.f);
+}
+
+void UUpgradableComponent::SetUpgradeSchedule(double EndServerTime, float TotalTime, int32 TargetLevel)
+{
+	UpgradeEndServerTime = EndServerTime;
+	UpgradeTotalTime = TotalTime;
+	UpgradeTargetLevel = TargetLevel;
+
+	// A listen server or standalone game shows the component too
+	if (GetNetMode() != NM_DedicatedServer)
+	{
+		PrefetchLevelVisuals(TargetLevel);
+	}
+}
+
+void UUpgradableComponent::OnRep_UpgradableID(int32 OldUpgradableID)
+{
+	UUpgradeManagerSubsystem* Subsystem = GetWorld()->GetSubsystem<UUpgradeManagerSubsystem>();
+	if (!Subsystem) return;
+
+	if (OldUpgradableID != -1)
+	{
+		Subsystem->UnregisterReplicatedComponent(OldUpgradableID, this);
+	}
+	Subsystem->RegisterReplicatedComponent(this);
+}
+
+void UUpgradableComponent::OnRep_UpgradeTargetLevel()
+{
+	PrefetchLevelVisuals(UpgradeTargetLevel);
+}
+
+void UUpgradableComponent::SetPooled(bool bInPooled)
+{
+	bPooled = bInPooled;
+	UpdateRenderedInstance();
+}
+
+void UUpgradableComponent::OnRep_Pooled()
+{
+	UpdateRenderedInstance();
+}
+
+void UUpgradableComponent::UpdateRenderedInstance()
+{
+	UUpgradableInstanceRenderer* Renderer = GetWorld() ? GetWorld()->GetSubsystem<UUpgradableInstanceRenderer>() : nullptr;
+	const UStaticMeshComponent* MeshComponent = InstancedMeshComponent.Get();
+	if (!Renderer) return;
+
+	if (bPooled || !LevelUpVisuals || !MeshComponent)
+	{
+		Renderer->RemoveInstance(this);
+		return;
+	}
+	// Placed at the mesh's current transform, a reactivated actor has moved since its instance was removed
+	if (InstancedMeshLevel != INDEX_NONE)
+	{
+		Renderer->SetInstanceLevel(this, LevelUpVisuals, MeshComponent->GetComponentTransform(), InstancedMeshLevel);
+	}
+	if (InstancedDataLevel != INDEX_NONE && LevelUpVisuals->VisualsMode == EUpgradeVisualsMode::CustomPrimitiveData)
+	{
+		TArray<float> CustomData;
+		LevelUpVisuals->GetCustomDataForLevel(InstancedDataLevel, CustomData);
+		Renderer->SetInstanceCustomData(this, LevelUpVisuals->CustomDataStartIndex, CustomData);
+	}
+}
+
+void UUpgradableComponent::PrefetchLevelVisuals(int32 Level)
+{
+	ULevelUpVisualsStreamer* Streamer = GetWorld() ? GetWorld()->GetSubsystem<ULevelUpVisualsStreamer>() : nullptr;
+	if (!LevelUpVisuals || !Streamer || Level == PrefetchedVisualsLevel) return;
+
+	// The upgrade duration is the deadline, so the target level streams at normal priority
+	if (Level != INDEX_NONE)
+	{
+		Streamer->AcquireLevel(LevelUpVisuals, Level, /*bHighPriority=*/false, FSimpleDelegate::CreateWeakLambda(this, [this, Level]()
+		{
+			// The level-up effect gets its pooled components before the upgrade completes
+			ULevelUpEffectsSubsystem* Effects = GetWorld()->GetSubsystem<ULevelUpEffectsSubsystem>();
+			if (Effects && LevelUpVisuals)
+			{
+				Effects->PrewarmSystem(LevelUpVisuals->GetLoadedNiagaraSystem(Level));
+			}
+		}));
+	}
+	if (PrefetchedVisualsLevel != INDEX_NONE)
+	{
+		Streamer->ReleaseLevel(LevelUpVisuals, PrefetchedVisualsLevel);
+	}
+	PrefetchedVisualsLevel = Level;
+}
+
+void UUpgradableComponent::ReleaseLevelVisuals()
+{
+	ULevelUpVisualsStreamer* Streamer = GetWorld() ? GetWorld()->GetSubsystem<ULevelUpVisualsStreamer>() : nullptr;
+	if (LevelUpVisuals && Streamer)
+	{
+		for (const int32 Level : { AppliedVisualsLevel, PendingVisualsLevel, PrefetchedVisualsLevel, EffectStreamingLevel })
+		{
+			if (Level != INDEX_NONE)
+			{
+				Streamer->ReleaseLevel(LevelUpVisuals, Level);
+			}
+		}
+	}
+	AppliedVisualsLevel = INDEX_NONE;
+	PendingVisualsLevel = INDEX_NONE;
+	PrefetchedVisualsLevel = INDEX_NONE;
+	EffectStreamingLevel = INDEX_NONE;
+	PendingEffectLevel = INDEX_NONE;
+}
 
 void UUpgradableComponent::Client_SetLevel_Implementation(int32 NewLevel)
 {
 	const int32 OldLevel = LocalLevel;
 	LocalLevel = NewLevel;
+	// Set before the broadcast, listeners applying the level's visuals play the effect once the visuals are applied
+	PendingEffectLevel = bPlayLevelUpEffect && NewLevel > OldLevel ? NewLevel : INDEX_NONE;
 	OnLevelChanged.Broadcast(OldLevel, LocalLevel);
+	NotifyStateChanged();
+
+	if (PendingEffectLevel == INDEX_NONE) return;
+
+	// Nobody shows the level's visuals, so nothing streams its Niagara system in either
+	const UUpgradeVisualsQueue* VisualsQueue = GetWorld()->GetSubsystem<UUpgradeVisualsQueue>();
+	const bool bVisualsPending = PendingVisualsLevel == NewLevel || (VisualsQueue && VisualsQueue->GetQueuedLevel(this) == NewLevel);
+	if (!bVisualsPending)
+	{
+		StreamLevelUpEffect(NewLevel);
+	}
 }
 
-void UUpgradableComponent::RequestUpgrade(int32 LevelIncrease, const TArray<FName>& AvailableResourcesNames, const TArray<int32>& AvailableResourceAmounts)
+void UUpgradableComponent::PlayPendingLevelUpEffect(int32 Level)
 {
-	Server_RequestUpgrade(LevelIncrease, AvailableResourcesNames, AvailableResourceAmounts);
+	if (PendingEffectLevel != Level) return;
+
+	PendingEffectLevel = INDEX_NONE;
+	if (ULevelUpEffectsSubsystem* Effects = GetWorld()->GetSubsystem<ULevelUpEffectsSubsystem>())
+	{
+		Effects->PlayLevelUpEffectForComponent(this, Level);
+	}
+}
+
+void UUpgradableComponent::StreamLevelUpEffect(int32 Level)
+{
+	ULevelUpVisualsStreamer* Streamer = GetWorld()->GetSubsystem<ULevelUpVisualsStreamer>();
+	if (!LevelUpVisuals || !Streamer)
+	{
+		PendingEffectLevel = INDEX_NONE;
+		return;
+	}
+
+	if (EffectStreamingLevel != INDEX_NONE)
+	{
+		Streamer->ReleaseLevel(LevelUpVisuals, EffectStreamingLevel);
+	}
+	// Set before acquiring, resident assets call back right away
+	EffectStreamingLevel = Level;
+	Streamer->AcquireLevel(LevelUpVisuals, Level, /*bHighPriority=*/true, FSimpleDelegate::CreateWeakLambda(this, [this, Level]()
+	{
+		PlayPendingLevelUpEffect(Level);
+		// The reference only kept the system resident until it played, the effect component holds it from here
+		ULevelUpVisualsStreamer* LoadedStreamer = GetWorld()->GetSubsystem<ULevelUpVisualsStreamer>();
+		if (LoadedStreamer && EffectStreamingLevel == Level)
+		{
+			EffectStreamingLevel = INDEX_NONE;
+			LoadedStreamer->ReleaseLevel(LevelUpVisuals, Level);
+		}
+	}));
+}
+
+void UUpgradableComponent::NotifyStateChanged() const
+{
+	if (UUpgradeManagerSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UUpgradeManagerSubsystem>() : nullptr)
+	{
+		Subsystem->OnUpgradableStateChanged.Broadcast(UpgradableID);
+	}
+}
+
+void UUpgradableComponent::RequestUpgrade(int32 LevelIncrease)
+{
+	// Level increases travel as a single byte
+	if (LevelIncrease <= 0 || LevelIncrease > MAX_uint8)
+	{
+		UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADECOMP_ERR_00] Invalid level increase %d requested on %s"), LevelIncrease, *GetName());
+		return;
+	}
+
+	// The server needs neither the RPC nor the batcher, which belongs to a client's connection
+	if (GetOwner() && GetOwner()->HasAuthority())
+	{
+		HandleUpgradeOnServer(LevelIncrease);
+		return;
+	}
+
+	// Coalesced with every other request of this frame when the local player controller has a batcher
+	UUpgradeRequestBatcherComponent* Batcher = UUpgradeRequestBatcherComponent::FindLocalBatcher(GetWorld());
+	if (Batcher && UpgradableID != -1)
+	{
+		Batcher->QueueUpgrade(this, LevelIncrease);
+		return;
+	}
+	Server_RequestUpgrade(static_cast<uint8>(LevelIncrease));
 }
 
 void UUpgradableComponent::ChangeActorVisualsPerUpgradeLevel(int32 Level, UStaticMeshComponent* StaticMeshComponent,
 							     USkeletalMeshComponent* SkeletalComponent)
+{
+	ULevelUpVisualsStreamer* Streamer = GetWorld() ? GetWorld()->GetSubsystem<ULevelUpVisualsStreamer>() : nullptr;
+	if (!LevelUpVisuals || !Streamer) return;
+
+	// The instance moves to the level's batch, the batch streams its own mesh. Levels without a mesh keep the current one.
+	UUpgradableInstanceRenderer* Renderer = GetWorld()->GetSubsystem<UUpgradableInstanceRenderer>();
+	if (bUseInstancedRendering && Renderer && StaticMeshComponent)
+	{
+		InstancedMeshComponent = StaticMeshComponent;
+		if (LevelUpVisuals->StaticMeshPerLevel.Contains(Level))
+		{
+			InstancedMeshLevel = Level;
+			StaticMeshComponent->SetVisibility(false);
+		}
+		InstancedDataLevel = Level;
+		// While pooled only the levels are kept, the instance is added back on reactivation
+		UpdateRenderedInstance();
+		StaticMeshComponent = nullptr;
+	}
+
+	// Set before acquiring, resident assets call back right away
+	const int32 SupersededLevel = PendingVisualsLevel;
+	PendingVisualsLevel = Level;
+
+	TWeakObjectPtr<UStaticMeshComponent> WeakStaticMesh(StaticMeshComponent);
+	TWeakObjectPtr<USkeletalMeshComponent> WeakSkeletalMesh(SkeletalComponent);
+	Streamer->AcquireLevel(LevelUpVisuals, Level, /*bHighPriority=*/true, FSimpleDelegate::CreateWeakLambda(this,
+		[this, Level, WeakStaticMesh, WeakSkeletalMesh]()
+		{
+			// A later call asked for another level while this one was streaming
+			if (PendingVisualsLevel != Level) return;
+
+			ApplyLevelVisuals(Level, WeakStaticMesh.Get(), WeakSkeletalMesh.Get());
+			if (ULevelUpVisualsStreamer* LoadedStreamer = GetWorld()->GetSubsystem<ULevelUpVisualsStreamer>(); LoadedStreamer && AppliedVisualsLevel != INDEX_NONE)
+			{
+				LoadedStreamer->ReleaseLevel(LevelUpVisuals, AppliedVisualsLevel);
+			}
+			AppliedVisualsLevel = Level;
+			PendingVisualsLevel = INDEX_NONE;
+			PlayPendingLevelUpEffect(Level);
+			OnVisualLevelApplied.Broadcast(Level);
+		}));
+
+	if (SupersededLevel != INDEX_NONE)
+	{
+		Streamer->ReleaseLevel(LevelUpVisuals, SupersededLevel);
+	}
+	// The prefetch did its job, the reference taken above keeps the level resident
+	if (PrefetchedVisualsLevel == Level)
+	{
+		Streamer->ReleaseLevel(LevelUpVisuals, Level);
+		PrefetchedVisualsLevel = INDEX_NONE;
+	}
+}
+
+void UUpgradableComponent::QueueActorVisualsPerUpgradeLevel(int32 Level, UStaticMeshComponent* StaticMeshComponent,
+							     USkeletalMeshComponent* SkeletalComponent)
+{
+	if (UUpgradeVisualsQueue* VisualsQueue = GetWorld()->GetSubsystem<UUpgradeVisualsQueue>())
+	{
+		VisualsQueue->Enqueue(this, Level, StaticMeshComponent, SkeletalComponent);
+		return;
+	}
+	ChangeActorVisualsPerUpgradeLevel(Level, StaticMeshComponent, SkeletalComponent);
+}
+
+void UUpgradableComponent::ApplyLevelVisuals(int32 Level, UStaticMeshComponent* StaticMeshComponent,
+							     USkeletalMeshComponent* SkeletalComponent) const
 {
 	if (StaticMeshComponent && LevelUpVisuals->StaticMeshPerLevel.Contains(Level))
 	{
-		StaticMeshComponent->SetStaticMesh(LevelUpVisuals->StaticMeshPerLevel[Level]);
+		StaticMeshComponent->SetStaticMesh(LevelUpVisuals->StaticMeshPerLevel[Level].Get());
 	
 	}
 
 	if (SkeletalComponent && LevelUpVisuals->SkeletalMeshPerLevel.Contains(Level))
 	{
-		SkeletalComponent->SetSkeletalMesh(LevelUpVisuals->SkeletalMeshPerLevel[Level]);
+		SkeletalComponent->SetSkeletalMesh(LevelUpVisuals->SkeletalMeshPerLevel[Level].Get());
 	}
 	
-	if (LevelUpVisuals->MaterialSwapsPerLevel.Contains(Level))
+	if (LevelUpVisuals->VisualsMode == EUpgradeVisualsMode::CustomPrimitiveData)
+	{
+		// Same material on every level, only the floats it reads change
+		TArray<float> CustomData;
+		LevelUpVisuals->GetCustomDataForLevel(Level, CustomData);
+		for (UPrimitiveComponent* Primitive : { static_cast<UPrimitiveComponent*>(StaticMeshComponent), static_cast<UPrimitiveComponent*>(SkeletalComponent) })
+		{
+			if (!Primitive) continue;
+			for (int32 i = 0; i < CustomData.Num(); ++i)
+			{
+				Primitive->SetCustomPrimitiveDataFloat(LevelUpVisuals->CustomDataStartIndex + i, CustomData[i]);
+			}
+		}
+	}
+	else if (LevelUpVisuals->MaterialSwapsPerLevel.Contains(Level))
 	{
 		const FMaterialSwapList* SwapList = LevelUpVisuals->MaterialSwapsPerLevel.Find(Level);
 		for (const FMaterialSwapInfo& SwapInfo : SwapList->MaterialSwaps)
 		{
-			if (SwapInfo.Material == nullptr || SwapInfo.MaterialSlot < 0)
+			UMaterialInterface* Material = SwapInfo.Material.Get();
+			if (Material == nullptr || SwapInfo.MaterialSlot < 0)
 				continue;
 
 			switch (SwapInfo.MeshForMaterialSwap)
@@ -79,7 +393,7 @@ void UUpgradableComponent::ChangeActorVisualsPerUpgradeLevel(int32 Level, UStati
 				if (StaticMeshComponent)
 				{
 					StaticMeshComponent->SetMaterial(
-						SwapInfo.MaterialSlot, SwapInfo.Material);
+						SwapInfo.MaterialSlot, Material);
 				}
 				break;
 
@@ -87,7 +401,7 @@ void UUpgradableComponent::ChangeActorVisualsPerUpgradeLevel(int32 Level, UStati
 				if (SkeletalComponent)
 				{
 					SkeletalComponent->SetMaterial(
-						SwapInfo.MaterialSlot, SwapInfo.Material);
+						SwapInfo.MaterialSlot, Material);
 				}
 				break;
 
@@ -98,29 +412,39 @@ void UUpgradableComponent::ChangeActorVisualsPerUpgradeLevel(int32 Level, UStati
 	}
 }
 
-bool UUpgradableComponent::Server_RequestUpgrade_Validate(int32 LevelIncrease, const TArray<FName>& AvailableResourcesNames, const TArray<int32>& AvailableResourceAmounts) { return true; }
+bool UUpgradableComponent::Server_RequestUpgrade_Validate(uint8 LevelIncrease) { return LevelIncrease > 0; }
+
+void UUpgradableComponent::Server_RequestUpgrade_Implementation(uint8 LevelIncrease)
+{
+	// Budget check before any catalog or wallet work
+	URequestRateLimiterSubsystem* RateLimiter = GetWorld()->GetSubsystem<URequestRateLimiterSubsystem>();
+	if (RateLimiter && !RateLimiter->TryConsume(this, ERateLimitedRequest::Upgrade)) return;
+
+	HandleUpgradeOnServer(LevelIncrease);
+}
 
-void UUpgradableComponent::Server_RequestUpgrade_Implementation(int32 LevelIncrease, const TArray<FName>& AvailableResourcesNames, const TArray<int32>& AvailableResourceAmounts)
+void UUpgradableComponent::HandleUpgradeOnServer(int32 LevelIncrease)
 {
-	if (UUpgradeManagerSubsystem* Subsystem = GetWorld()->GetSubsystem<UUpgradeManagerSubsystem>())
+	UUpgradeManagerSubsystem* Subsystem = GetWorld()->GetSubsystem<UUpgradeManagerSubsystem>();
+	UResourceManagerSubsystem* ResourceSubsystem = GetWorld()->GetSubsystem<UResourceManagerSubsystem>();
+	if (Subsystem && ResourceSubsystem)
 	{
-		TMap<FName, int32> AvailableResources;
-		for ( int32 i = 0; i < AvailableResourcesNames.Num(); ++i)
-		{
-			AvailableResources.Add(AvailableResourcesNames[i], AvailableResourceAmounts[i]);
-		}
-		Subsystem->HandleUpgradeRequest(UpgradableID, LevelIncrease, AvailableResources);
+		// The wallet is resolved on the server from the owner chain, clients never state what they can afford
+		UResourceSystemComponent* Wallet = ResourceSubsystem->FindResourceComponentForActor(GetOwner());
+		Subsystem->HandleUpgradeRequest(UpgradableID, LevelIncrease, Wallet);
 	}
 }
 
 void UUpgradableComponent::Client_OnUpgradeStarted_Implementation(float SecondsUntilCompleted)
 {
 	OnUpgradeStarted.Broadcast(SecondsUntilCompleted);
+	NotifyStateChanged();
 }
 
 void UUpgradableComponent::Client_OnUpgradeCanceled_Implementation(int32 CurrentLevel)
 {
 	OnUpgradeCanceled.Broadcast(CurrentLevel);
+	NotifyStateChanged();
 }
 
 void UUpgradableComponent::Client_OnTimeToUpgradeChanged_Implementation(float DeltaTime)
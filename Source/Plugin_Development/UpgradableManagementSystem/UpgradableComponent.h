@@ -12,6 +12,7 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnLevelChangedDelegate, int32, Old
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnUpgradeStartedDelegate, float, SecondsUntilCompleted);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnUpgradeCanceledDelegate, int32, CurrentLevel);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTimeToUpgradeChangedDelegate, float, DeltaTime);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnVisualLevelAppliedDelegate, int32, Level);
 
 UCLASS( ClassGroup=(Custom), Blueprintable, meta=(BlueprintSpawnableComponent) )
 class PLUGIN_DEVELOPMENT_API UUpgradableComponent : public UActorComponent
@@ -33,6 +34,10 @@ public:
 
 	UPROPERTY(BlueprintAssignable, Category = "Upgradable Component")
 	FOnTimeToUpgradeChangedDelegate OnTimeToUpgradeChanged;
+
+	/** Fired once a level's visuals are streamed in and applied, e.g. to spawn its Niagara effect. Not for superseded levels. */
+	UPROPERTY(BlueprintAssignable, Category = "Upgradable Component|Visuals")
+	FOnVisualLevelAppliedDelegate OnVisualLevelApplied;
 	
 	// Unique identifier for this upgrade path
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Upgradable Component")
@@ -51,12 +56,38 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Upgradable Component")
 	int32 GetComponentId() const { return UpgradableID; }
 	
+	/** Asks the server to upgrade this component. The cost is taken from the owning player's wallet on the server. */
 	UFUNCTION(BlueprintCallable, Category="Upgradable Component")
-	void RequestUpgrade(int32 LevelIncrease, const TArray<FName>& AvailableResourcesNames, const TArray<int32>& AvailableResourceAmounts);
+	void RequestUpgrade(int32 LevelIncrease);
 
 	UFUNCTION(BlueprintCallable, Category="Upgradable Component")
 	int32 GetCurrentUpgradeLevel() const { return LocalLevel; }
 
+	UFUNCTION(BlueprintPure, Category="Upgradable Component|Visuals")
+	UOnLeveUpVisualsDataAsset* GetLevelUpVisuals() const { return LevelUpVisuals; }
+
+	/** Seconds until the running upgrade completes, measured on the server clock. -1 if no upgrade is running. */
+	UFUNCTION(BlueprintPure, Category="Upgradable Component")
+	float GetUpgradeTimeRemaining() const;
+
+	/** Server world time the running upgrade completes at, 0 if none is running */
+	double GetUpgradeEndServerTime() const { return UpgradeEndServerTime; }
+
+	/** Full duration of the running upgrade */
+	float GetUpgradeTotalTime() const { return UpgradeTotalTime; }
+
+	/**
+	 * Server only. Replicates when the running upgrade completes, EndServerTime 0 clears it.
+	 * @param TargetLevel - Level the upgrade leads to, its visuals are prefetched. INDEX_NONE after a cancel.
+	 */
+	void SetUpgradeSchedule(double EndServerTime, float TotalTime, int32 TargetLevel);
+
+	/**
+	 * Server only, called by the spawn system when the owner is put into or taken out of its pool.
+	 * Pooled components remove their instance from UUpgradableInstanceRenderer, reactivated ones add it back.
+	 */
+	void SetPooled(bool bInPooled);
+
 	/**
 	 * Updates the actor’s meshes and materials to match a given upgrade level.
 	 *
@@ -65,6 +96,10 @@ public:
 	 *   • Swap in the skeletal mesh for the specified level.
 	 *   • Apply any material swaps for that level across both static and skeletal meshes.
 	 *
+	 * The level's assets are streamed in first and applied once loaded, usually right away since they were prefetched
+	 * when the upgrade started. The previous level stays on screen until then and is released afterwards.
+	 * OnVisualLevelApplied fires once the level is applied.
+	 *
 	 * @param Level                     The upgrade level whose visuals should be applied.
 	 * @param StaticMeshComponent       Optional static mesh component to update.
 	 * @param SkeletalComponent			Optional skeletal mesh component to update.
@@ -72,6 +107,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Upgradable Component|Visuals")
 	void ChangeActorVisualsPerUpgradeLevel (int32 Level, UStaticMeshComponent* StaticMeshComponent,
 						USkeletalMeshComponent* SkeletalComponent);
+
+	/**
+	 * Like ChangeActorVisualsPerUpgradeLevel, but applied by UUpgradeVisualsQueue within a per-frame budget, visible and
+	 * near actors first. Far, unseen actors wait until they become relevant. Queuing again before the level was applied
+	 * replaces it, intermediate levels are never shown. OnVisualLevelApplied fires once the level is applied.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Upgradable Component|Visuals")
+	void QueueActorVisualsPerUpgradeLevel(int32 Level, UStaticMeshComponent* StaticMeshComponent,
+						USkeletalMeshComponent* SkeletalComponent);
 	
 	UFUNCTION(Client, Reliable)
 	void Client_SetLevel(int32 NewLevel);
@@ -97,13 +141,48 @@ protected:
 	// Data Asset definitions to be used for changing actor's mesh and materials per level
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Upgradable Component|Visuals")
 	UOnLeveUpVisualsDataAsset* LevelUpVisuals;
+
+	// Draws the static mesh through UUpgradableInstanceRenderer, batched with every upgradable showing the same level.
+	// The actor's own static mesh component is hidden and only kept for collision. For many identical, unmoving buildings.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Upgradable Component|Visuals")
+	bool bUseInstancedRendering = false;
+
+	// Plays the new level's Niagara system through ULevelUpEffectsSubsystem whenever the level goes up, no Blueprint needed.
+	// Played once the level's visuals are applied, or once its assets streamed in if nothing applies them.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Upgradable Component|Visuals")
+	bool bPlayLevelUpEffect = false;
 	
-	UPROPERTY()
+	// Replicated so clients can reference this component by ID in batched requests and find it through the manager
+	UPROPERTY(ReplicatedUsing=OnRep_UpgradableID)
 	int32 UpgradableID = -1;
+
+	UFUNCTION()
+	void OnRep_UpgradableID(int32 OldUpgradableID);
 	
 	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Upgradable Component")
 	int32 LocalLevel = 0;
 
+	// Absolute, so every client counts down against the same server clock instead of accumulating its own drift
+	UPROPERTY(Replicated)
+	double UpgradeEndServerTime = 0.0;
+
+	UPROPERTY(Replicated)
+	float UpgradeTotalTime = 0.f;
+
+	// Level the running or last upgrade leads to, INDEX_NONE after a cancel. Clients prefetch its visuals.
+	UPROPERTY(ReplicatedUsing=OnRep_UpgradeTargetLevel)
+	int32 UpgradeTargetLevel = INDEX_NONE;
+
+	UFUNCTION()
+	void OnRep_UpgradeTargetLevel();
+
+	// Replicated so clients drop the instance of a pooled actor as well
+	UPROPERTY(ReplicatedUsing=OnRep_Pooled)
+	bool bPooled = false;
+
+	UFUNCTION()
+	void OnRep_Pooled();
+
 	// Upgradable category that this component (and actor) belongs to
 	UPROPERTY(Blueprintable, BlueprintReadWrite, EditAnywhere, Category = "Upgradable Component")
 	EUpgradableCategory Category = EUpgradableCategory::None;
@@ -115,13 +194,50 @@ protected:
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-	// virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	UFUNCTION(Server, Reliable, WithValidation)
-	void Server_RequestUpgrade(int32 LevelIncrease, const TArray<FName>& AvailableResourcesNames, const TArray<int32>& AvailableResourceAmounts);
-	void Server_RequestUpgrade_Implementation(int32 LevelIncrease, const TArray<FName>& AvailableResourcesNames, const TArray<int32>& AvailableResourceAmounts);
-	bool Server_RequestUpgrade_Validate(int32 LevelIncrease, const TArray<FName>& AvailableResourcesNames, const TArray<int32>& AvailableResourceAmounts);
+	void Server_RequestUpgrade(uint8 LevelIncrease);
+	void Server_RequestUpgrade_Implementation(uint8 LevelIncrease);
+	bool Server_RequestUpgrade_Validate(uint8 LevelIncrease);
 
 private:
 
+	/** Broadcasts UUpgradeManagerSubsystem::OnUpgradableStateChanged for this component */
+	void NotifyStateChanged() const;
+
+	/** Hands the upgrade to the manager, paid from the wallet found through the owner chain. Server only. */
+	void HandleUpgradeOnServer(int32 LevelIncrease);
+
+	/** Levels of LevelUpVisuals this component holds a streaming reference for, INDEX_NONE if none */
+	int32 AppliedVisualsLevel = INDEX_NONE;
+	int32 PendingVisualsLevel = INDEX_NONE;
+	int32 PrefetchedVisualsLevel = INDEX_NONE;
+
+	/** Moves the prefetch reference to Level, INDEX_NONE drops it */
+	void PrefetchLevelVisuals(int32 Level);
+
+	/** Swaps meshes and materials of a level whose assets are loaded */
+	void ApplyLevelVisuals(int32 Level, UStaticMeshComponent* StaticMeshComponent, USkeletalMeshComponent* SkeletalComponent) const;
+
+	void ReleaseLevelVisuals();
+
+	/** Level whose effect waits for its assets, and the level streamed only for the effect, INDEX_NONE if none */
+	int32 PendingEffectLevel = INDEX_NONE;
+	int32 EffectStreamingLevel = INDEX_NONE;
+
+	/** Plays the level-up effect if it is still waiting for Level */
+	void PlayPendingLevelUpEffect(int32 Level);
+
+	/** Streams Level's assets for a component that does not show its visuals, and plays the effect once loaded */
+	void StreamLevelUpEffect(int32 Level);
+
+	/** Static mesh component drawn through UUpgradableInstanceRenderer, and the levels its instance shows */
+	TWeakObjectPtr<UStaticMeshComponent> InstancedMeshComponent;
+	int32 InstancedMeshLevel = INDEX_NONE;
+	int32 InstancedDataLevel = INDEX_NONE;
+
+	/** Adds or moves the instance to match the levels above, removes it while pooled */
+	void UpdateRenderedInstance();
+
 };
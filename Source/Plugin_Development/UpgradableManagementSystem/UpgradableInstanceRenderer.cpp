@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "UpgradableInstanceRenderer.h"
+#include "UpgradableComponent.h"
+#include "UpgradeManagerSubsystem.h"
+#include "LeveUpVisualsDataAsset.h"
+#include "LevelUpVisualsStreamer.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/World.h"
+
+bool UUpgradableInstanceRenderer::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return !IsRunningDedicatedServer() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UUpgradableInstanceRenderer::SetInstanceLevel(UUpgradableComponent* Component, const UOnLeveUpVisualsDataAsset* Visuals, const FTransform& Transform, int32 Level)
+{
+	if (!Component || !Visuals) return;
+
+	const FBatchKey Key(Visuals, Level);
+	if (const FInstanceLocation* Existing = Instances.Find(Component))
+	{
+		if (Existing->Batch == Key) return;
+		RemoveInstance(Component);
+	}
+
+	FInstanceBatch& Batch = FindOrAddBatch(Visuals, Level);
+	UHierarchicalInstancedStaticMeshComponent* Mesh = Batch.Mesh.Get();
+	if (!Mesh) return;
+
+	FInstanceLocation& Location = Instances.Add(Component);
+	Location.Batch = Key;
+	Location.Index = Mesh->AddInstance(Transform, /*bWorldSpace=*/true);
+	Batch.Owners.Add(Component);
+	check(Batch.Owners.Num() - 1 == Location.Index);
+}
+
+void UUpgradableInstanceRenderer::SetInstanceCustomData(const UUpgradableComponent* Component, int32 StartIndex, TConstArrayView<float> Data)
+{
+	const FInstanceLocation* Location = Instances.Find(Component);
+	const FInstanceBatch* Batch = Location ? Batches.Find(Location->Batch) : nullptr;
+	UHierarchicalInstancedStaticMeshComponent* Mesh = Batch ? Batch->Mesh.Get() : nullptr;
+	if (!Mesh) return;
+
+	for (int32 i = 0; i < Data.Num() && StartIndex + i < Mesh->NumCustomDataFloats; ++i)
+	{
+		Mesh->SetCustomDataValue(Location->Index, StartIndex + i, Data[i], /*bMarkRenderStateDirty=*/false);
+	}
+	Mesh->MarkRenderStateDirty();
+}
+
+void UUpgradableInstanceRenderer::RemoveInstance(const UUpgradableComponent* Component)
+{
+	FInstanceLocation Location;
+	if (!Instances.RemoveAndCopyValue(Component, Location)) return;
+
+	FInstanceBatch* Batch = Batches.Find(Location.Batch);
+	if (!Batch) return;
+
+	// Swap remove: the last instance takes the freed index, so no other instance changes index
+	const int32 LastIndex = Batch->Owners.Num() - 1;
+	if (UHierarchicalInstancedStaticMeshComponent* Mesh = Batch->Mesh.Get())
+	{
+		if (Location.Index != LastIndex)
+		{
+			FTransform LastTransform;
+			Mesh->GetInstanceTransform(LastIndex, LastTransform, /*bWorldSpace=*/true);
+			Mesh->UpdateInstanceTransform(Location.Index, LastTransform, /*bWorldSpace=*/true, /*bMarkRenderStateDirty=*/false);
+
+			const int32 NumFloats = Mesh->NumCustomDataFloats;
+			if (NumFloats > 0)
+			{
+				TArray<float> LastCustomData(&Mesh->PerInstanceSMCustomData[LastIndex * NumFloats], NumFloats);
+				Mesh->SetCustomData(Location.Index, LastCustomData, /*bMarkRenderStateDirty=*/false);
+			}
+		}
+		Mesh->RemoveInstance(LastIndex);
+	}
+	Batch->Owners.RemoveAtSwap(Location.Index);
+	if (Batch->Owners.IsValidIndex(Location.Index))
+	{
+		Instances.FindChecked(Batch->Owners[Location.Index]).Index = Location.Index;
+	}
+
+	if (Batch->Owners.Num() == 0)
+	{
+		if (UHierarchicalInstancedStaticMeshComponent* Mesh = Batch->Mesh.Get())
+		{
+			Mesh->DestroyComponent();
+		}
+		ULevelUpVisualsStreamer* Streamer = GetWorld()->GetSubsystem<ULevelUpVisualsStreamer>();
+		if (Streamer && Batch->Visuals.IsValid())
+		{
+			Streamer->ReleaseLevel(Batch->Visuals.Get(), Location.Batch.Value);
+		}
+		Batches.Remove(Location.Batch);
+	}
+}
+
+UUpgradableInstanceRenderer::FInstanceBatch& UUpgradableInstanceRenderer::FindOrAddBatch(const UOnLeveUpVisualsDataAsset* Visuals, int32 Level)
+{
+	const FBatchKey Key(Visuals, Level);
+	if (FInstanceBatch* Existing = Batches.Find(Key))
+	{
+		return *Existing;
+	}
+
+	if (!BatchHost)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		BatchHost = GetWorld()->SpawnActor<AActor>(SpawnParams);
+		USceneComponent* Root = NewObject<USceneComponent>(BatchHost, TEXT("Root"));
+		BatchHost->SetRootComponent(Root);
+		Root->RegisterComponent();
+	}
+
+	UHierarchicalInstancedStaticMeshComponent* Mesh = NewObject<UHierarchicalInstancedStaticMeshComponent>(BatchHost);
+	Mesh->SetupAttachment(BatchHost->GetRootComponent());
+	// The actors keep their own hidden components for collision
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Mesh->SetNumCustomDataFloats(Visuals->GetInstanceCustomDataCount());
+	Mesh->RegisterComponent();
+	BatchHost->AddInstanceComponent(Mesh);
+
+	FInstanceBatch& Batch = Batches.Add(Key);
+	Batch.Mesh = Mesh;
+	Batch.Visuals = Visuals;
+
+	// One streaming reference per batch, held until the batch empties
+	if (ULevelUpVisualsStreamer* Streamer = GetWorld()->GetSubsystem<ULevelUpVisualsStreamer>())
+	{
+		Streamer->AcquireLevel(Visuals, Level, /*bHighPriority=*/true,
+			FSimpleDelegate::CreateUObject(this, &UUpgradableInstanceRenderer::ApplyBatchVisuals, Key));
+	}
+	if (UE_LOG_ACTIVE(LogUpgradeSystem, Verbose))
+	{
+		UE_LOG(LogUpgradeSystem, Verbose, TEXT("[INSTANCERENDER_INFO_01] Created batch for %s level %d. %d batch(es)"), *Visuals->GetName(), Level, Batches.Num());
+	}
+	return Batch;
+}
+
+void UUpgradableInstanceRenderer::ApplyBatchVisuals(FBatchKey Key)
+{
+	const FInstanceBatch* Batch = Batches.Find(Key);
+	UHierarchicalInstancedStaticMeshComponent* Mesh = Batch ? Batch->Mesh.Get() : nullptr;
+	const UOnLeveUpVisualsDataAsset* Visuals = Batch ? Batch->Visuals.Get() : nullptr;
+	if (!Mesh || !Visuals) return;
+
+	const int32 Level = Key.Value;
+	Mesh->SetStaticMesh(Visuals->StaticMeshPerLevel.FindRef(Level).Get());
+	const FMaterialSwapList* SwapList = Visuals->VisualsMode == EUpgradeVisualsMode::MaterialSwaps ? Visuals->MaterialSwapsPerLevel.Find(Level) : nullptr;
+	if (SwapList)
+	{
+		for (const FMaterialSwapInfo& SwapInfo : SwapList->MaterialSwaps)
+		{
+			if (SwapInfo.MeshForMaterialSwap == EMeshForMaterialSwap::StaticMesh && SwapInfo.MaterialSlot >= 0)
+			{
+				Mesh->SetMaterial(SwapInfo.MaterialSlot, SwapInfo.Material.Get());
+			}
+		}
+	}
+}
+
+void UUpgradableInstanceRenderer::Deinitialize()
+{
+	if (ULevelUpVisualsStreamer* Streamer = GetWorld()->GetSubsystem<ULevelUpVisualsStreamer>())
+	{
+		for (const TPair<FBatchKey, FInstanceBatch>& Pair : Batches)
+		{
+			if (Pair.Value.Visuals.IsValid())
+			{
+				Streamer->ReleaseLevel(Pair.Value.Visuals.Get(), Pair.Key.Value);
+			}
+		}
+	}
+	Batches.Empty();
+	Instances.Empty();
+	if (IsValid(BatchHost))
+	{
+		BatchHost->Destroy();
+		BatchHost = nullptr;
+	}
+	Super::Deinitialize();
+}
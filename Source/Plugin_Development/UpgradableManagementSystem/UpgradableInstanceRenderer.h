@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UpgradableInstanceRenderer.generated.h"
+
+class UHierarchicalInstancedStaticMeshComponent;
+class UOnLeveUpVisualsDataAsset;
+class UUpgradableComponent;
+
+/**
+ * Draws the static meshes of upgradables with bUseInstancedRendering through one hierarchical instanced static mesh
+ * per (visuals asset, level), so hundreds of identical buildings cost one batch per distinct level instead of one per
+ * actor. The actors keep their own, hidden, mesh components for collision.
+ *
+ * Instances are placed once at the actor's transform and are meant for upgradables that do not move. A level change
+ * moves the instance to the batch of the new level.
+ */
+UCLASS()
+class PLUGIN_DEVELOPMENT_API UUpgradableInstanceRenderer : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Adds Component's instance to the batch of Level, moving it out of its previous batch */
+	void SetInstanceLevel(UUpgradableComponent* Component, const UOnLeveUpVisualsDataAsset* Visuals, const FTransform& Transform, int32 Level);
+
+	void RemoveInstance(const UUpgradableComponent* Component);
+
+	/** Writes Data to Component's per-instance custom data from StartIndex on. Only for visuals in CustomPrimitiveData mode. */
+	void SetInstanceCustomData(const UUpgradableComponent* Component, int32 StartIndex, TConstArrayView<float> Data);
+
+	/** Distinct (visuals, level) batches, i.e. instanced draws */
+	int32 GetBatchCount() const { return Batches.Num(); }
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+private:
+	using FBatchKey = TPair<TObjectKey<UOnLeveUpVisualsDataAsset>, int32>;
+
+	struct FInstanceBatch
+	{
+		/** Owned by BatchHost */
+		TWeakObjectPtr<UHierarchicalInstancedStaticMeshComponent> Mesh;
+
+		TWeakObjectPtr<const UOnLeveUpVisualsDataAsset> Visuals;
+
+		/** Component of each instance, by instance index */
+		TArray<TObjectKey<UUpgradableComponent>> Owners;
+	};
+
+	struct FInstanceLocation
+	{
+		FBatchKey Batch;
+		int32 Index = INDEX_NONE;
+	};
+
+	TMap<FBatchKey, FInstanceBatch> Batches;
+
+	TMap<TObjectKey<UUpgradableComponent>, FInstanceLocation> Instances;
+
+	/** Transient actor owning the batch components */
+	UPROPERTY()
+	TObjectPtr<AActor> BatchHost;
+
+	FInstanceBatch& FindOrAddBatch(const UOnLeveUpVisualsDataAsset* Visuals, int32 Level);
+
+	/** Sets the streamed in mesh and the level's static mesh material swaps on a batch */
+	void ApplyBatchVisuals(FBatchKey Key);
+};
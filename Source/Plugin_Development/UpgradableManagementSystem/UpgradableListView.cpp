@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "UpgradableListView.h"
+#include "UpgradeManagerSubsystem.h"
+#include "Components/ListView.h"
+
+UUpgradableListEntry::UUpgradableListEntry(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	bBindComponentEvents = false;
+}
+
+void UUpgradableListEntry::NativeOnListItemObjectSet(UObject* ListItemObject)
+{
+	IUserObjectListEntry::NativeOnListItemObjectSet(ListItemObject);
+	RefreshFromComponent();
+}
+
+void UUpgradableListEntry::NativeOnEntryReleased()
+{
+	IUserObjectListEntry::NativeOnEntryReleased();
+
+	StopCountdown();
+	TrackedComponent = nullptr;
+	ComponentId = INDEX_NONE;
+}
+
+void UUpgradableListEntry::RefreshFromComponent()
+{
+	const UUpgradableListItem* Item = GetListItem<UUpgradableListItem>();
+	ComponentId = Item ? Item->ComponentId : INDEX_NONE;
+
+	const UUpgradeManagerSubsystem* Manager = GetWorld() ? GetWorld()->GetSubsystem<UUpgradeManagerSubsystem>() : nullptr;
+	TrackedComponent = Manager ? Manager->GetComponentById(ComponentId) : nullptr;
+	if (!TrackedComponent)
+	{
+		StopCountdown();
+		return;
+	}
+
+	LevelText->SetText(FText::AsNumber(TrackedComponent->GetCurrentUpgradeLevel()));
+	if (TrackedComponent->GetUpgradeEndServerTime() > 0.0)
+	{
+		TotalTime = TrackedComponent->GetUpgradeTotalTime();
+		RemainingTime = TrackedComponent->GetUpgradeTimeRemaining();
+		ShowRemainingTime();
+		StartCountdown();
+	}
+	else
+	{
+		StopCountdown();
+		CountdownText->SetText(FText::AsNumber(0));
+		UpgradeProgress->SetPercent(0.f);
+		TotalTime = -1.f;
+		RemainingTime = -1.f;
+	}
+	OnComponentRefreshed(TrackedComponent);
+}
+
+void UUpgradableOverviewWidget::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	if (UUpgradeManagerSubsystem* Manager = GetWorld() ? GetWorld()->GetSubsystem<UUpgradeManagerSubsystem>() : nullptr)
+	{
+		StateChangedHandle = Manager->OnUpgradableStateChanged.AddUObject(this, &UUpgradableOverviewWidget::HandleUpgradableStateChanged);
+	}
+	RefreshList();
+}
+
+void UUpgradableOverviewWidget::NativeDestruct()
+{
+	if (UUpgradeManagerSubsystem* Manager = GetWorld() ? GetWorld()->GetSubsystem<UUpgradeManagerSubsystem>() : nullptr)
+	{
+		Manager->OnUpgradableStateChanged.Remove(StateChangedHandle);
+	}
+	StateChangedHandle.Reset();
+
+	Super::NativeDestruct();
+}
+
+void UUpgradableOverviewWidget::RefreshList()
+{
+	const UUpgradeManagerSubsystem* Manager = GetWorld() ? GetWorld()->GetSubsystem<UUpgradeManagerSubsystem>() : nullptr;
+	if (!Manager || !UpgradableList) return;
+
+	const APlayerController* OwningPlayer = bOnlyOwnedComponents ? GetOwningPlayer() : nullptr;
+	if (bOnlyOwnedComponents && !OwningPlayer)
+	{
+		ComponentIds.Reset();
+	}
+	else
+	{
+		Manager->GetComponentIdsByAspect(Aspect, LevelFilter, ComponentIds, OwningPlayer);
+	}
+
+	while (ItemPool.Num() < ComponentIds.Num())
+	{
+		ItemPool.Add(NewObject<UUpgradableListItem>(this));
+	}
+
+	TArray<UObject*> Items;
+	Items.Reserve(ComponentIds.Num());
+	ItemsById.Reset();
+	for (int32 i = 0; i < ComponentIds.Num(); ++i)
+	{
+		UUpgradableListItem* Item = ItemPool[i];
+		Item->ComponentId = ComponentIds[i];
+		Items.Add(Item);
+		ItemsById.Add(ComponentIds[i], Item);
+	}
+	UpgradableList->SetListItems(Items);
+
+	// Items were reused for other IDs, rows showing them have to read their component again
+	for (UUserWidget* Row : UpgradableList->GetDisplayedEntryWidgets())
+	{
+		UUpgradableListEntry* Entry = Cast<UUpgradableListEntry>(Row);
+		const UUpgradableListItem* Item = Entry ? Entry->GetListItem<UUpgradableListItem>() : nullptr;
+		if (Item && Item->ComponentId != Entry->GetComponentId())
+		{
+			Entry->RefreshFromComponent();
+		}
+	}
+}
+
+void UUpgradableOverviewWidget::HandleUpgradableStateChanged(int32 ComponentId)
+{
+	// Only rows on screen exist, everything else picks up the new state when it scrolls into view
+	const TObjectPtr<UUpgradableListItem>* Item = ItemsById.Find(ComponentId);
+	if (!Item || !UpgradableList) return;
+
+	if (UUpgradableListEntry* Entry = Cast<UUpgradableListEntry>(UpgradableList->GetEntryWidgetFromItem(*Item)))
+	{
+		Entry->RefreshFromComponent();
+	}
+}
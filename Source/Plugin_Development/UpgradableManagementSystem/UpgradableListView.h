@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/IUserObjectListEntry.h"
+#include "UpgradableComponent.h"
+#include "UpgradeTimerDisplay.h"
+#include "UpgradableListView.generated.h"
+
+class UListView;
+
+/** List item of UUpgradableOverviewWidget. Only carries the ID, the row resolves everything else when it is shown. */
+UCLASS(BlueprintType)
+class PLUGIN_DEVELOPMENT_API UUpgradableListItem : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintReadOnly, Category="Upgrade System")
+	int32 ComponentId = INDEX_NONE;
+};
+
+/**
+ * Row of UUpgradableOverviewWidget, set as the list view's entry class.
+ * Rows are pooled by the list view and only exist for visible items. Showing another item rebinds the row through the
+ * component ID, no component events are bound.
+ */
+UCLASS(Abstract)
+class PLUGIN_DEVELOPMENT_API UUpgradableListEntry : public UUpgradeTimerDisplay, public IUserObjectListEntry
+{
+	GENERATED_BODY()
+
+public:
+	UUpgradableListEntry(const FObjectInitializer& ObjectInitializer);
+
+	UFUNCTION(BlueprintPure, Category="Upgrade System")
+	int32 GetComponentId() const { return ComponentId; }
+
+	/** Resolves the component of the current list item and reads its level and upgrade state */
+	void RefreshFromComponent();
+
+protected:
+	//~ Begin IUserObjectListEntry
+	virtual void NativeOnListItemObjectSet(UObject* ListItemObject) override;
+	virtual void NativeOnEntryReleased() override;
+	//~ End IUserObjectListEntry
+
+	/** Called after the row was bound to a component or refreshed, for anything the Blueprint shows besides the timer */
+	UFUNCTION(BlueprintImplementableEvent, Category="Upgrade System")
+	void OnComponentRefreshed(UUpgradableComponent* Component);
+
+private:
+	int32 ComponentId = INDEX_NONE;
+};
+
+/**
+ * Overview of the local player's upgradables of one aspect, for management screens listing thousands of them.
+ * Backed by UUpgradeManagerSubsystem::GetComponentIdsByAspect, on clients through the components whose ID replicated.
+ * The list view only creates rows for visible items and
+ * recycles them while scrolling. State changes reach the rows through one subscription to
+ * UUpgradeManagerSubsystem::OnUpgradableStateChanged.
+ */
+UCLASS()
+class PLUGIN_DEVELOPMENT_API UUpgradableOverviewWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Upgrade System")
+	EUpgradableAspect Aspect = EUpgradableAspect::Level;
+
+	/** If >= 0, only components at this level are listed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Upgrade System")
+	int32 LevelFilter = -1;
+
+	/**
+	 * Only lists components owned by the owning player of this widget. Clients only receive state updates for those.
+	 * Disable to also list unowned components, e.g. level placed buildings in a standalone game.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Upgrade System")
+	bool bOnlyOwnedComponents = true;
+
+	/** Queries the manager again and replaces the list's items. Rows and item objects are reused. */
+	UFUNCTION(BlueprintCallable, Category="Upgrade System")
+	void RefreshList();
+
+protected:
+	/** Entry class must derive from UUpgradableListEntry */
+	UPROPERTY(BlueprintReadOnly, meta=(BindWidget))
+	TObjectPtr<UListView> UpgradableList;
+
+	virtual void NativeConstruct() override;
+	virtual void NativeDestruct() override;
+
+private:
+	/** Item objects, reused across refreshes and grown to the largest list so far. Item i shows ComponentIds[i], the rest are unused. */
+	UPROPERTY()
+	TArray<TObjectPtr<UUpgradableListItem>> ItemPool;
+
+	/** Item of each listed component */
+	TMap<int32, TObjectPtr<UUpgradableListItem>> ItemsById;
+
+	TArray<int32> ComponentIds;
+
+	FDelegateHandle StateChangedHandle;
+
+	void HandleUpgradableStateChanged(int32 ComponentId);
+};
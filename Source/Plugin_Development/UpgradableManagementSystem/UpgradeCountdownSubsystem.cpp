@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "UpgradeCountdownSubsystem.h"
+#include "UpgradeTimerDisplay.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+
+void UUpgradeCountdownSubsystem::AddDisplay(UUpgradeTimerDisplay* Display)
+{
+	if (Display)
+	{
+		Displays.AddUnique(Display);
+	}
+}
+
+void UUpgradeCountdownSubsystem::RemoveDisplay(UUpgradeTimerDisplay* Display)
+{
+	Displays.RemoveSingleSwap(Display);
+}
+
+void UUpgradeCountdownSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const UWorld* World = GetWorld();
+	const AGameStateBase* GameState = World->GetGameState();
+	const double ServerTime = GameState ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+
+	for (int32 i = Displays.Num() - 1; i >= 0; --i)
+	{
+		UUpgradeTimerDisplay* Display = Displays[i].Get();
+		if (!Display)
+		{
+			Displays.RemoveAtSwap(i);
+			continue;
+		}
+		if (Display->IsCountdownOnScreen())
+		{
+			Display->UpdateCountdown(ServerTime);
+		}
+	}
+}
+
+TStatId UUpgradeCountdownSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UUpgradeCountdownSubsystem, STATGROUP_Tickables);
+}
+
+bool UUpgradeCountdownSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	// Widgets only exist in game worlds
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UpgradeCountdownSubsystem.generated.h"
+
+class UUpgradeTimerDisplay;
+
+/**
+ * Single ticker behind every running UUpgradeTimerDisplay.
+ * Reads the server clock once per frame and hands it to each display that is on screen, displays compute their
+ * remaining time from the replicated end timestamp of their component. Only ticks while a countdown is running.
+ */
+UCLASS()
+class PLUGIN_DEVELOPMENT_API UUpgradeCountdownSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Starts driving Display. Adding a display twice is harmless. */
+	void AddDisplay(UUpgradeTimerDisplay* Display);
+
+	void RemoveDisplay(UUpgradeTimerDisplay* Display);
+
+	//~ Begin UTickableWorldSubsystem
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return Displays.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+	//~ End UTickableWorldSubsystem
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	TArray<TWeakObjectPtr<UUpgradeTimerDisplay>> Displays;
+};
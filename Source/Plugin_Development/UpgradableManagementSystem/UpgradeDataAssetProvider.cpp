@@ -101,6 +101,8 @@ void UUpgradeDataAssetProvider::InitializeData(TMap<FName, TArray<FUpgradeDefini
             }
             LevelData.UpgradeSeconds = LevelOverride.UpgradeSeconds;
             LevelData.bUpgradeLocked = LevelOverride.bUpgradeLocked;
+            AddProductionRates(LevelOverride.ProductionPerMinute, LevelData, OutResourceTypes);
+            AddStorageCapacities(LevelOverride.StorageCapacity, LevelData, OutResourceTypes);
             LevelDataArray[LevelOverride.UpgradeLevel] = LevelData;
             
             // Initialize previous cost tracking with the first encountered value non-zero
@@ -326,6 +328,8 @@ for (auto& LevelOverride : Asset->LevelOverrides)
             }
         }
         */
+        CarryLevelBonusesForward(LevelDataArray);
+
         if (ProcessedLevels > 0)
         {
             UE_LOG(LogUpgradeSystem, Log, TEXT("[UPGRADEASSET_INFO_01] Successfully processed asset '%s' with %d levels"), 
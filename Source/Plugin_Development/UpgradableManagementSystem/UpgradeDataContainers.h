@@ -4,6 +4,8 @@
 #include "NiagaraSystem.h"
 #include "UpgradeDataContainers.generated.h"
 
+class UResourceSystemComponent;
+
 USTRUCT(BlueprintType)
 struct PLUGIN_DEVELOPMENT_API FUpgradeDefinition
 {
@@ -23,6 +25,20 @@ struct PLUGIN_DEVELOPMENT_API FUpgradeDefinition
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	bool bUpgradeLocked = false;
+
+	/** Resources passively produced while a component sits at this level, parallel to ProductionPerMinute */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<int32> ProductionResourceIndices;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<float> ProductionPerMinute;
+
+	/** Storage a component adds to its owner's capacity while at this level, parallel to StorageCapacity */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<int32> StorageResourceIndices;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<int32> StorageCapacity;
 };
 
 USTRUCT(BlueprintType)
@@ -46,6 +62,16 @@ struct PLUGIN_DEVELOPMENT_API FUpgradeDefinitionAsset : public FTableRowBase
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	bool bUpgradeLocked = false;
+
+	//Resources produced per minute while at this level, e.g. Gold: 12
+	//Levels without any entry keep the production of the level below. Set a value to 0 to stop producing it
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TMap<FName, float> ProductionPerMinute;
+
+	//Capacity added to the owner's storage while at this level, e.g. Gold: 500. Only affects resources with a limited capacity
+	//Levels without any entry keep the storage of the level below
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TMap<FName, int32> StorageCapacity;
 };
 
 USTRUCT(BlueprintType)
@@ -87,8 +113,13 @@ struct PLUGIN_DEVELOPMENT_API FUpgradeInProgressData
 {
 	GENERATED_BODY()
 	
+	// Resources spent on this upgrade, indexed like the manager's ResourceTypes array.
+	UPROPERTY()
+	TArray<int32> SpentResourceCosts;
+
+	// Wallet the costs were taken from. Refunds go back here when the upgrade is canceled.
 	UPROPERTY()
-	TMap<FName, int32> UpgradeResourceCost = {};
+	TWeakObjectPtr<UResourceSystemComponent> Wallet;
 	
 	// Maps each component ID to its upgrade timer.
 	UPROPERTY()
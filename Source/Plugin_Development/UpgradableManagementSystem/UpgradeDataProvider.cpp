@@ -121,6 +121,43 @@ int32 UUpgradeDataProvider::AddOrFindRequiredResourceTypeIndex(const FName& Reso
 	return NewIndex;
 }
 
+void UUpgradeDataProvider::AddProductionRates(const TMap<FName, float>& ProductionPerMinute, FUpgradeDefinition& LevelData, TArray<FName>& ResourceTypes)
+{
+	for (const auto& ProductionPair : ProductionPerMinute)
+	{
+		if (ProductionPair.Key.IsNone()) continue;
+		LevelData.ProductionResourceIndices.Add(AddOrFindRequiredResourceTypeIndex(ProductionPair.Key, ResourceTypes));
+		LevelData.ProductionPerMinute.Add(ProductionPair.Value);
+	}
+}
+
+void UUpgradeDataProvider::AddStorageCapacities(const TMap<FName, int32>& StorageCapacity, FUpgradeDefinition& LevelData, TArray<FName>& ResourceTypes)
+{
+	for (const auto& StoragePair : StorageCapacity)
+	{
+		if (StoragePair.Key.IsNone()) continue;
+		LevelData.StorageResourceIndices.Add(AddOrFindRequiredResourceTypeIndex(StoragePair.Key, ResourceTypes));
+		LevelData.StorageCapacity.Add(StoragePair.Value);
+	}
+}
+
+void UUpgradeDataProvider::CarryLevelBonusesForward(TArray<FUpgradeDefinition>& LevelDataArray) const
+{
+	for (int32 i = 1; i < LevelDataArray.Num(); ++i)
+	{
+		if (LevelDataArray[i].ProductionResourceIndices.Num() == 0)
+		{
+			LevelDataArray[i].ProductionResourceIndices = LevelDataArray[i - 1].ProductionResourceIndices;
+			LevelDataArray[i].ProductionPerMinute = LevelDataArray[i - 1].ProductionPerMinute;
+		}
+		if (LevelDataArray[i].StorageResourceIndices.Num() == 0)
+		{
+			LevelDataArray[i].StorageResourceIndices = LevelDataArray[i - 1].StorageResourceIndices;
+			LevelDataArray[i].StorageCapacity = LevelDataArray[i - 1].StorageCapacity;
+		}
+	}
+}
+
 const FRequirementsScalingSegment* UUpgradeDataProvider::FindSegment(
 	const TArray<FRequirementsScalingSegment>& Segments, int32 Level) const
 {
@@ -47,6 +47,15 @@ protected:
     // Helper function to add a resource type to the resource type array if it doesn't already exist.
     virtual int32 AddOrFindRequiredResourceTypeIndex(const FName& ResourceType, TArray<FName>& ResourceTypes);
 
+    // Helper function to add per minute production rates to a level definition.
+    virtual void AddProductionRates(const TMap<FName, float>& ProductionPerMinute, FUpgradeDefinition& LevelData, TArray<FName>& ResourceTypes);
+
+    // Helper function to add storage capacities to a level definition.
+    virtual void AddStorageCapacities(const TMap<FName, int32>& StorageCapacity, FUpgradeDefinition& LevelData, TArray<FName>& ResourceTypes);
+
+    // Levels that define no production or storage inherit it from the level below, so a value only has to be given where it changes.
+    virtual void CarryLevelBonusesForward(TArray<FUpgradeDefinition>& LevelDataArray) const;
+
     virtual const FRequirementsScalingSegment* FindSegment(const TArray<FRequirementsScalingSegment>& Segments, int32 Level) const;
 
     virtual int32 ComputeRequirementsBySegment(const FRequirementsScalingSegment* Segment, int32 PreviousCost, int32 Level) const;
@@ -67,9 +67,12 @@ void UUpgradeDataTableProvider::InitializeData(TMap<FName, TArray<FUpgradeDefini
             
             LevelData.UpgradeSeconds = LevelAsset->UpgradeSeconds;
             LevelData.bUpgradeLocked = LevelAsset->bUpgradeLocked;
+            AddProductionRates(LevelAsset->ProductionPerMinute, LevelData, OutResourceTypes);
+            AddStorageCapacities(LevelAsset->StorageCapacity, LevelData, OutResourceTypes);
             LevelArray.Add(LevelData);
             ++ProcessedRows;
         }
+        CarryLevelBonusesForward(LevelArray);
         UE_LOG(LogUpgradeSystem, Log, TEXT("[UPGRADETABLE_INFO_01] Successfully processed DataTable '%s' with %d rows"), *Table->GetName(), ProcessedRows);
     }
 
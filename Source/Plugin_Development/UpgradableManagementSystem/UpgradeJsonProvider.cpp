@@ -118,6 +118,28 @@ void UUpgradeJsonProvider::InitializeData(TMap<FName, TArray<FUpgradeDefinition>
 
 			LevelData.UpgradeSeconds = (*OverrideObj)->GetIntegerField(TEXT("UpgradeSeconds"));
 			LevelData.bUpgradeLocked = (*OverrideObj)->GetBoolField(TEXT("bUpgradeLocked"));
+
+			const TSharedPtr<FJsonObject> *ProductionObj;
+			if ((*OverrideObj)->TryGetObjectField(TEXT("ProductionPerMinute"), ProductionObj))
+			{
+				TMap<FName, float> ProductionPerMinute;
+				for (const auto &Pair : (*ProductionObj)->Values)
+				{
+					ProductionPerMinute.Add(FName(*Pair.Key), Pair.Value->AsNumber());
+				}
+				AddProductionRates(ProductionPerMinute, LevelData, OutResourceTypes);
+			}
+
+			const TSharedPtr<FJsonObject> *StorageObj;
+			if ((*OverrideObj)->TryGetObjectField(TEXT("StorageCapacity"), StorageObj))
+			{
+				TMap<FName, int32> StorageCapacity;
+				for (const auto &Pair : (*StorageObj)->Values)
+				{
+					StorageCapacity.Add(FName(*Pair.Key), static_cast<int32>(Pair.Value->AsNumber()));
+				}
+				AddStorageCapacities(StorageCapacity, LevelData, OutResourceTypes);
+			}
 			LevelDataArray[UpgradeLevel] = LevelData;
 			ProcessedLevels++;
 
@@ -276,6 +298,8 @@ void UUpgradeJsonProvider::InitializeData(TMap<FName, TArray<FUpgradeDefinition>
 			}
 		}
 
+		CarryLevelBonusesForward(LevelDataArray);
+
 		if (ProcessedLevels > 0)
 		{
 			UE_LOG(LogUpgradeSystem, Log, TEXT("[UPGRADEJSON_INFO_03] Successfully processed file '%s' with %d levels"), *FPaths::GetCleanFilename(File), ProcessedLevels);
@@ -11,11 +11,32 @@
 #include "TimerManager.h"
 #include "Engine/World.h"
 #include "GameFramework/Actor.h"
+#include "GameFramework/PlayerController.h"
 #include "../CustomLogging.h"
+#include "../ResourceManagementSystem/ResourceManagerSubsystem.h"
+#include "../ResourceManagementSystem/ResourceSystemComponent.h"
+#include "../RequestRateLimiterSubsystem.h"
 #include "Windows/WindowsApplication.h"
 
 DEFINE_LOG_CATEGORY(LogUpgradeSystem);
 
+namespace
+{
+	/** Credits of zero are removed, a credit map only holds what currently reached the wallet */
+	template<typename ValueType>
+	void SetCredit(TMap<int32, ValueType>& Credits, int32 ResourceId, ValueType Value)
+	{
+		if (Value == ValueType(0))
+		{
+			Credits.Remove(ResourceId);
+		}
+		else
+		{
+			Credits.Add(ResourceId, Value);
+		}
+	}
+}
+
 UUpgradeManagerSubsystem::UUpgradeManagerSubsystem()
 {
 }
@@ -27,6 +48,11 @@ void UUpgradeManagerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 
 void UUpgradeManagerSubsystem::Deinitialize()
 {
+	OnUpgradableStateChanged.Clear();
+	if (UResourceManagerSubsystem* ResourceSubsystem = GetWorld()->GetSubsystem<UResourceManagerSubsystem>())
+	{
+		ResourceSubsystem->OnComponentRegistered.RemoveAll(this);
+	}
 	Super::Deinitialize();
 }
 
@@ -44,6 +70,12 @@ void UUpgradeManagerSubsystem::OnWorldBeginPlay(UWorld& InWorld)
 	Super::OnWorldBeginPlay(InWorld);
 	const TArray<UUpgradeDataProvider*> DataProviders = InitializeProviders();
 	LoadCatalog(DataProviders);
+
+	// Wallets register in their BeginPlay, after this
+	if (UResourceManagerSubsystem* ResourceSubsystem = InWorld.GetSubsystem<UResourceManagerSubsystem>())
+	{
+		ResourceSubsystem->OnComponentRegistered.AddUObject(this, &UUpgradeManagerSubsystem::HandleResourceComponentRegistered);
+	}
 }
 
 void UUpgradeManagerSubsystem::LoadCatalog(TArray<UUpgradeDataProvider*> DataProviders)
@@ -53,11 +85,31 @@ void UUpgradeManagerSubsystem::LoadCatalog(TArray<UUpgradeDataProvider*> DataPro
     UpgradeCatalog.Empty();
     ResourceTypes.Empty();
 
+    // Seed with the shared resource table so catalog resource indices double as network resource IDs
+    UResourceManagerSubsystem* ResourceSubsystem = GetWorld()->GetSubsystem<UResourceManagerSubsystem>();
+    if (ResourceSubsystem)
+    {
+	ResourceTypes = ResourceSubsystem->GetResourceTable();
+    }
+
     for (UUpgradeDataProvider* Provider : DataProviders)
     {
 	if (!Provider) continue;
 	Provider->InitializeData(UpgradeCatalog, ResourceTypes);
     }
+
+    if (ResourceSubsystem)
+    {
+	// Providers only append, so interning in order keeps both tables index-aligned
+	for (const FName& ResourceType : ResourceTypes)
+	{
+	    ResourceSubsystem->FindOrAddResourceId(ResourceType);
+	}
+	TArray<FName> UpgradePaths;
+	UpgradeCatalog.GetKeys(UpgradePaths);
+	UpgradePaths.Sort(FNameLexicalLess());
+	ResourceSubsystem->SetUpgradePathTable(UpgradePaths);
+    }
 	UE_LOG(LogUpgradeSystem, Log, TEXT("[UPGRADEMGR_INFO_03] Loaded Upgrade Catalog from %d provider(s)"), DataProviders.Num());
 }
 
@@ -77,6 +129,7 @@ int32 UUpgradeManagerSubsystem::RegisterUpgradableComponent(UUpgradableComponent
 		Id = RegisteredComponents.Add(Component);
 		ComponentLevels.Add(Component->InitialLevel);
 	}
+	UpdateLevelBonuses(Id, Component->InitialLevel);
 	if (UE_LOG_ACTIVE(LogUpgradeSystem, Verbose))
 	{
 		UE_LOG(LogUpgradeSystem, Verbose, TEXT("[UPGRADEMGR_INFO_04] Registered component ID %d at level %d. Total components %d"), Id, Component->InitialLevel, RegisteredComponents.Num()-FreeComponentIndices.Num());
@@ -89,6 +142,7 @@ void UUpgradeManagerSubsystem::UpdateUpgradeLevel(const int32 ComponentId, const
 	if (UUpgradableComponent* Comp = GetComponentById(ComponentId))
 	{
 		ComponentLevels[ComponentId] = NewLevel;
+		UpdateLevelBonuses(ComponentId, NewLevel);
 		Comp->Client_SetLevel(NewLevel);
 	}
 }
@@ -101,6 +155,7 @@ void UUpgradeManagerSubsystem::UnregisterUpgradableComponent(const int32 Compone
 		{
 			CancelUpgrade(ComponentId);
 		}
+		UpdateLevelBonuses(ComponentId, INDEX_NONE);
 		RegisteredComponents[ComponentId].Reset();    // Clear the weak ptr
 		FreeComponentIndices.Add(ComponentId);                // Remember this slot as a hole
 		ComponentLevels[ComponentId] = -1;           // Mark as unused 
@@ -135,6 +190,9 @@ float UUpgradeManagerSubsystem::StartUpgradeTimer(int32 ComponentId, float Timer
 	
 	if (UUpgradableComponent* Comp = GetComponentById(ComponentId))
 	{
+		const FUpgradeInProgressData& InProgressData = UpgradeInProgressData[ComponentId];
+		Comp->SetUpgradeSchedule(GetWorld()->GetTimeSeconds() + TimerDuration, InProgressData.TotalUpgradeTime,
+			GetCurrentLevel(ComponentId) + InProgressData.RequestedLevelIncrease);
 		Comp->Client_OnUpgradeStarted(TimerDuration);
 	}
 	return TimerDuration;
@@ -155,18 +213,40 @@ void UUpgradeManagerSubsystem::CancelUpgrade(int32 ComponentId)
 	if (Comp && IsUpgradeTimerActive(ComponentId))
 	{
 		StopUpgradeTimer(ComponentId);
+		RefundUpgradeCosts(UpgradeInProgressData[ComponentId]);
 		UpgradeInProgressData.Remove(ComponentId);
+		Comp->SetUpgradeSchedule(0.0, 0.f, INDEX_NONE);
 		Comp->Client_OnUpgradeCanceled(GetCurrentLevel(ComponentId));
 	}
 }
 
+void UUpgradeManagerSubsystem::RefundUpgradeCosts(const FUpgradeInProgressData& InProgressData) const
+{
+	UResourceSystemComponent* Wallet = InProgressData.Wallet.Get();
+	UResourceManagerSubsystem* ResourceSubsystem = GetWorld()->GetSubsystem<UResourceManagerSubsystem>();
+	if (!Wallet || !ResourceSubsystem) return;
+
+	const float RefundRatio = GetDefault<UUpgradeSettings>()->CancelRefundRatio;
+	for (int32 i = 0; i < InProgressData.SpentResourceCosts.Num(); ++i)
+	{
+		const int32 Refund = FMath::FloorToInt(InProgressData.SpentResourceCosts[i] * RefundRatio);
+		if (Refund > 0)
+		{
+			ResourceSubsystem->AddResourceById(Wallet, i, Refund, EResourceChangeReason::UpgradeRefund);
+		}
+	}
+}
+
 void UUpgradeManagerSubsystem::OnUpgradeTimerFinished(int32 ComponentId)
 {
 	StopUpgradeTimer(ComponentId);
 
-	if (!GetComponentById(ComponentId)) return;
+	UUpgradableComponent* Comp = GetComponentById(ComponentId);
+	if (!Comp) return;
 
 	const int32 NewLevel = GetCurrentLevel(ComponentId) + UpgradeInProgressData[ComponentId].RequestedLevelIncrease;   
+	// The target level stays set, its prefetched visuals are about to be shown
+	Comp->SetUpgradeSchedule(0.0, 0.f, NewLevel);
 	UpgradeInProgressData.Remove(ComponentId);
 	
 	UpdateUpgradeLevel(ComponentId, NewLevel);
@@ -232,9 +312,30 @@ int32 UUpgradeManagerSubsystem::GetInProgressLevelIncrease(int32 ComponentId) co
 
 UUpgradableComponent* UUpgradeManagerSubsystem::GetComponentById(const int32 Id) const
 {
-	return (RegisteredComponents.IsValidIndex(Id)
-			? RegisteredComponents[Id].Get()
-			: nullptr);
+	if (RegisteredComponents.IsValidIndex(Id))
+	{
+		return RegisteredComponents[Id].Get();
+	}
+	const TWeakObjectPtr<UUpgradableComponent>* Replicated = ReplicatedComponents.Find(Id);
+	return Replicated ? Replicated->Get() : nullptr;
+}
+
+void UUpgradeManagerSubsystem::RegisterReplicatedComponent(UUpgradableComponent* Component)
+{
+	if (Component && Component->GetComponentId() != -1)
+	{
+		ReplicatedComponents.Add(Component->GetComponentId(), Component);
+	}
+}
+
+void UUpgradeManagerSubsystem::UnregisterReplicatedComponent(int32 ComponentId, const UUpgradableComponent* Component)
+{
+	// The server reuses IDs, a new component may have replicated with this ID before the old one ended play
+	const TWeakObjectPtr<UUpgradableComponent>* Replicated = ReplicatedComponents.Find(ComponentId);
+	if (Replicated && (!Replicated->IsValid() || Replicated->Get() == Component))
+	{
+		ReplicatedComponents.Remove(ComponentId);
+	}
 }
 
 UUpgradableComponent* UUpgradeManagerSubsystem::FindComponentOnActorByAspect(AActor* TargetActor, EUpgradableAspect Aspect) const
@@ -274,9 +375,7 @@ UUpgradableComponent* UUpgradeManagerSubsystem::FindComponentOnActorByCategory(A
 
 bool UUpgradeManagerSubsystem::RequestUpgradeForActor(AActor* TargetActor,
 													  EUpgradableAspect Aspect,
-													  int32 LevelIncrease,
-													  const TArray<FName>& ResourceTypesArray,
-													  const TArray<int32>& ResourceAmounts)
+													  int32 LevelIncrease)
 {
 	if (!TargetActor)
 		return false;
@@ -285,7 +384,7 @@ bool UUpgradeManagerSubsystem::RequestUpgradeForActor(AActor* TargetActor,
 	if (!Comp)
 		return false;
 
-	Comp->RequestUpgrade(LevelIncrease, ResourceTypesArray, ResourceAmounts);
+	Comp->RequestUpgrade(LevelIncrease);
 	return true;
 }
 
@@ -319,6 +418,43 @@ TArray<UUpgradableComponent*> UUpgradeManagerSubsystem::GetComponentsByAspect(EU
 	return Result;
 }
 
+void UUpgradeManagerSubsystem::GetComponentIdsByAspect(EUpgradableAspect Aspect, int32 LevelFilter, TArray<int32>& OutComponentIds, const APlayerController* OwningPlayer) const
+{
+	const auto Matches = [Aspect, OwningPlayer](const UUpgradableComponent* Comp)
+	{
+		return Comp && Comp->GetUpgradableAspect() == Aspect
+			&& (!OwningPlayer || (Comp->GetOwner() && Comp->GetOwner()->IsOwnedBy(OwningPlayer)));
+	};
+
+	OutComponentIds.Reset();
+	if (GetWorld()->GetNetMode() == NM_Client)
+	{
+		for (const TPair<int32, TWeakObjectPtr<UUpgradableComponent>>& Pair : ReplicatedComponents)
+		{
+			const UUpgradableComponent* Comp = Pair.Value.Get();
+			if (!Matches(Comp) || (LevelFilter >= 0 && Comp->GetCurrentUpgradeLevel() != LevelFilter))
+				continue;
+
+			OutComponentIds.Add(Pair.Key);
+		}
+		// Same order as on the server
+		OutComponentIds.Sort();
+		return;
+	}
+
+	for (int32 Id = 0; Id < RegisteredComponents.Num(); ++Id)
+	{
+		const UUpgradableComponent* Comp = RegisteredComponents[Id].Get();
+		if (!Matches(Comp))
+			continue;
+
+		if (LevelFilter >= 0 && (!ComponentLevels.IsValidIndex(Id) || ComponentLevels[Id] != LevelFilter))
+			continue;
+
+		OutComponentIds.Add(Id);
+	}
+}
+
 TArray<UUpgradableComponent*> UUpgradeManagerSubsystem::GetComponentsByUpgradePath(FName PathId,
 	int32 LevelFilter) const
 {
@@ -409,22 +545,38 @@ FName UUpgradeManagerSubsystem::GetResourceTypeName(const int32 Index) const
 			: NAME_None;
 }
 
+bool UUpgradeManagerSubsystem::GetDenseUpgradeCosts(int32 ComponentId, int32 LevelIncrease, TArray<int32>& OutDenseCosts) const
+{
+	OutDenseCosts.Reset();
+	OutDenseCosts.SetNumZeroed(ResourceTypes.Num());
+
+	const TArray<FUpgradeDefinition>* UpgradeDefinitions = GetUpgradeDefinitions(ComponentId);
+	if (!UpgradeDefinitions) return false;
+
+	const int32 LastLevel = FMath::Min(GetCurrentLevel(ComponentId) + LevelIncrease, UpgradeDefinitions->Num() - 1);
+	for (int32 Level = GetNextLevel(ComponentId); Level <= LastLevel; ++Level)
+	{
+		const FUpgradeDefinition& LevelData = (*UpgradeDefinitions)[Level];
+		for (int32 j = 0; j < LevelData.ResourceTypeIndices.Num(); ++j)
+		{
+			OutDenseCosts[LevelData.ResourceTypeIndices[j]] += LevelData.UpgradeCosts[j];
+		}
+	}
+	return true;
+}
+
 TMap<FName, int32> UUpgradeManagerSubsystem::GetUpgradeTotalResourceCost(int32 ComponentId, int32 LevelIncrease) const
 {
 	TMap<FName, int32> TotalResourceCosts;
 
-	if (const TArray<FUpgradeDefinition>* UpgradeDefinitions = GetUpgradeDefinitions(ComponentId))
+	TArray<int32> DenseCosts;
+	if (GetDenseUpgradeCosts(ComponentId, LevelIncrease, DenseCosts))
 	{
-		const FUpgradeDefinition* LevelData = nullptr;
-
-		for (int32 i = GetNextLevel(ComponentId); i <= GetCurrentLevel(ComponentId) + LevelIncrease; ++i)
+		for (int32 i = 0; i < DenseCosts.Num(); ++i)
 		{
-			LevelData = &(*UpgradeDefinitions)[i];
-
-			for (int32 j = 0; j < LevelData->ResourceTypeIndices.Num(); ++j)
+			if (DenseCosts[i] > 0)
 			{
-				const FName ResourceType = GetResourceTypeName(LevelData->ResourceTypeIndices[j]);
-				TotalResourceCosts.FindOrAdd(ResourceType) += LevelData->UpgradeCosts[j];
+				TotalResourceCosts.Add(GetResourceTypeName(i), DenseCosts[i]);
 			}
 		}
 	}
@@ -433,11 +585,18 @@ TMap<FName, int32> UUpgradeManagerSubsystem::GetUpgradeTotalResourceCost(int32 C
 
 TMap<FName, int32> UUpgradeManagerSubsystem::GetInProgressTotalResourceCost(int32 ComponentId) const
 {
-	if (UpgradeInProgressData.Contains(ComponentId))
+	TMap<FName, int32> SpentResources;
+	if (const FUpgradeInProgressData* InProgressData = UpgradeInProgressData.Find(ComponentId))
 	{
-		return UpgradeInProgressData[ComponentId].UpgradeResourceCost;
+		for (int32 i = 0; i < InProgressData->SpentResourceCosts.Num(); ++i)
+		{
+			if (InProgressData->SpentResourceCosts[i] > 0)
+			{
+				SpentResources.Add(GetResourceTypeName(i), InProgressData->SpentResourceCosts[i]);
+			}
+		}
 	}
-	return TMap<FName, int32>();
+	return SpentResources;
 }
 
 void UUpgradeManagerSubsystem::GetNextLevelUpgradeCosts(const int32 ComponentId, TMap<FName, int32>& ResourceCosts) const
@@ -484,7 +643,108 @@ const FUpgradeDefinition* UUpgradeManagerSubsystem::GetUpgradeDefinitionForLevel
 
 
 
-bool UUpgradeManagerSubsystem::CanUpgrade(const int32 ComponentId, const int32 LevelIncrease, const TMap<FName, int32>& AvailableResources) const
+void UUpgradeManagerSubsystem::UpdateLevelBonuses(const int32 ComponentId, const int32 NewLevel)
+{
+	UResourceManagerSubsystem* ResourceSubsystem = GetWorld()->GetSubsystem<UResourceManagerSubsystem>();
+	const UUpgradableComponent* Comp = GetComponentById(ComponentId);
+	if (!ResourceSubsystem || !Comp) return;
+
+	const FUpgradeDefinition* NewDefinition = GetUpgradeDefinitionForLevel(ComponentId, NewLevel);
+	FLevelBonusCredit* Credit = LevelBonusCredits.Find(ComponentId);
+	if (!Credit)
+	{
+		// Components that never produced or stored anything stay out of the map
+		if (!NewDefinition || (NewDefinition->ProductionResourceIndices.Num() == 0 && NewDefinition->StorageResourceIndices.Num() == 0)) return;
+		Credit = &LevelBonusCredits.Add(ComponentId);
+	}
+
+	UResourceSystemComponent* Wallet = Credit->Wallet.Get();
+	if (!Wallet && NewDefinition)
+	{
+		Wallet = ResourceSubsystem->FindResourceComponentForActor(Comp->GetOwner());
+		Credit->Wallet = Wallet;
+	}
+
+	if (!ResourceSubsystem->IsComponentRegistered(Wallet))
+	{
+		// Not begun play yet or unregistered, the wallet holds nothing of ours. It is credited once it registers.
+		Credit->CreditedRates.Reset();
+		Credit->CreditedCapacities.Reset();
+		if (NewDefinition)
+		{
+			UE_LOG(LogUpgradeSystem, Verbose, TEXT("[UPGRADEMGR_INFO_06] Component %d has no registered wallet, its production and storage are not credited"), ComponentId);
+		}
+	}
+	else
+	{
+		// Targets are indexed like ResourceTypes, which doubles as the resource ID
+		TArray<float, TInlineAllocator<16>> TargetRates;
+		TargetRates.SetNumZeroed(ResourceTypes.Num());
+		TArray<int32, TInlineAllocator<16>> TargetCapacities;
+		TargetCapacities.SetNumZeroed(ResourceTypes.Num());
+		if (NewDefinition)
+		{
+			for (int32 i = 0; i < NewDefinition->ProductionResourceIndices.Num(); ++i)
+			{
+				TargetRates[NewDefinition->ProductionResourceIndices[i]] += NewDefinition->ProductionPerMinute[i];
+			}
+			for (int32 i = 0; i < NewDefinition->StorageResourceIndices.Num(); ++i)
+			{
+				TargetCapacities[NewDefinition->StorageResourceIndices[i]] += NewDefinition->StorageCapacity[i];
+			}
+		}
+
+		for (int32 i = 0; i < ResourceTypes.Num(); ++i)
+		{
+			// Capacity first, so production credited below already fills the new storage.
+			// A rejected change stays uncredited and is retried with the next level change.
+			const int32 CapacityDelta = TargetCapacities[i] - Credit->CreditedCapacities.FindRef(i);
+			if (CapacityDelta != 0 && ResourceSubsystem->AddCapacity(Wallet, i, CapacityDelta))
+			{
+				SetCredit(Credit->CreditedCapacities, i, TargetCapacities[i]);
+			}
+			const float RateDelta = TargetRates[i] - Credit->CreditedRates.FindRef(i);
+			if (RateDelta != 0.f && ResourceSubsystem->AddProductionRate(Wallet, i, RateDelta))
+			{
+				SetCredit(Credit->CreditedRates, i, TargetRates[i]);
+			}
+		}
+	}
+
+	if (NewLevel == INDEX_NONE)
+	{
+		LevelBonusCredits.Remove(ComponentId);
+	}
+}
+
+void UUpgradeManagerSubsystem::HandleResourceComponentRegistered(UResourceSystemComponent* Wallet)
+{
+	TArray<int32, TInlineAllocator<16>> ComponentIds;
+	for (TPair<int32, FLevelBonusCredit>& Pair : LevelBonusCredits)
+	{
+		// Credits without a wallet may find this one now
+		if (Pair.Value.Wallet == Wallet || !Pair.Value.Wallet.IsValid())
+		{
+			// The bucket is new, nothing credited before is in it
+			Pair.Value.CreditedRates.Reset();
+			Pair.Value.CreditedCapacities.Reset();
+			ComponentIds.Add(Pair.Key);
+		}
+	}
+	for (const int32 ComponentId : ComponentIds)
+	{
+		UpdateLevelBonuses(ComponentId, ComponentLevels[ComponentId]);
+	}
+}
+
+bool UUpgradeManagerSubsystem::ShouldLogRejection(const TCHAR* RejectionCode) const
+{
+	// Remote clients can trigger rejections at request rate, so repeats of the same code are throttled
+	URequestRateLimiterSubsystem* RateLimiter = GetWorld()->GetSubsystem<URequestRateLimiterSubsystem>();
+	return !RateLimiter || RateLimiter->ShouldLogRejection(FName(RejectionCode));
+}
+
+bool UUpgradeManagerSubsystem::CanUpgrade(const int32 ComponentId, const int32 LevelIncrease, const UResourceSystemComponent* Wallet) const
 {
     UE_LOG(LogUpgradeSystem, Verbose, TEXT("[UPGRADEMGR_INFO_01] Checking upgrade eligibility for component %d (increase %d)"), ComponentId, LevelIncrease);
 
@@ -492,64 +752,63 @@ bool UUpgradeManagerSubsystem::CanUpgrade(const int32 ComponentId, const int32 L
 
    if (!GetComponentById(ComponentId))
    {
-       UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_00] Component %d not registered"), ComponentId);
+       if (ShouldLogRejection(TEXT("UPGRADEMGR_ERR_00"))) UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_00] Component %d not registered"), ComponentId);
        return false;
    }
    // Future implementation idea: Add upgrade queue to chain multiple upgrades
    if (IsUpgradeTimerActive(ComponentId))
    {
-       UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_01] Component %d already upgrading"), ComponentId);
+       if (ShouldLogRejection(TEXT("UPGRADEMGR_ERR_01"))) UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_01] Component %d already upgrading"), ComponentId);
        return false;
    }
 
    if (LevelIncrease <= 0)
    {
-       UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_02] Invalid level increase %d for component %d"), LevelIncrease, ComponentId);
+       if (ShouldLogRejection(TEXT("UPGRADEMGR_ERR_02"))) UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_02] Invalid level increase %d for component %d"), LevelIncrease, ComponentId);
        return false;
    }
    // Trying to upgrade to a level higher than the max level
    if (GetCurrentLevel(ComponentId) + LevelIncrease > GetMaxLevel(ComponentId))
    {
-       UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_03] Requested level exceeds max for component %d"), ComponentId);
+       if (ShouldLogRejection(TEXT("UPGRADEMGR_ERR_03"))) UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_03] Requested level exceeds max for component %d"), ComponentId);
        return false;
    }
 
-   if (const TArray<FUpgradeDefinition>* UpgradeDefinitions = GetUpgradeDefinitions(ComponentId))
+   const UResourceManagerSubsystem* ResourceSubsystem = GetWorld()->GetSubsystem<UResourceManagerSubsystem>();
+   if (!Wallet || !ResourceSubsystem)
    {
-       const FUpgradeDefinition* LevelData = nullptr;
+       if (ShouldLogRejection(TEXT("UPGRADEMGR_ERR_07"))) UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_07] No resource wallet found to pay for component %d"), ComponentId);
+       return false;
+   }
 
-       TMap<FName, int32> TotalResourceCosts;
+   if (const TArray<FUpgradeDefinition>* UpgradeDefinitions = GetUpgradeDefinitions(ComponentId))
+   {
        // Iterate over all levels if trying to upgrade several levels at once
        for (int32 i = GetNextLevel(ComponentId); i <= GetCurrentLevel(ComponentId) + LevelIncrease; ++i)
        {
-	   LevelData = &(*UpgradeDefinitions)[i];
-	   if (LevelData->bUpgradeLocked)
+	   if ((*UpgradeDefinitions)[i].bUpgradeLocked)
 	   {
-	       UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_04] Level %d locked for component %d"), i, ComponentId);
+	       if (ShouldLogRejection(TEXT("UPGRADEMGR_ERR_04"))) UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_04] Level %d locked for component %d"), i, ComponentId);
 	       return false;
 	   }
-	   FName ResourceType ;
-	   // Add up the required resource cost for each resource for this level
-	   for (int32 j = 0; j < LevelData->ResourceTypeIndices.Num(); ++j)
-	   {
-	       ResourceType = GetResourceTypeName(LevelData->ResourceTypeIndices[j]);
-	       // no resource of the required type was provided
-	       if (!AvailableResources.Contains(ResourceType))
-	       {
-		   UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_05] Missing resource '%s' for component %d"), *ResourceType.ToString(), ComponentId);
-		   return false;
-	       }
-	       TotalResourceCosts.FindOrAdd(ResourceType) += LevelData->UpgradeCosts[j];
-	   }
        }
-       TArray<FName> RequiredResources;
-       TotalResourceCosts.GetKeys(RequiredResources);
-       for (FName ResourceType : RequiredResources)
+
+       TArray<int32> DenseCosts;
+       GetDenseUpgradeCosts(ComponentId, LevelIncrease, DenseCosts);
+       for (int32 i = 0; i < DenseCosts.Num(); ++i)
        {
+	   if (DenseCosts[i] <= 0) continue;
+	   // GetResource returns -1 when the wallet never held this resource type
+	   const int32 Available = ResourceSubsystem->GetResourceById(Wallet, i);
+	   if (Available < 0)
+	   {
+	       if (ShouldLogRejection(TEXT("UPGRADEMGR_ERR_05"))) UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_05] Missing resource '%s' for component %d"), *GetResourceTypeName(i).ToString(), ComponentId);
+	       return false;
+	   }
 	   // not enough resources of the required type
-	   if (TotalResourceCosts[ResourceType] > AvailableResources.FindRef(ResourceType))
+	   if (DenseCosts[i] > Available)
 	   {
-	       UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_06] Insufficient '%s' for component %d"), *ResourceType.ToString(), ComponentId);
+	       if (ShouldLogRejection(TEXT("UPGRADEMGR_ERR_06"))) UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEMGR_ERR_06] Insufficient '%s' for component %d"), *GetResourceTypeName(i).ToString(), ComponentId);
 	       return false;
 	   }
        }
@@ -560,17 +819,25 @@ bool UUpgradeManagerSubsystem::CanUpgrade(const int32 ComponentId, const int32 L
    return Success;
 }
 
-bool UUpgradeManagerSubsystem::HandleUpgradeRequest(const int32 ComponentId, const int32 LevelIncrease, const TMap<FName, int32>& AvailableResources)
+bool UUpgradeManagerSubsystem::HandleUpgradeRequest(const int32 ComponentId, const int32 LevelIncrease, UResourceSystemComponent* Wallet)
 {
-	if (!CanUpgrade(ComponentId, LevelIncrease, AvailableResources)) return false;
+	if (!CanUpgrade(ComponentId, LevelIncrease, Wallet)) return false;
 	const float UpgradeDuration = GetUpgradeTimerDuration(ComponentId, LevelIncrease);
-	const TMap<FName, int32> TotalResourceCosts = GetUpgradeTotalResourceCost(ComponentId, LevelIncrease);
+
+	TArray<int32> DenseCosts;
+	GetDenseUpgradeCosts(ComponentId, LevelIncrease, DenseCosts);
+
+	// All or nothing, the wallet is never left partially charged
+	UResourceManagerSubsystem* ResourceSubsystem = GetWorld()->GetSubsystem<UResourceManagerSubsystem>();
+	if (!ResourceSubsystem->TrySpendDense(Wallet, DenseCosts, EResourceChangeReason::UpgradeCost)) return false;
 
 	if (UpgradeDuration > 0.f)
 	{
-		UpgradeInProgressData.FindOrAdd(ComponentId).TotalUpgradeTime = UpgradeDuration;
-		UpgradeInProgressData.FindOrAdd(ComponentId).RequestedLevelIncrease = LevelIncrease;
-		UpgradeInProgressData.FindOrAdd(ComponentId).UpgradeResourceCost = TotalResourceCosts;
+		FUpgradeInProgressData& InProgressData = UpgradeInProgressData.FindOrAdd(ComponentId);
+		InProgressData.TotalUpgradeTime = UpgradeDuration;
+		InProgressData.RequestedLevelIncrease = LevelIncrease;
+		InProgressData.SpentResourceCosts = MoveTemp(DenseCosts);
+		InProgressData.Wallet = Wallet;
 		StartUpgradeTimer(ComponentId, UpgradeDuration);
 	}
 	else
@@ -14,6 +14,11 @@ DECLARE_LOG_CATEGORY_EXTERN(LogUpgradeSystem, Log, All);
 
 class UUpgradableComponent;
 class UUpgradeJsonProvider;
+class APlayerController;
+class UResourceSystemComponent;
+
+/** Native, no per-component binding. ComponentId is the component's manager ID. */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnUpgradableStateChanged, int32 /*ComponentId*/);
 
 UCLASS()
 class PLUGIN_DEVELOPMENT_API UUpgradeManagerSubsystem : public UWorldSubsystem
@@ -31,11 +36,15 @@ public:
 	int32 RegisterUpgradableComponent(UUpgradableComponent* Component);
 	void UnregisterUpgradableComponent(int32 ComponentId);
 	
-	bool HandleUpgradeRequest(int32 ComponentId, int32 LevelIncrease, const TMap<FName, int32>& AvailableResources);
-	bool CanUpgrade(int32 ComponentId, int32 LevelIncrease, const TMap<FName, int32>& AvailableResources) const;
+	/**
+	 * Validates the request against the wallet's server side balances and spends the total cost when accepted.
+	 * @param Wallet - Resource component paying for the upgrade. Looked up on the server, never sent by clients.
+	 */
+	bool HandleUpgradeRequest(int32 ComponentId, int32 LevelIncrease, UResourceSystemComponent* Wallet);
+	bool CanUpgrade(int32 ComponentId, int32 LevelIncrease, const UResourceSystemComponent* Wallet) const;
 	void UpdateUpgradeLevel(const int32 ComponentId, const int32 NewLevel);
 	
-	/** Gets an upgradable component by its unique ID */
+	/** Gets an upgradable component by its unique ID. On clients, for components whose ID has replicated. */
 	UFUNCTION(BlueprintCallable, Category = "Upgrade System|Status")
 	UUpgradableComponent* GetComponentById(int32 Id) const;
 
@@ -55,6 +64,23 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Upgrade System|Query")
 	TArray<UUpgradableComponent*> GetComponentsByAspect(EUpgradableAspect Aspect, int32 LevelFilter = -1) const;
 
+	/**
+	 * Same filter as GetComponentsByAspect, returning component IDs. Meant for lists that resolve rows lazily.
+	 * On clients, lists the components whose ID has replicated, filtered by their local level.
+	 * @param OwningPlayer - If set, only components whose owner chain leads to this player controller
+	 */
+	void GetComponentIdsByAspect(EUpgradableAspect Aspect, int32 LevelFilter, TArray<int32>& OutComponentIds, const APlayerController* OwningPlayer = nullptr) const;
+
+	/** Called by components on clients once their ID replicated, and when it changes or they end play */
+	void RegisterReplicatedComponent(UUpgradableComponent* Component);
+	void UnregisterReplicatedComponent(int32 ComponentId, const UUpgradableComponent* Component);
+
+	/**
+	 * Fired on the machine showing a component whenever its level or upgrade state changed (level set, upgrade started,
+	 * restarted or canceled). Lists subscribe once and refresh the affected row by ID instead of binding every component.
+	 */
+	FOnUpgradableStateChanged OnUpgradableStateChanged;
+
 	/**
 	 * Returns an array of every UUpgradableComponent in the world with UpgradePathId == PathId.
 	 * If LevelFilter >= 0, only returns those whose current level == LevelFilter.
@@ -73,13 +99,11 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Upgrade System")
 	bool RequestUpgradeForActor(AActor* TargetActor,
 								EUpgradableAspect Aspect,
-								int32 LevelIncrease,
-								const TArray<FName>& ResourceTypes,
-								const TArray<int32>& ResourceAmounts);
+								int32 LevelIncrease);
 
-	/** Attempts to upgrade a component by the specified number of levels */
+	/** Attempts to upgrade a component by the specified number of levels, paid from Wallet */
 	UFUNCTION(BlueprintCallable, Category = "Upgrade System")
-	bool UpgradeComponent(const int32 ComponentId, const TMap<FName, int32> AvailableResources, const int32 LevelIncrease = 1) { return HandleUpgradeRequest(ComponentId, LevelIncrease, AvailableResources) ;}
+	bool UpgradeComponent(const int32 ComponentId, UResourceSystemComponent* Wallet, const int32 LevelIncrease = 1) { return HandleUpgradeRequest(ComponentId, LevelIncrease, Wallet) ;}
 
 	/**
 	* Returns the current, client-visible level of the component on TargetActor
@@ -125,10 +149,11 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Upgrade System|Resources")
 	TMap<FName, int32> GetUpgradeTotalResourceCost (int32 ComponentId, int32 LevelIncrease) const;
 	
-	// Not implemented yet. Use GetNextLevelUpgradeCosts
+	/** Resources that were spent on the upgrade currently in progress */
 	UFUNCTION(BlueprintCallable, Category = "Upgrade System|Resources")
 	TMap<FName, int32> GetInProgressTotalResourceCost(int32 ComponentId) const;
 	
+	/** Stops the upgrade in progress and refunds the spent resources according to UUpgradeSettings::CancelRefundRatio */
 	UFUNCTION(BlueprintCallable, Category = "Upgrade System|Timer")
 	void CancelUpgrade(int32 ComponentId);
 
@@ -164,6 +189,9 @@ protected:
 	
 	UPROPERTY()
 	TArray<TWeakObjectPtr<UUpgradableComponent>> RegisteredComponents;
+
+	// Clients only, RegisteredComponents exists on the server. Components by their replicated ID.
+	TMap<int32, TWeakObjectPtr<UUpgradableComponent>> ReplicatedComponents;
 	
 	// Stores the current level of each component ID.
 	// TODO make this into a struct of component data. Cache them locally in the manager when the component registers itself. To be used for quick lookup instead of looping over all components in query functions.
@@ -196,6 +224,39 @@ protected:
 	
 	// Helpers
 	void CleanupFreeIndices();
+
+	/**
+	 * Sums the costs of the requested levels into a dense vector indexed like ResourceTypes.
+	 * @return - false if the component has no upgrade definitions
+	 */
+	bool GetDenseUpgradeCosts(int32 ComponentId, int32 LevelIncrease, TArray<int32>& OutDenseCosts) const;
+	void RefundUpgradeCosts(const FUpgradeInProgressData& InProgressData) const;
+
+	/**
+	 * Wallet a component's production and storage are credited to, and what the wallet actually accepted by resource ID.
+	 * Changes the wallet rejects are not recorded, so later level changes never take back more than was given.
+	 */
+	struct FLevelBonusCredit
+	{
+		TWeakObjectPtr<UResourceSystemComponent> Wallet;
+		TMap<int32, float> CreditedRates;
+		TMap<int32, int32> CreditedCapacities;
+	};
+
+	// Only components whose upgrade path produces or stores resources have an entry.
+	TMap<int32, FLevelBonusCredit> LevelBonusCredits;
+
+	/**
+	 * Moves a component's passive production and storage capacity from what its wallet was credited to NewLevel. Only the
+	 * differences reach the wallet. INDEX_NONE removes both, e.g. when the component unregisters.
+	 */
+	void UpdateLevelBonuses(int32 ComponentId, int32 NewLevel);
+
+	/** Credits a wallet that just got a new, empty bucket with the bonuses of every component paying into it */
+	void HandleResourceComponentRegistered(UResourceSystemComponent* Wallet);
+
+	/** Rejection warnings go through the rate limiter's log throttle */
+	bool ShouldLogRejection(const TCHAR* RejectionCode) const;
 	
 	const TArray<FUpgradeDefinition>* GetUpgradeDefinitions(FName UpgradePathId) const;
 	const TArray<FUpgradeDefinition>* GetUpgradeDefinitions(int32 ComponentId) const;
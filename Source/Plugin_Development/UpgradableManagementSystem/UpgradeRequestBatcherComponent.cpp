@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "UpgradeRequestBatcherComponent.h"
+#include "UpgradableComponent.h"
+#include "UpgradeManagerSubsystem.h"
+#include "../ResourceManagementSystem/ResourceManagerSubsystem.h"
+#include "../RequestRateLimiterSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "TimerManager.h"
+
+bool FUpgradeBatchEntry::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// IDs are dense slot indices and mostly small, packing usually needs one or two bytes
+	uint32 PackedId = static_cast<uint32>(ComponentId);
+	Ar.SerializeIntPacked(PackedId);
+	ComponentId = static_cast<int32>(PackedId);
+	Ar << LevelIncrease;
+	bOutSuccess = true;
+	return true;
+}
+
+UUpgradeRequestBatcherComponent::UUpgradeRequestBatcherComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+}
+
+UUpgradeRequestBatcherComponent* UUpgradeRequestBatcherComponent::FindLocalBatcher(const UWorld* World)
+{
+	// Never a remote player's controller on a server, those batchers only serve their own connection
+	const APlayerController* PlayerController = World && GEngine ? GEngine->GetFirstLocalPlayerController(World) : nullptr;
+	return PlayerController && PlayerController->IsLocalController() ? PlayerController->FindComponentByClass<UUpgradeRequestBatcherComponent>() : nullptr;
+}
+
+void UUpgradeRequestBatcherComponent::QueueUpgrade(UUpgradableComponent* Component, int32 LevelIncrease)
+{
+	if (!Component || Component->GetComponentId() == -1 || LevelIncrease <= 0) return;
+
+	const int32 ComponentId = Component->GetComponentId();
+	FUpgradeBatchEntry* Entry;
+	if (const int32* PendingIndex = PendingIndicesById.Find(ComponentId))
+	{
+		Entry = &PendingRequests[*PendingIndex];
+	}
+	else
+	{
+		PendingIndicesById.Add(ComponentId, PendingRequests.Num());
+		Entry = &PendingRequests.AddDefaulted_GetRef();
+		Entry->ComponentId = ComponentId;
+	}
+	Entry->LevelIncrease = static_cast<uint8>(FMath::Min<int32>(Entry->LevelIncrease + LevelIncrease, MAX_uint8));
+
+	if (!bFlushScheduled)
+	{
+		bFlushScheduled = true;
+		GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UUpgradeRequestBatcherComponent::FlushPendingRequests);
+	}
+}
+
+void UUpgradeRequestBatcherComponent::QueueUpgrades(const TArray<UUpgradableComponent*>& Components, int32 LevelIncrease)
+{
+	for (UUpgradableComponent* Component : Components)
+	{
+		QueueUpgrade(Component, LevelIncrease);
+	}
+}
+
+void UUpgradeRequestBatcherComponent::FlushPendingRequests()
+{
+	bFlushScheduled = false;
+
+	for (int32 First = 0; First < PendingRequests.Num(); First += MaxRequestsPerBatch)
+	{
+		const int32 Count = FMath::Min(MaxRequestsPerBatch, PendingRequests.Num() - First);
+		const TArray<FUpgradeBatchEntry> Batch(PendingRequests.GetData() + First, Count);
+
+		const uint16 BatchId = NextBatchId++;
+		TArray<int32>& BatchComponentIds = InFlightBatches.Add(BatchId);
+		BatchComponentIds.Reserve(Count);
+		for (const FUpgradeBatchEntry& Entry : Batch)
+		{
+			BatchComponentIds.Add(Entry.ComponentId);
+		}
+
+		if (UE_LOG_ACTIVE(LogUpgradeSystem, Verbose))
+		{
+			UE_LOG(LogUpgradeSystem, Verbose, TEXT("[UPGRADEBATCH_INFO_01] Sending batch %d with %d request(s)"), BatchId, Count);
+		}
+		Server_RequestUpgradeBatch(BatchId, Batch);
+	}
+	PendingRequests.Reset();
+	PendingIndicesById.Reset();
+}
+
+bool UUpgradeRequestBatcherComponent::Server_RequestUpgradeBatch_Validate(uint16 BatchId, const TArray<FUpgradeBatchEntry>& Requests)
+{
+	// QueueUpgrade never sends an entry without a level increase, so one can only come from a tampered client. It is
+	// rejected here instead of costing a rate limit token the entries after it would have needed.
+	return Requests.Num() > 0 && Requests.Num() <= MaxRequestsPerBatch
+		&& !Requests.ContainsByPredicate([](const FUpgradeBatchEntry& Entry) { return Entry.LevelIncrease == 0; });
+}
+
+void UUpgradeRequestBatcherComponent::Server_RequestUpgradeBatch_Implementation(uint16 BatchId, const TArray<FUpgradeBatchEntry>& Requests)
+{
+	UUpgradeManagerSubsystem* Subsystem = GetWorld()->GetSubsystem<UUpgradeManagerSubsystem>();
+	UResourceManagerSubsystem* ResourceSubsystem = GetWorld()->GetSubsystem<UResourceManagerSubsystem>();
+	if (!Subsystem || !ResourceSubsystem) return;
+
+	TArray<uint8> AcceptedBits;
+	AcceptedBits.SetNumZeroed((Requests.Num() + 7) / 8);
+
+	// Entries beyond the connection's budget keep their bits cleared, the client sees them rejected and can retry
+	URequestRateLimiterSubsystem* RateLimiter = GetWorld()->GetSubsystem<URequestRateLimiterSubsystem>();
+	const int32 ServedCount = RateLimiter ? RateLimiter->ConsumeUpTo(this, ERateLimitedRequest::Upgrade, Requests.Num()) : Requests.Num();
+
+	for (int32 i = 0; i < ServedCount; ++i)
+	{
+		const FUpgradeBatchEntry& Entry = Requests[i];
+		// Only reachable by a local caller, validation drops remote batches with such entries
+		if (Entry.LevelIncrease == 0) continue;
+
+		const UUpgradableComponent* Comp = Subsystem->GetComponentById(Entry.ComponentId);
+
+		// A player may only upgrade what its connection owns, the same rule the per-component RPC gets from the engine
+		if (!Comp || !Comp->GetOwner() || Comp->GetOwner()->GetNetOwner() != GetOwner())
+		{
+			if (!RateLimiter || RateLimiter->ShouldLogRejection(TEXT("UPGRADEBATCH_ERR_01")))
+			{
+				UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEBATCH_ERR_01] Batch %d: component %d is not owned by %s"), BatchId, Entry.ComponentId, *GetNameSafe(GetOwner()));
+			}
+			continue;
+		}
+
+		UResourceSystemComponent* Wallet = ResourceSubsystem->FindResourceComponentForActor(Comp->GetOwner());
+		if (Subsystem->HandleUpgradeRequest(Entry.ComponentId, Entry.LevelIncrease, Wallet))
+		{
+			AcceptedBits[i / 8] |= 1 << (i % 8);
+		}
+	}
+
+	Client_UpgradeBatchResult(BatchId, AcceptedBits);
+}
+
+void UUpgradeRequestBatcherComponent::Client_UpgradeBatchResult_Implementation(uint16 BatchId, const TArray<uint8>& AcceptedBits)
+{
+	TArray<int32> BatchComponentIds;
+	if (!InFlightBatches.RemoveAndCopyValue(BatchId, BatchComponentIds))
+	{
+		UE_LOG(LogUpgradeSystem, Warning, TEXT("[UPGRADEBATCH_ERR_02] Received result for unknown batch %d"), BatchId);
+		return;
+	}
+
+	TArray<int32> AcceptedIds;
+	TArray<int32> RejectedIds;
+	for (int32 i = 0; i < BatchComponentIds.Num(); ++i)
+	{
+		const bool bAccepted = AcceptedBits.IsValidIndex(i / 8) && (AcceptedBits[i / 8] & (1 << (i % 8)));
+		(bAccepted ? AcceptedIds : RejectedIds).Add(BatchComponentIds[i]);
+	}
+	OnUpgradeBatchResult.Broadcast(BatchId, AcceptedIds, RejectedIds);
+}
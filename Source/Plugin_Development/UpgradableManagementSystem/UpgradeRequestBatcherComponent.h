@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "UpgradeRequestBatcherComponent.generated.h"
+
+class UUpgradableComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnUpgradeBatchResultDelegate, int32, BatchId, const TArray<int32>&, AcceptedComponentIds, const TArray<int32>&, RejectedComponentIds);
+
+/** One coalesced upgrade request. Packed to a variable length ID plus one byte. */
+USTRUCT()
+struct PLUGIN_DEVELOPMENT_API FUpgradeBatchEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 ComponentId = -1;
+
+	UPROPERTY()
+	uint8 LevelIncrease = 0;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FUpgradeBatchEntry> : public TStructOpsTypeTraitsBase2<FUpgradeBatchEntry>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/**
+ * Lives on the player controller and coalesces every upgrade request issued during a frame
+ * ("upgrade all", multi-select, auto-upgrade) into a single server RPC, answered by a single result RPC.
+ * UUpgradableComponent::RequestUpgrade routes through it automatically on clients whose local player controller has one.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class PLUGIN_DEVELOPMENT_API UUpgradeRequestBatcherComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UUpgradeRequestBatcherComponent();
+
+	/** Fired on the owning client once the server answered a batch */
+	UPROPERTY(BlueprintAssignable, Category = "Upgrade System")
+	FOnUpgradeBatchResultDelegate OnUpgradeBatchResult;
+
+	/** Queues an upgrade to be sent with the rest of this frame's requests. Repeated requests for one component add up. */
+	UFUNCTION(BlueprintCallable, Category = "Upgrade System")
+	void QueueUpgrade(UUpgradableComponent* Component, int32 LevelIncrease = 1);
+
+	/** Queues the same upgrade for every component, e.g. for "upgrade all" */
+	UFUNCTION(BlueprintCallable, Category = "Upgrade System")
+	void QueueUpgrades(const TArray<UUpgradableComponent*>& Components, int32 LevelIncrease = 1);
+
+	/** Returns the batcher on the first local player controller, if any. Never a remote player's batcher on a server. */
+	static UUpgradeRequestBatcherComponent* FindLocalBatcher(const UWorld* World);
+
+protected:
+	/** Largest batch the server accepts. Bigger flushes are split on the client. */
+	static constexpr int32 MaxRequestsPerBatch = 256;
+
+	/**
+	 * Costs one upgrade rate limit token per entry. Entries beyond the budget are rejected, the rest is served.
+	 * Batches with an entry without a level increase fail validation before anything is charged.
+	 */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void Server_RequestUpgradeBatch(uint16 BatchId, const TArray<FUpgradeBatchEntry>& Requests);
+	bool Server_RequestUpgradeBatch_Validate(uint16 BatchId, const TArray<FUpgradeBatchEntry>& Requests);
+	void Server_RequestUpgradeBatch_Implementation(uint16 BatchId, const TArray<FUpgradeBatchEntry>& Requests);
+
+	/** One bit per request of the batch, in request order. Set = accepted. */
+	UFUNCTION(Client, Reliable)
+	void Client_UpgradeBatchResult(uint16 BatchId, const TArray<uint8>& AcceptedBits);
+	void Client_UpgradeBatchResult_Implementation(uint16 BatchId, const TArray<uint8>& AcceptedBits);
+
+private:
+	/** Requests queued this frame */
+	TArray<FUpgradeBatchEntry> PendingRequests;
+
+	/** Index into PendingRequests by component ID, so repeated requests for a component are merged in constant time */
+	TMap<int32, int32> PendingIndicesById;
+
+	/** Component IDs of batches waiting for their result, in request order */
+	TMap<uint16, TArray<int32>> InFlightBatches;
+
+	uint16 NextBatchId = 0;
+
+	bool bFlushScheduled = false;
+
+	void FlushPendingRequests();
+};
@@ -45,4 +45,29 @@ public:
        // Custom JSON field names if your files use different keys
        UPROPERTY(EditAnywhere, config, Category="Upgrade Catalog")
        FUpgradeJsonFieldNames JsonFieldNames;
+
+       // Share of the spent resources given back when an upgrade in progress is canceled. 1 = full refund, 0 = none.
+       UPROPERTY(EditAnywhere, config, Category="Upgrade Costs", meta=(ClampMin="0.0", ClampMax="1.0"))
+       float CancelRefundRatio = 1.f;
+
+       // Milliseconds per frame spent applying queued level visuals (QueueActorVisualsPerUpgradeLevel). At least one is applied per frame.
+       UPROPERTY(EditAnywhere, config, Category="Upgrade Visuals", meta=(ClampMin="0.05"))
+       float VisualsApplyBudgetMs = 1.f;
+
+       // Queued visuals of actors that were not rendered recently and are farther than this from the local view wait until they
+       // come closer or on screen
+       UPROPERTY(EditAnywhere, config, Category="Upgrade Visuals", meta=(ClampMin="0"))
+       float VisualsRelevanceDistance = 10000.f;
+
+       // Level-up effects of one Niagara system playing at the same time. Further requests are dropped until one finishes.
+       UPROPERTY(EditAnywhere, config, Category="Upgrade Effects", meta=(ClampMin="1"))
+       int32 MaxConcurrentEffectsPerSystem = 8;
+
+       // Pooled components created for a system as soon as its level is prefetched, before the first level-up needs one
+       UPROPERTY(EditAnywhere, config, Category="Upgrade Effects", meta=(ClampMin="0"))
+       int32 EffectPoolPrewarmCount = 2;
+
+       // Level-up effects farther than this from the local view, or outside its field of view, are not played
+       UPROPERTY(EditAnywhere, config, Category="Upgrade Effects", meta=(ClampMin="0"))
+       float EffectCullDistance = 15000.f;
 };
\ No newline at end of file
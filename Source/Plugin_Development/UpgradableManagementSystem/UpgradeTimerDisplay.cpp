@@ -4,12 +4,14 @@
 #include "UpgradeTimerDisplay.h"
 #include "MightyraiderFunctionLibrary.h"
 #include "UpgradeManagerSubsystem.h"
+#include "UpgradeCountdownSubsystem.h"
+#include "Widgets/SWidget.h"
 
 
 void UUpgradeTimerDisplay::NativeConstruct()
 {
 	Super::NativeConstruct();
-	if (TrackedComponent)
+	if (TrackedComponent && bBindComponentEvents)
 	{
 		TrackedComponent->OnUpgradeStarted.AddDynamic(this, &UUpgradeTimerDisplay::HandleUpgradeStarted);
 		TrackedComponent->OnUpgradeCanceled.AddDynamic(this, &UUpgradeTimerDisplay::HandleUpgradeCanceled);
@@ -19,6 +21,12 @@ void UUpgradeTimerDisplay::NativeConstruct()
 	}
 }
 
+void UUpgradeTimerDisplay::NativeDestruct()
+{
+	StopCountdown();
+	Super::NativeDestruct();
+}
+
 void UUpgradeTimerDisplay::BindUpgradableComponent(int32 ComponentId)
 {
         // Only early-out if we're already tracking a component
@@ -39,34 +47,20 @@ void UUpgradeTimerDisplay::BindUpgradableComponent(int32 ComponentId)
 
 void UUpgradeTimerDisplay::HandleUpgradeStarted_Implementation(float SecondsUntilCompleted)
 {
-	
-	if (CountdownHandle.IsValid())
-	{
-		StopCountdownTimer();
-		RemainingTime = SecondsUntilCompleted;
-	}
-	else
+	// A restarted timer (time added or removed) keeps the total of the original upgrade
+	if (!bCountdownRunning)
 	{
 		TotalTime = SecondsUntilCompleted;
-		RemainingTime = SecondsUntilCompleted;
-	}
-	
-	if (RemainingTime < 60.f)
-	{
-		CountdownText->SetText(FText::AsNumber(RemainingTime));
-	}
-	else
-	{
-		FTimespan Timespan = FTimespan::FromSeconds(RemainingTime);
-		CountdownText->SetText(FText::AsTimespan(Timespan));
 	}
+	RemainingTime = SecondsUntilCompleted;
+	ShowRemainingTime();
 	
-	StartCountdownTimer();
+	StartCountdown();
 }
 
 void UUpgradeTimerDisplay::HandleUpgradeCanceled_Implementation(int32 CurrentLevel)
 {
-	StopCountdownTimer();
+	StopCountdown();
 	TotalTime = -1.f;
 	RemainingTime = -1.f;
 	LevelText->SetText(FText::AsNumber(CurrentLevel));
@@ -82,24 +76,13 @@ void UUpgradeTimerDisplay::HandleTimeToUpgradeChanged_Implementation(float Delta
 	const FString Formatted = FString::Printf(TEXT("%c%.0f"), SignChar, AbsDelta);
 	
 	CountdownChangedText->SetText(FText::FromString(Formatted));
-	RemainingTime += DeltaTime;
 
-	
-	if (RemainingTime > 0.f)
-	{
-		const float ElapsedTime = TotalTime - RemainingTime; 
-		UpgradeProgress->SetPercent(ElapsedTime / TotalTime);
-	}
-	else
-	{
-		CountdownText->SetText(FText::AsNumber(0.f));
-		UpgradeProgress->SetPercent(1.f);
-	}
+	// The countdown itself follows the component's new end time
 }
 
 void UUpgradeTimerDisplay::HandleLevelChanged_Implementation(int32 OldLevel, int32 NewLevel)
 {
-	StopCountdownTimer();
+	StopCountdown();
 	CountdownText->SetText(FText::AsNumber(0.f));
 	LevelText->SetText(FText::AsNumber(NewLevel));
 	UpgradeProgress->SetPercent(0.f);
@@ -109,55 +92,86 @@ void UUpgradeTimerDisplay::HandleLevelChanged_Implementation(int32 OldLevel, int
 	
 }
 
-void UUpgradeTimerDisplay::StartCountdownTimer()
+void UUpgradeTimerDisplay::StartCountdown()
 {
-	FTimerDelegate TimerDelegate;
-	TimerDelegate.BindUFunction(this, FName("UpdateCountdownText"));
-	if (RemainingTime > 10.f)
+	if (UUpgradeCountdownSubsystem* Countdowns = GetWorld() ? GetWorld()->GetSubsystem<UUpgradeCountdownSubsystem>() : nullptr)
 	{
-		GetWorld()->GetTimerManager().SetTimer(CountdownHandle, TimerDelegate, 1.f, true);
-		CountdownTimerRate = 1.f;
+		Countdowns->AddDisplay(this);
+		bCountdownRunning = true;
 	}
-	else
+}
+
+void UUpgradeTimerDisplay::StopCountdown()
+{
+	if (!bCountdownRunning) return;
+
+	if (UUpgradeCountdownSubsystem* Countdowns = GetWorld() ? GetWorld()->GetSubsystem<UUpgradeCountdownSubsystem>() : nullptr)
 	{
-		GetWorld()->GetTimerManager().SetTimer(CountdownHandle, TimerDelegate, 0.1f, true);
-		CountdownTimerRate = 0.1f;
+		Countdowns->RemoveDisplay(this);
 	}
-	
+	bCountdownRunning = false;
+	ShownCountdownTenths = INDEX_NONE;
+	ShownProgressPermille = INDEX_NONE;
 }
 
-void UUpgradeTimerDisplay::UpdateCountdownText()
+bool UUpgradeTimerDisplay::IsCountdownOnScreen() const
 {
+	// Painting is no indicator, invalidation and retainer boxes reuse cached draws of widgets that are not repainted
+	const TSharedPtr<SWidget> SlateWidget = GetCachedWidget();
+	if (!SlateWidget.IsValid() || !IsVisible()) return false;
 
-	RemainingTime -= CountdownTimerRate;
-	const float ElapsedTime = TotalTime - RemainingTime; 
-	UpgradeProgress->SetPercent(ElapsedTime / TotalTime);
-	
-	if (RemainingTime <= 60.f)
+	FSlateRect VisibleRect = SlateWidget->GetTickSpaceGeometry().GetRenderBoundingRect();
+	for (TSharedPtr<SWidget> Parent = SlateWidget->GetParentWidget(); Parent.IsValid(); Parent = Parent->GetParentWidget())
 	{
-		CountdownText->SetText(FText::AsNumber(RemainingTime));
-		if (RemainingTime < 10.f && (CountdownTimerRate - 0.1f > KINDA_SMALL_NUMBER) )
+		if (!Parent->GetVisibility().IsVisible()) return false;
+
+		// Scroll boxes and the window clip their children, anything outside their bounds is not drawn
+		const bool bClipsChildren = Parent->GetClipping() == EWidgetClipping::ClipToBounds || Parent->GetClipping() == EWidgetClipping::ClipToBoundsAlways
+			|| !Parent->GetParentWidget().IsValid();
+		if (bClipsChildren)
 		{
-			StopCountdownTimer();
-			StartCountdownTimer();
+			VisibleRect = VisibleRect.IntersectionWith(Parent->GetTickSpaceGeometry().GetRenderBoundingRect());
+			if (VisibleRect.GetArea() <= 0.f) return false;
 		}
 	}
-	else
-	{
-		FTimespan Timespan = FTimespan::FromSeconds(RemainingTime);
-		CountdownText->SetText(FText::AsTimespan(Timespan));
-	}
-	
-	
-	
+	return true;
 }
 
-void UUpgradeTimerDisplay::StopCountdownTimer()
+void UUpgradeTimerDisplay::UpdateCountdown(double ServerTime)
 {
-	if (CountdownHandle.IsValid())
+	// Zero until the end time replicated, the start event already showed the full duration
+	const double EndTime = TrackedComponent ? TrackedComponent->GetUpgradeEndServerTime() : 0.0;
+	if (EndTime <= 0.0) return;
+
+	if (TrackedComponent->GetUpgradeTotalTime() > 0.f)
 	{
-		GetWorld()->GetTimerManager().ClearTimer(CountdownHandle);
+		TotalTime = TrackedComponent->GetUpgradeTotalTime();
 	}
+	RemainingTime = FMath::Max(static_cast<float>(EndTime - ServerTime), 0.f);
+	ShowRemainingTime();
 }
 
+void UUpgradeTimerDisplay::ShowRemainingTime()
+{
+	// Tenths under ten seconds, whole seconds above. Texts are only touched when the shown value changes.
+	const int32 Tenths = RemainingTime < 10.f ? FMath::CeilToInt(RemainingTime * 10.f) : FMath::CeilToInt(RemainingTime) * 10;
+	if (Tenths != ShownCountdownTenths)
+	{
+		ShownCountdownTenths = Tenths;
+		if (Tenths <= 600)
+		{
+			CountdownText->SetText(FText::AsNumber(Tenths / 10.f));
+		}
+		else
+		{
+			CountdownText->SetText(FText::AsTimespan(FTimespan::FromSeconds(Tenths / 10)));
+		}
+	}
 
+	const int32 Permille = TotalTime > 0.f ? FMath::Clamp(FMath::RoundToInt((1.f - RemainingTime / TotalTime) * 1000.f), 0, 1000) : 0;
+	if (Permille != ShownProgressPermille)
+	{
+		ShownProgressPermille = Permille;
+		UpgradeProgress->SetPercent(Permille / 1000.f);
+	}
+}
@@ -14,7 +14,9 @@
 // class UProgressBar;
 // class UUpgradableComponent;
 /**
- * 
+ * Level, countdown and progress of one upgradable component.
+ * The countdown is driven by UUpgradeCountdownSubsystem from the component's replicated end time, so it never drifts
+ * from the server. Displays that are not on screen (collapsed, hidden, scrolled away) are skipped.
  */
 UCLASS()
 class PLUGIN_DEVELOPMENT_API UUpgradeTimerDisplay : public UUserWidget
@@ -24,6 +26,7 @@ class PLUGIN_DEVELOPMENT_API UUpgradeTimerDisplay : public UUserWidget
 public:
 
 	virtual void NativeConstruct() override;
+	virtual void NativeDestruct() override;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Upgrade System", meta=(ExposeOnSpawn="true"))
 	UUpgradableComponent* TrackedComponent = nullptr;
@@ -31,6 +34,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Upgrade System|Timer")
 	void BindUpgradableComponent(int32 ComponentId);
 
+	/**
+	 * True if the widget and all its parents are visible and its last arranged geometry is not clipped away.
+	 * Does not depend on painting, so it holds for widgets cached by invalidation or retainer boxes.
+	 */
+	bool IsCountdownOnScreen() const;
+
+	/** Called by UUpgradeCountdownSubsystem with the current server time */
+	void UpdateCountdown(double ServerTime);
+
 protected:
 
 	UPROPERTY(BlueprintReadOnly, meta=(BindWidget))
@@ -45,17 +57,15 @@ protected:
 	UPROPERTY(BlueprintReadOnly, meta=(BindWidget))
 	UProgressBar* UpgradeProgress;
 
-	UPROPERTY()
-	FTimerHandle CountdownHandle;
+	void StartCountdown();
 
-	UFUNCTION()
-	void UpdateCountdownText();
+	void StopCountdown();
 
-	UFUNCTION()
-	void StartCountdownTimer();
-	
-	UFUNCTION()
-	void StopCountdownTimer();
+	/** Writes RemainingTime and the progress to the texts if their shown values changed */
+	void ShowRemainingTime();
+
+	/** If false, the TrackedComponent's events are not bound on construct. Used by pooled list rows. */
+	bool bBindComponentEvents = true;
 
 	UFUNCTION(BlueprintNativeEvent, Category = "Upgrade System|Timer")
 	void HandleLevelChanged(int32 OldLevel, int32 NewLevel);
@@ -73,6 +83,12 @@ protected:
 	float TotalTime = 0.f;
 	UPROPERTY()
 	float RemainingTime = 0.f;
-	UPROPERTY()
-	float CountdownTimerRate = 0.f;
+
+private:
+	bool bCountdownRunning = false;
+
+	/** Shown countdown in tenths of a second, INDEX_NONE if nothing is shown yet */
+	int32 ShownCountdownTenths = INDEX_NONE;
+
+	int32 ShownProgressPermille = INDEX_NONE;
 };
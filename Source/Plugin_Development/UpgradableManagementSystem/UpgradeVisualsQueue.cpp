@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "UpgradeVisualsQueue.h"
+#include "UpgradableComponent.h"
+#include "UpgradeSettings.h"
+#include "LevelUpVisualsStreamer.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/PlayerController.h"
+
+bool UUpgradeVisualsQueue::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return !IsRunningDedicatedServer() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UUpgradeVisualsQueue::Enqueue(UUpgradableComponent* Component, int32 Level, UStaticMeshComponent* StaticMeshComponent, USkeletalMeshComponent* SkeletalComponent)
+{
+	if (!Component) return;
+
+	// A level still waiting is never shown, the newest one replaces it
+	const int32* ExistingIndex = PendingIndices.Find(Component);
+	FPendingVisuals& Entry = ExistingIndex ? Pending[*ExistingIndex] : Pending.AddDefaulted_GetRef();
+	if (!ExistingIndex)
+	{
+		PendingIndices.Add(Component, Pending.Num() - 1);
+	}
+	if (Entry.StreamingLevel != Level)
+	{
+		ReleaseStreamingReference(Entry);
+	}
+	Entry.Component = Component;
+	Entry.StaticMesh = StaticMeshComponent;
+	Entry.SkeletalMesh = SkeletalComponent;
+	Entry.Level = Level;
+}
+
+void UUpgradeVisualsQueue::Dequeue(const UUpgradableComponent* Component)
+{
+	if (const int32* Index = PendingIndices.Find(Component))
+	{
+		ReleaseStreamingReference(Pending[*Index]);
+		RemovePendingAt(*Index);
+	}
+}
+
+void UUpgradeVisualsQueue::ReleaseStreamingReference(FPendingVisuals& Entry) const
+{
+	ULevelUpVisualsStreamer* Streamer = GetWorld()->GetSubsystem<ULevelUpVisualsStreamer>();
+	if (Streamer && Entry.StreamingLevel != INDEX_NONE && Entry.StreamingVisuals.IsValid())
+	{
+		Streamer->ReleaseLevel(Entry.StreamingVisuals.Get(), Entry.StreamingLevel);
+	}
+	Entry.StreamingVisuals.Reset();
+	Entry.StreamingLevel = INDEX_NONE;
+}
+
+int32 UUpgradeVisualsQueue::GetQueuedLevel(const UUpgradableComponent* Component) const
+{
+	const int32* Index = PendingIndices.Find(Component);
+	return Index ? Pending[*Index].Level : INDEX_NONE;
+}
+
+void UUpgradeVisualsQueue::RemovePendingAt(int32 Index)
+{
+	PendingIndices.Remove(Pending[Index].Component);
+	Pending.RemoveAtSwap(Index);
+	if (Pending.IsValidIndex(Index))
+	{
+		PendingIndices.Add(Pending[Index].Component, Index);
+	}
+}
+
+void UUpgradeVisualsQueue::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const UUpgradeSettings* Settings = GetDefault<UUpgradeSettings>();
+	const double Deadline = FPlatformTime::Seconds() + Settings->VisualsApplyBudgetMs / 1000.0;
+	const double RelevanceDistanceSq = FMath::Square(static_cast<double>(Settings->VisualsRelevanceDistance));
+
+	ULevelUpVisualsStreamer* Streamer = GetWorld()->GetSubsystem<ULevelUpVisualsStreamer>();
+	FVector ViewLocation = FVector::ZeroVector;
+	bool bHasView = false;
+	if (const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController())
+	{
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		bHasView = true;
+	}
+
+	for (int32 i = Pending.Num() - 1; i >= 0; --i)
+	{
+		const UUpgradableComponent* Component = Pending[i].Component.Get();
+		if (!Component || !Component->GetOwner())
+		{
+			ReleaseStreamingReference(Pending[i]);
+			RemovePendingAt(i);
+		}
+	}
+
+	// Score the relevant entries: rendered ones first, nearer ones first within each group
+	struct FCandidate
+	{
+		TObjectKey<UUpgradableComponent> Component;
+		bool bRendered;
+		double DistanceSq;
+	};
+	TArray<FCandidate> Candidates;
+	Candidates.Reserve(Pending.Num());
+	for (int32 i = 0; i < Pending.Num(); ++i)
+	{
+		const AActor* Owner = Pending[i].Component->GetOwner();
+		const bool bRendered = Owner->WasRecentlyRendered(0.2f);
+		const double DistanceSq = bHasView ? FVector::DistSquared(ViewLocation, Owner->GetActorLocation()) : 0.0;
+		if (bRendered || DistanceSq <= RelevanceDistanceSq)
+		{
+			Candidates.Add({ Pending[i].Component.Get(), bRendered, DistanceSq });
+		}
+	}
+	Candidates.Sort([](const FCandidate& A, const FCandidate& B)
+	{
+		return A.bRendered != B.bRendered ? A.bRendered : A.DistanceSq < B.DistanceSq;
+	});
+
+	for (const FCandidate& Candidate : Candidates)
+	{
+		// Looked up again, OnVisualLevelApplied listeners of earlier entries may have queued, dequeued or destroyed
+		// components, which moves entries around in Pending
+		const int32* Index = PendingIndices.Find(Candidate.Component);
+		if (!Index) continue;
+
+		// A level that is not resident would only start streaming here and be swapped in later, outside the budget.
+		// It streams in first and stays queued until a later frame finds it loaded.
+		FPendingVisuals& Waiting = Pending[*Index];
+		const UUpgradableComponent* WaitingComponent = Waiting.Component.Get();
+		const UOnLeveUpVisualsDataAsset* Visuals = WaitingComponent ? WaitingComponent->GetLevelUpVisuals() : nullptr;
+		if (Streamer && Visuals && !Streamer->IsLevelLoaded(Visuals, Waiting.Level))
+		{
+			if (Waiting.StreamingLevel == INDEX_NONE)
+			{
+				Waiting.StreamingVisuals = Visuals;
+				Waiting.StreamingLevel = Waiting.Level;
+				Streamer->AcquireLevel(Visuals, Waiting.Level, /*bHighPriority=*/Candidate.bRendered);
+			}
+			// Resident assets finish inside AcquireLevel
+			if (!Streamer->IsLevelLoaded(Visuals, Waiting.Level)) continue;
+		}
+
+		// Removed before applying, a listener that queues another level for the component keeps that one queued
+		FPendingVisuals Entry = Pending[*Index];
+		RemovePendingAt(*Index);
+		if (UUpgradableComponent* Component = Entry.Component.Get())
+		{
+			Component->ChangeActorVisualsPerUpgradeLevel(Entry.Level, Entry.StaticMesh.Get(), Entry.SkeletalMesh.Get());
+		}
+		// Released after the component took its own reference, so the level stays resident
+		ReleaseStreamingReference(Entry);
+
+		if (FPlatformTime::Seconds() >= Deadline) break;
+	}
+}
+
+TStatId UUpgradeVisualsQueue::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UUpgradeVisualsQueue, STATGROUP_Tickables);
+}
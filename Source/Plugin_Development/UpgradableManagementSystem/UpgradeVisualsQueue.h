@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UpgradeVisualsQueue.generated.h"
+
+class UUpgradableComponent;
+class UStaticMeshComponent;
+class USkeletalMeshComponent;
+
+/**
+ * Applies level visuals queued through UUpgradableComponent::QueueActorVisualsPerUpgradeLevel within
+ * UUpgradeSettings::VisualsApplyBudgetMs per frame, so hundreds of upgrades completing together do not hitch.
+ * Actors rendered recently go first, then by distance to the local view. Actors that are neither rendered nor within
+ * UUpgradeSettings::VisualsRelevanceDistance stay queued until they are. One entry per component, a newer level
+ * replaces the queued one.
+ *
+ * Only levels whose assets are resident are applied, so the whole swap happens inside the budget. Other levels are
+ * streamed in first, the entry holding a streamer reference, and applied by a later frame.
+ */
+UCLASS()
+class PLUGIN_DEVELOPMENT_API UUpgradeVisualsQueue : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void Enqueue(UUpgradableComponent* Component, int32 Level, UStaticMeshComponent* StaticMeshComponent, USkeletalMeshComponent* SkeletalComponent);
+
+	/** Drops Component's queued level, e.g. when it ends play */
+	void Dequeue(const UUpgradableComponent* Component);
+
+	int32 GetQueuedCount() const { return Pending.Num(); }
+
+	/** Level queued for Component, INDEX_NONE if none */
+	int32 GetQueuedLevel(const UUpgradableComponent* Component) const;
+
+	//~ Begin UTickableWorldSubsystem
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return Pending.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+	//~ End UTickableWorldSubsystem
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+private:
+	struct FPendingVisuals
+	{
+		TWeakObjectPtr<UUpgradableComponent> Component;
+		TWeakObjectPtr<UStaticMeshComponent> StaticMesh;
+		TWeakObjectPtr<USkeletalMeshComponent> SkeletalMesh;
+		int32 Level = INDEX_NONE;
+
+		/** Streamer reference taken while the level loads, INDEX_NONE if none */
+		TWeakObjectPtr<const UOnLeveUpVisualsDataAsset> StreamingVisuals;
+		int32 StreamingLevel = INDEX_NONE;
+	};
+
+	TArray<FPendingVisuals> Pending;
+
+	/** Index into Pending by component */
+	TMap<TObjectKey<UUpgradableComponent>, int32> PendingIndices;
+
+	void RemovePendingAt(int32 Index);
+
+	/** Drops the streamer reference Entry holds, if any */
+	void ReleaseStreamingReference(FPendingVisuals& Entry) const;
+};